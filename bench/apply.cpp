@@ -0,0 +1,106 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <algorithm>
+
+#include <delegate.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t elements = 1 << 20;
+constexpr std::size_t rounds = 20;
+
+struct scale
+{
+    float operator()(float x) const noexcept { return x * factor_; }
+    float factor_;
+};
+
+struct affine
+{
+    float operator()(float x) const noexcept { return x * a_ + b_; }
+    float a_;
+    float b_;
+};
+
+struct clamp
+{
+    float operator()(float x) const noexcept { return std::min(std::max(x, lo_), hi_); }
+    float lo_;
+    float hi_;
+};
+
+// Kernel K with overload that processes whole array in one loop
+template<typename K>
+struct batched : K
+{
+    using batch_overload = void;
+    using K::operator();
+
+    void operator()(const float * in, float * out, std::size_t count) const noexcept
+    {
+        const K & kernel = *this;
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = kernel(in[i]);
+    }
+};
+
+using delegate_t = vdk::delegate<float(float) const noexcept>;
+
+template<typename K>
+void run(const char * name, K kernel,
+         const std::vector<float> & in, std::vector<float> & out)
+{
+    const delegate_t plain{ kernel };
+    const delegate_t batch{ batched<K>{ kernel } };
+
+    auto ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < in.size(); ++i)
+                out[i] = plain(in[i]);
+    });
+    bench::report((std::string{ name } + ", call per element").c_str(), ns, rounds * elements);
+    bench::do_not_optimize(out.data());
+
+    ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            plain.apply(in.data(), out.data(), in.size());
+    });
+    bench::report((std::string{ name } + ", apply without batch overload").c_str(),
+                  ns, rounds * elements);
+    bench::do_not_optimize(out.data());
+
+    ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            batch.apply(in.data(), out.data(), in.size());
+    });
+    bench::report((std::string{ name } + ", apply with batch overload").c_str(),
+                  ns, rounds * elements);
+    bench::do_not_optimize(out.data());
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<float> in(elements);
+    std::vector<float> out(elements);
+    for (std::size_t i = 0; i < elements; ++i)
+        in[i] = static_cast<float>(i % 1000) * 0.01f - 5.0f;
+
+    run("scale", scale{ 1.5f }, in, out);
+    run("affine", affine{ 2.0f, 0.5f }, in, out);
+    run("clamp", clamp{ -1.0f, 1.0f }, in, out);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <cstddef>
+#include <utility>
+#include <exception>
+#include <coroutine>
+
+#include <delegate.h>
+#include <awaitable.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t round_trips = 10'000'000;
+
+using handler_t = vdk::delegate<void(int, std::size_t)>;
+
+// Operation that completes when the driver loop polls it
+struct fake_device
+{
+    void async_read(std::size_t size, handler_t handler) noexcept
+    {
+        size_ = size;
+        handler_ = std::move(handler);
+    }
+    bool poll()
+    {
+        if (!handler_) return false;
+        auto handler = std::move(handler_);
+        handler(0, size_);
+        return true;
+    }
+
+    std::size_t size_ = 0;
+    handler_t handler_;
+};
+
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+task coroutine_reader(fake_device & device, std::size_t & total)
+{
+    for (std::size_t i = 0; i < round_trips; ++i)
+    {
+        auto [error, size] = co_await vdk::awaitable<void(int, std::size_t)>(
+            [&device](handler_t handler)
+            {
+                device.async_read(1, std::move(handler));
+            });
+        total += size + static_cast<std::size_t>(error);
+    }
+}
+
+// Callback chain equivalent of coroutine_reader
+struct callback_reader
+{
+    void start()
+    {
+        device_.async_read(1, handler_t{ [this](int error, std::size_t size)
+        {
+            total_ += size + static_cast<std::size_t>(error);
+            if (++count_ < round_trips) start();
+        }});
+    }
+
+    fake_device & device_;
+    std::size_t & total_;
+    std::size_t count_ = 0;
+};
+
+} // namespace
+
+int main()
+{
+    {
+        fake_device device;
+        std::size_t total = 0;
+        auto ns = bench::measure([&]
+        {
+            callback_reader reader{ device, total };
+            reader.start();
+            while (device.poll()) {}
+        });
+        bench::do_not_optimize(total);
+        bench::report("callback", ns, round_trips);
+    }
+    {
+        fake_device device;
+        std::size_t total = 0;
+        auto ns = bench::measure([&]
+        {
+            coroutine_reader(device, total);
+            while (device.poll()) {}
+        });
+        bench::do_not_optimize(total);
+        bench::report("co_await awaitable", ns, round_trips);
+    }
+    return 0;
+}
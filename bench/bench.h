@@ -0,0 +1,49 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_BENCH_H
+#define VDK_BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+
+namespace bench
+{
+using clock = std::chrono::steady_clock;
+
+// Prevent the compiler from optimizing away a computed value
+template<typename T>
+inline void do_not_optimize(T const & value) noexcept
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void * sink;
+    sink = &value;
+#endif
+}
+
+// Measure the time of one run of func in nanoseconds
+template<typename F>
+inline double measure(F && func)
+{
+    auto start = clock::now();
+    func();
+    auto stop = clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+// Print one result line: name, total time and time per operation
+inline void report(const char * name, double ns, std::size_t ops)
+{
+    std::printf("%-40s %12.3f ms %10.3f ns/op\n",
+                name, ns / 1e6, ops ? ns / static_cast<double>(ops) : 0.0);
+}
+
+} // namespace bench
+
+#endif // VDK_BENCH_H
@@ -0,0 +1,152 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <future>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <condition_variable>
+
+#include <delegate.h>
+#include <call_on.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t calls = 100'000;
+
+// Conventional design: task queue guarded by mutex, results through promise | future
+class task_thread
+{
+public:
+
+    task_thread()
+        : thread_{ [this] { work(); } }
+    {}
+    ~task_thread()
+    {
+        post(nullptr);
+        thread_.join();
+    }
+    void post(vdk::delegate<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            queue_.push_back(std::move(task));
+        }
+        cond_.notify_one();
+    }
+
+private:
+
+    void work()
+    {
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            cond_.wait(lock, [this] { return !queue_.empty(); });
+            auto task = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            if (!task) return;
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<vdk::delegate<void()>> queue_;
+    std::thread thread_;
+};
+
+// Thread that serves calls through its inbox
+class inbox_thread
+{
+public:
+
+    inbox_thread()
+        : thread_{ [this] { work(); } }
+    {
+        while (!inbox_.load())
+            std::this_thread::yield();
+    }
+    ~inbox_thread()
+    {
+        vdk::call_on(*inbox_.load(), [this] { stop_ = true; });
+        thread_.join();
+    }
+    vdk::thread_inbox & inbox() noexcept
+    {
+        return *inbox_.load();
+    }
+
+private:
+
+    void work()
+    {
+        vdk::thread_inbox inbox;
+        inbox_.store(&inbox);
+        while (!stop_)
+        {
+            inbox.wait();
+            inbox.drain();
+        }
+    }
+
+    std::atomic<vdk::thread_inbox*> inbox_{ nullptr };
+    bool stop_{};
+    std::thread thread_;
+};
+
+// Round-trip latency of each call
+template<typename Call>
+std::vector<double> run(Call && call)
+{
+    std::vector<double> samples;
+    samples.reserve(calls);
+    int sink = 0;
+    for (std::size_t i = 0; i < calls; ++i)
+        samples.push_back(bench::measure([&] { sink += call(static_cast<int>(i)); }));
+    bench::do_not_optimize(sink);
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+void print(const char * name, const std::vector<double> & samples)
+{
+    std::printf("%-40s %10.0f ns p50 %10.0f ns p99 %10.0f ns max\n", name,
+                samples[samples.size() / 2], samples[samples.size() * 99 / 100],
+                samples.back());
+}
+
+} // namespace
+
+int main()
+{
+    {
+        task_thread target;
+        print("promise | future", run([&target](int value)
+        {
+            std::promise<int> result;
+            auto future = result.get_future();
+            target.post([&result, value] { result.set_value(value + 1); });
+            return future.get();
+        }));
+    }
+    {
+        inbox_thread target;
+        print("call_on", run([&target](int value)
+        {
+            return vdk::call_on(target.inbox(), [value] { return value + 1; });
+        }));
+    }
+    return 0;
+}
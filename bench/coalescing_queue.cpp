@@ -0,0 +1,86 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+#include <delegate.h>
+#include <bind_front.h>
+#include <coalescing_queue.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t posts = 1'000'000;
+constexpr std::size_t widgets = 1'000;
+constexpr std::size_t frames = 10;
+
+// Redraw does some work proportional to the widget's contents
+struct widget
+{
+    void redraw()
+    {
+        for (int i = 0; i < 16; ++i)
+            checksum_ = checksum_ * 31 + static_cast<std::uint64_t>(i);
+    }
+    std::uint64_t checksum_{};
+};
+
+} // namespace
+
+int main()
+{
+    std::vector<widget> items(widgets);
+    std::vector<std::size_t> order;
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<std::size_t> pick{ 0, widgets - 1 };
+    for (std::size_t i = 0; i < posts; ++i)
+        order.push_back(pick(gen));
+
+    // Every post is queued and executed
+    std::vector<vdk::delegate<void()>> plain;
+    std::size_t peak = 0;
+    auto ns = bench::measure([&]
+    {
+        for (std::size_t f = 0; f < frames; ++f)
+        {
+            for (auto i : order)
+                plain.push_back(vdk::bind_front<void()>(&widget::redraw, &items[i]));
+            peak = plain.size();
+            for (auto & d : plain)
+                d();
+            plain.clear();
+        }
+    });
+    bench::report("std::vector<delegate>", ns, frames * posts);
+    std::printf("%-40s %zu pending, %zu bytes\n", "  peak", peak,
+                peak * sizeof(vdk::delegate<void()>));
+
+    // Duplicates are dropped on post
+    vdk::coalescing_queue<void()> queue;
+    ns = bench::measure([&]
+    {
+        for (std::size_t f = 0; f < frames; ++f)
+        {
+            for (auto i : order)
+                queue.post(vdk::bind_front<void()>(&widget::redraw, &items[i]));
+            peak = queue.size();
+            queue.flush();
+        }
+    });
+    bench::report("coalescing_queue", ns, frames * posts);
+    std::printf("%-40s %zu pending, %zu bytes\n", "  peak", peak,
+                peak * sizeof(vdk::delegate<void()>));
+
+    std::uint64_t sink = 0;
+    for (const auto & w : items)
+        sink += w.checksum_;
+    bench::do_not_optimize(sink);
+    return 0;
+}
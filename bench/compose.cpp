@@ -0,0 +1,114 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <optional>
+
+#include <delegate.h>
+#include <compose.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t calls = 10'000'000;
+constexpr std::size_t builds = 1'000'000;
+
+// Five stages; the second one stops processing of some inputs
+struct stages
+{
+    std::uint32_t key;
+
+    auto parse() const { return [k = key](std::uint32_t v) { return v ^ k; }; }
+    auto validate() const
+    {
+        return [](std::uint32_t v) -> std::optional<std::uint32_t>
+        {
+            if ((v & 0xFF) == 0) return std::nullopt;
+            return v;
+        };
+    }
+    auto scale() const { return [k = key](std::uint32_t v) { return v * k; }; }
+    auto mix() const { return [](std::uint32_t v) { return v ^ (v >> 13); }; }
+    auto route() const { return [](std::uint32_t v) { return v % 64; }; }
+};
+
+using pipeline_t = vdk::delegate<std::optional<std::uint32_t>(std::uint32_t)>;
+
+// One delegate per stage; each level captures the previous delegate
+pipeline_t nested(const stages & s)
+{
+    vdk::delegate<std::uint32_t(std::uint32_t)> d1 = s.parse();
+    vdk::delegate<std::optional<std::uint32_t>(std::uint32_t)> d2 =
+        [d1 = std::move(d1), f = s.validate()](std::uint32_t v) mutable { return f(d1(v)); };
+    vdk::delegate<std::optional<std::uint32_t>(std::uint32_t)> d3 =
+        [d2 = std::move(d2), f = s.scale()](std::uint32_t v) mutable
+        -> std::optional<std::uint32_t>
+        {
+            auto r = d2(v);
+            if (!r) return std::nullopt;
+            return f(*r);
+        };
+    vdk::delegate<std::optional<std::uint32_t>(std::uint32_t)> d4 =
+        [d3 = std::move(d3), f = s.mix()](std::uint32_t v) mutable
+        -> std::optional<std::uint32_t>
+        {
+            auto r = d3(v);
+            if (!r) return std::nullopt;
+            return f(*r);
+        };
+    return [d4 = std::move(d4), f = s.route()](std::uint32_t v) mutable
+        -> std::optional<std::uint32_t>
+        {
+            auto r = d4(v);
+            if (!r) return std::nullopt;
+            return f(*r);
+        };
+}
+
+pipeline_t composed(const stages & s)
+{
+    return vdk::pipeline<std::optional<std::uint32_t>(std::uint32_t)>(
+        s.parse(), s.validate(), s.scale(), s.mix(), s.route());
+}
+
+template<typename Make>
+void run(const char * name, Make && make)
+{
+    const stages s{ 0x9E3779B9u };
+
+    auto ns = bench::measure([&]
+    {
+        for (std::size_t i = 0; i < builds; ++i)
+        {
+            auto p = make(s);
+            bench::do_not_optimize(p);
+        }
+    });
+    bench::report((std::string{ name } + " construct").c_str(), ns, builds);
+
+    auto p = make(s);
+    std::uint64_t sum = 0;
+    ns = bench::measure([&]
+    {
+        for (std::uint32_t i = 0; i < calls; ++i)
+            sum += p(i).value_or(0);
+    });
+    bench::report((std::string{ name } + " invoke").c_str(), ns, calls);
+    bench::do_not_optimize(sum);
+}
+
+} // namespace
+
+int main()
+{
+    run("nested delegates (5 stages)", nested);
+    run("compose pipeline (5 stages)", composed);
+    return 0;
+}
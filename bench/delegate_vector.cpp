@@ -0,0 +1,117 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include <delegate.h>
+#include <delegate_vector.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t targets = 100'000;
+constexpr std::size_t rounds = 50;
+
+using fn_t = void(std::uint64_t &);
+
+// Target too big for delegate's buffer
+template<int Kind>
+struct handler
+{
+    void operator()(std::uint64_t & sink) const noexcept { sink += state_[0] * Kind + state_[5]; }
+
+    std::array<std::uint64_t, 6> state_;
+};
+
+// Push targets of four types, interleaved with allocations made by the rest of the program
+template<typename Push>
+void fill(Push push, std::vector<std::unique_ptr<char[]>> & noise)
+{
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<std::size_t> size{ 16, 512 };
+    for (std::size_t i = 0; i < targets; ++i)
+    {
+        const std::uint64_t v = i;
+        switch (i % 4)
+        {
+        case 0: push(handler<1>{ { v, 1, 2, 3, 4, 5 } }); break;
+        case 1: push(handler<2>{ { v, 1, 2, 3, 4, 5 } }); break;
+        case 2: push(handler<3>{ { v, 1, 2, 3, 4, 5 } }); break;
+        case 3: push(handler<4>{ { v, 1, 2, 3, 4, 5 } }); break;
+        }
+        noise.emplace_back(new char[size(gen)]);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::uint64_t sink = 0;
+    std::vector<std::unique_ptr<char[]>> noise;
+
+    std::vector<vdk::delegate<fn_t>> plain;
+    plain.reserve(targets);
+    fill([&plain](auto h) { plain.emplace_back(h); }, noise);
+
+    vdk::delegate_vector<fn_t> arena;
+    arena.reserve(targets);
+    fill([&arena](auto h) { arena.push_back(h); }, noise);
+
+    auto ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (auto & d : plain)
+                d(sink);
+    });
+    bench::report("std::vector<delegate>", ns, rounds * targets);
+
+    ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            arena.invoke_all(sink);
+    });
+    bench::report("delegate_vector", ns, rounds * targets);
+
+    // Erase every other target
+    for (std::size_t i = targets / 2; i-- > 0;)
+    {
+        plain.erase(plain.begin() + static_cast<std::ptrdiff_t>(i * 2 + 1));
+        arena.erase(i * 2 + 1);
+    }
+
+    ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (auto & d : plain)
+                d(sink);
+    });
+    bench::report("std::vector<delegate>, half erased", ns, rounds * targets / 2);
+
+    ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            arena.invoke_all(sink);
+    });
+    bench::report("delegate_vector, half erased", ns, rounds * targets / 2);
+
+    arena.compact();
+    ns = bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+            arena.invoke_all(sink);
+    });
+    bench::report("delegate_vector, compacted", ns, rounds * targets / 2);
+
+    bench::do_not_optimize(sink);
+    return 0;
+}
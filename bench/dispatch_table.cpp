@@ -0,0 +1,133 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <random>
+#include <vector>
+#include <cstdint>
+
+#include <delegate.h>
+#include <dispatch_table.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t opcodes = 256;
+constexpr std::size_t program_size = 1 << 20;
+constexpr std::size_t runs = 20;
+
+struct context
+{
+    std::uint64_t reg[4]{ 1, 2, 3, 4 };
+};
+
+// Handler whose behavior depends on the opcode it is registered for
+struct handler
+{
+    void operator()(context & ctx) const noexcept
+    {
+        auto & r = ctx.reg[opcode_ & 3];
+        switch (opcode_ >> 6)
+        {
+        case 0: r += opcode_; break;
+        case 1: r ^= r >> 3; break;
+        case 2: r *= 3; break;
+        default: r -= opcode_; break;
+        }
+    }
+    std::uint64_t opcode_;
+};
+
+inline void execute(context & ctx, std::uint64_t opcode) noexcept
+{
+    auto & r = ctx.reg[opcode & 3];
+    switch (opcode >> 6)
+    {
+    case 0: r += opcode; break;
+    case 1: r ^= r >> 3; break;
+    case 2: r *= 3; break;
+    default: r -= opcode; break;
+    }
+}
+
+std::vector<std::uint8_t> make_program()
+{
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<int> dist{ 0, opcodes - 1 };
+    std::vector<std::uint8_t> program(program_size);
+    for (auto & op : program)
+        op = static_cast<std::uint8_t>(dist(gen));
+    return program;
+}
+
+} // namespace
+
+int main()
+{
+    const auto program = make_program();
+    const std::size_t ops = program.size() * runs;
+
+    std::array<vdk::delegate<void(context&)>, opcodes> delegates;
+    vdk::dispatch_table<void(context&), opcodes> table;
+
+    for (std::size_t op = 0; op < opcodes; ++op)
+    {
+        delegates[op] = handler{ op };
+        table[op] = handler{ op };
+    }
+
+    std::printf("delegate: %zu bytes per slot, dispatch_table: %zu bytes per slot\n",
+                sizeof(vdk::delegate<void(context&)>), sizeof(table) / opcodes);
+
+    auto ns = bench::measure([&]
+    {
+        context ctx;
+        for (std::size_t run = 0; run < runs; ++run)
+            for (auto op : program)
+                delegates[op](ctx);
+        bench::do_not_optimize(ctx);
+    });
+    bench::report("std::array<delegate>", ns, ops);
+
+    ns = bench::measure([&]
+    {
+        context ctx;
+        for (std::size_t run = 0; run < runs; ++run)
+            for (auto op : program)
+                table[op](ctx);
+        bench::do_not_optimize(ctx);
+    });
+    bench::report("dispatch_table", ns, ops);
+
+    ns = bench::measure([&]
+    {
+        context ctx;
+        for (std::size_t run = 0; run < runs; ++run)
+        {
+            const auto size = program.size();
+            for (std::size_t pc = 0; pc < size; ++pc)
+            {
+                if (pc + 8 < size) table.prefetch(program[pc + 8]);
+                table[program[pc]](ctx);
+            }
+        }
+        bench::do_not_optimize(ctx);
+    });
+    bench::report("dispatch_table + prefetch", ns, ops);
+
+    ns = bench::measure([&]
+    {
+        context ctx;
+        for (std::size_t run = 0; run < runs; ++run)
+            for (auto op : program)
+                execute(ctx, op);
+        bench::do_not_optimize(ctx);
+    });
+    bench::report("switch", ns, ops);
+
+    return 0;
+}
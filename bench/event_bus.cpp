@@ -0,0 +1,182 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <typeindex>
+#include <functional>
+#include <unordered_map>
+
+#include <delegate.h>
+#include <event_bus.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t types = 100;
+constexpr std::size_t events = 1'000'000;
+
+template<std::size_t N>
+struct event
+{
+    std::uint32_t value_;
+};
+
+template<std::size_t ... I>
+auto make_bus(std::index_sequence<I...>) -> vdk::event_bus<event<I>...>;
+
+using bus_t = decltype(make_bus(std::make_index_sequence<types>{}));
+
+// Conventional design: subscriber lists in a hash map keyed by type
+class map_bus
+{
+public:
+
+    template<typename E>
+    void subscribe(std::function<void(const E &)> handler)
+    {
+        handlers_[typeid(E)].push_back([h = std::move(handler)](const void * e)
+        {
+            h(*static_cast<const E *>(e));
+        });
+    }
+
+    template<typename E>
+    void publish(const E & event)
+    {
+        auto it = handlers_.find(typeid(E));
+        if (it == handlers_.end())
+            return;
+        for (auto & handler : it->second)
+            handler(&event);
+    }
+
+    template<typename E>
+    void enqueue(const E & event)
+    {
+        queue_.push_back([this, event] { publish(event); });
+    }
+
+    std::size_t dispatch()
+    {
+        for (auto & item : queue_)
+            item();
+        auto count = queue_.size();
+        queue_.clear();
+        return count;
+    }
+
+private:
+
+    std::unordered_map<std::type_index,
+        std::vector<std::function<void(const void *)>>> handlers_;
+    std::vector<std::function<void()>> queue_;
+};
+
+// Type I has 1, 2, 3 or 8 subscribers
+constexpr std::size_t subscriber_count(std::size_t i) noexcept
+{
+    return i % 4 ? i % 4 : 8;
+}
+
+template<typename Bus, std::size_t I>
+void subscribe(Bus & bus, std::uint64_t & sink)
+{
+    using E = event<I>;
+    for (std::size_t i = 0; i < subscriber_count(I); ++i)
+        bus.template subscribe<E>([&sink, i](const E & e) { sink += e.value_ + i; });
+}
+
+// Table of functions that publish | enqueue event of the type with given number
+template<typename Bus>
+struct operations
+{
+    using fn_t = void(*)(Bus &, std::uint32_t);
+
+    template<std::size_t ... I>
+    static void setup(Bus & bus, std::uint64_t & sink, std::index_sequence<I...>)
+    {
+        (subscribe<Bus, I>(bus, sink), ...);
+    }
+
+    template<std::size_t I>
+    static void publish(Bus & bus, std::uint32_t value)
+    {
+        bus.publish(event<I>{ value });
+    }
+
+    template<std::size_t I>
+    static void enqueue(Bus & bus, std::uint32_t value)
+    {
+        bus.enqueue(event<I>{ value });
+    }
+
+    template<std::size_t ... I>
+    static constexpr auto make_publish(std::index_sequence<I...>)
+    {
+        return std::array<fn_t, sizeof...(I)>{ &publish<I>... };
+    }
+
+    template<std::size_t ... I>
+    static constexpr auto make_enqueue(std::index_sequence<I...>)
+    {
+        return std::array<fn_t, sizeof...(I)>{ &enqueue<I>... };
+    }
+};
+
+template<typename Bus>
+void run(const char * name, const std::vector<std::uint8_t> & sequence)
+{
+    using ops = operations<Bus>;
+    constexpr auto seq = std::make_index_sequence<types>{};
+    static constexpr auto publish = ops::make_publish(seq);
+    static constexpr auto enqueue = ops::make_enqueue(seq);
+
+    std::uint64_t sink = 0;
+    Bus bus;
+    ops::setup(bus, sink, seq);
+
+    auto ns = bench::measure([&]
+    {
+        for (std::size_t i = 0; i < events; ++i)
+            publish[sequence[i]](bus, static_cast<std::uint32_t>(i));
+    });
+    bench::report((std::string{ name } + " publish").c_str(), ns, events);
+
+    // Queue in batches of 1000 events, then dispatch them
+    constexpr std::size_t batch = 1000;
+    ns = bench::measure([&]
+    {
+        for (std::size_t i = 0; i < events; i += batch)
+        {
+            for (std::size_t j = i; j < i + batch; ++j)
+                enqueue[sequence[j]](bus, static_cast<std::uint32_t>(j));
+            bus.dispatch();
+        }
+    });
+    bench::report((std::string{ name } + " queued").c_str(), ns, events);
+    bench::do_not_optimize(sink);
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<unsigned> type{ 0, types - 1 };
+    std::vector<std::uint8_t> sequence(events);
+    for (auto & t : sequence)
+        t = static_cast<std::uint8_t>(type(gen));
+
+    run<map_bus>("hash map of std::function", sequence);
+    run<bus_t>("event_bus", sequence);
+    return 0;
+}
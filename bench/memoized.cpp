@@ -0,0 +1,88 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdio>
+
+#include <delegate.h>
+#include <memoized.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t calls = 1'000'000;
+constexpr std::size_t instruments = 10'000;
+
+// Pure callback of moderate cost: price of an instrument after n steps
+double price(int id, int steps)
+{
+    double value = 100.0 + id % 97;
+    for (int i = 0; i < steps; ++i)
+        value = value * 1.0001 + std::sin(value) * 0.01;
+    return value;
+}
+
+// Requested instruments follow a skewed distribution, as quotes of popular ones do
+std::vector<int> make_requests()
+{
+    std::mt19937 gen{ 42 };
+    std::exponential_distribution<double> pick{ 1.0 / 300.0 };
+    std::vector<int> ids;
+    for (std::size_t i = 0; i < calls; ++i)
+        ids.push_back(static_cast<int>(pick(gen)) % static_cast<int>(instruments));
+    return ids;
+}
+
+template<typename Memo>
+void print_stats(const char * name, const Memo & memo)
+{
+    const auto s = memo.stats();
+    const double per_miss = s.misses_ ? double(s.miss_time_) / double(s.misses_) : 0.0;
+    std::printf("%-40s hit rate %5.1f%%, %llu evictions, %.0f ns per miss, ~%.1f ms saved\n",
+                name, s.hit_rate() * 100.0, static_cast<unsigned long long>(s.evictions_),
+                per_miss, per_miss * double(s.hits_) / 1e6);
+}
+
+} // namespace
+
+int main()
+{
+    const auto ids = make_requests();
+    const int steps = 50;
+    double sink = 0;
+
+    vdk::delegate<double(int, int)> plain{ price };
+    auto ns = bench::measure([&]
+    {
+        for (auto id : ids)
+            sink += plain(id, steps);
+    });
+    bench::report("delegate", ns, calls);
+
+    vdk::memoized<double(int, int)> memo{ price, 1024 };
+    ns = bench::measure([&]
+    {
+        for (auto id : ids)
+            sink += memo(id, steps);
+    });
+    bench::report("memoized, 1024 entries", ns, calls);
+    print_stats("  cache", memo);
+
+    vdk::memoized<double(int, int), 8> sharded{ price, 1024 };
+    ns = bench::measure([&]
+    {
+        for (auto id : ids)
+            sink += sharded(id, steps);
+    });
+    bench::report("memoized, 8 shards, 1024 entries", ns, calls);
+    print_stats("  cache", sharded);
+
+    bench::do_not_optimize(sink);
+    return 0;
+}
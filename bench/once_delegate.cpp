@@ -0,0 +1,82 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+
+#include <delegate.h>
+#include <once_delegate.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t handlers = 1 << 20;
+
+// Completion handler state; Size bytes in total
+template<std::size_t Size, int Kind>
+struct completion
+{
+    void operator()(std::uint32_t bytes) && { *sink_ += bytes * Kind + state_[0]; }
+
+    std::uint64_t * sink_;
+    std::array<std::uint64_t, Size / 8 - 1> state_{};
+};
+
+// Arm batch of handlers of four types, then invoke every handler once
+template<typename D, std::size_t Size>
+double run(std::vector<D> & list, std::uint64_t & sink, std::size_t rounds)
+{
+    return bench::measure([&]
+    {
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            for (std::size_t i = 0; i < list.size(); i += 4)
+            {
+                list[i + 0] = completion<Size, 1>{ &sink };
+                list[i + 1] = completion<Size, 2>{ &sink };
+                list[i + 2] = completion<Size, 3>{ &sink };
+                list[i + 3] = completion<Size, 4>{ &sink };
+            }
+            for (std::size_t i = 0; i < list.size(); ++i)
+            {
+                std::move(list[i])(static_cast<std::uint32_t>(i));
+                if constexpr(!std::is_same_v<D, vdk::once_delegate<void(std::uint32_t)>>)
+                    list[i] = nullptr;
+            }
+        }
+    });
+}
+
+template<std::size_t Size>
+void run(const char * name, std::size_t batch)
+{
+    const std::size_t rounds = handlers / batch;
+    std::uint64_t sink = 0;
+
+    std::vector<vdk::delegate<void(std::uint32_t) &&>> plain(batch);
+    std::vector<vdk::once_delegate<void(std::uint32_t)>> once(batch);
+
+    auto ns = run<vdk::delegate<void(std::uint32_t) &&>, Size>(plain, sink, rounds);
+    bench::report((std::string{ "delegate " } + name).c_str(), ns, handlers);
+    ns = run<vdk::once_delegate<void(std::uint32_t)>, Size>(once, sink, rounds);
+    bench::report((std::string{ "once_delegate " } + name).c_str(), ns, handlers);
+    bench::do_not_optimize(sink);
+}
+
+} // namespace
+
+int main()
+{
+    run<16>("inline, batch of 1024", 1024);
+    run<64>("heap, batch of 1024", 1024);
+    run<16>("inline, batch of 1M", handlers);
+    run<64>("heap, batch of 1M", handlers);
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+
+#include <delegate.h>
+#include <parallel_emit.h>
+#include <priority_scheduler.h>
+
+#include "bench.h"
+
+namespace
+{
+// Executor over a pool of worker threads
+struct pool_executor
+{
+    explicit pool_executor(std::size_t threads)
+        : scheduler_{ threads }
+    {}
+    void post(vdk::delegate<void()> task)
+    {
+        scheduler_.post(0, std::move(task));
+    }
+    vdk::priority_scheduler<1> scheduler_;
+};
+
+// Handler doing `rounds` steps of dependent arithmetic
+struct handler
+{
+    void operator()(std::uint64_t event) const
+    {
+        auto value = event;
+        for (std::uint32_t i = 0; i < rounds_; ++i)
+            value = value * 6364136223846793005ull + 1442695040888963407ull;
+        bench::do_not_optimize(value);
+    }
+    std::uint32_t rounds_;
+};
+
+void run(pool_executor & executor, std::size_t count, std::uint32_t rounds, std::size_t grain)
+{
+    std::vector<vdk::delegate<void(std::uint64_t)>> subscribers;
+    for (std::size_t i = 0; i < count; ++i)
+        subscribers.emplace_back(handler{ rounds });
+    const auto iterations = (std::max)(std::size_t{ 20'000'000 } / (count * (rounds + 4)),
+                                       std::size_t{ 10 });
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%zu x %u rounds, sequential", count, rounds);
+    bench::report(name, bench::measure([&]
+    {
+        for (std::size_t i = 0; i < iterations; ++i)
+            for (auto & s : subscribers)
+                s(i);
+    }), iterations);
+
+    // 0 uses all hardware threads; 4 shows the cost of splitting on smaller machines
+    for (std::size_t concurrency : { 0, 4 })
+    {
+        std::snprintf(name, sizeof(name), "%zu x %u rounds, parallel %zu", count, rounds,
+                      concurrency);
+        bench::report(name, bench::measure([&]
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+                vdk::parallel_emit(executor, subscribers.data(), subscribers.size(),
+                                   { grain, concurrency }, std::uint64_t{ i });
+        }), iterations);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    const auto threads = (std::max)(std::thread::hardware_concurrency(), 4u);
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    pool_executor executor{ threads - 1 };
+
+    for (std::size_t count : { 64, 1'000, 10'000 })
+        for (std::uint32_t rounds : { 1u, 100u, 10'000u })
+            run(executor, count, rounds, 32);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+
+#include <delegate.h>
+#include <priority_scheduler.h>
+
+#include "bench.h"
+
+namespace
+{
+using clock = std::chrono::steady_clock;
+
+constexpr std::size_t probes = 2'000;
+constexpr std::size_t backlog = 256;
+
+// Bulk job of a few microseconds
+void bulk_job()
+{
+    std::uint64_t value = 1;
+    for (int i = 0; i < 2000; ++i)
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+    bench::do_not_optimize(value);
+}
+
+// Latency of small tasks posted to lane `high` while lane `low` is kept full of bulk jobs
+template<std::size_t Lanes>
+std::vector<double> run(vdk::scheduler_policy policy, std::size_t high, std::size_t low,
+                        std::uint64_t & bulk_done)
+{
+    std::vector<double> samples(probes);
+    std::atomic<std::size_t> measured{ 0 };
+    std::atomic<bool> stop{ false };
+    {
+        vdk::priority_scheduler<Lanes> scheduler{ 2, policy };
+
+        std::thread producer{ [&]
+        {
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (scheduler.stats(low).depth_ < backlog)
+                    scheduler.post(low, bulk_job);
+                else
+                    std::this_thread::yield();
+            }
+        } };
+
+        for (std::size_t i = 0; i < probes; ++i)
+        {
+            const auto posted = clock::now();
+            scheduler.post(high, [&samples, &measured, posted, i]
+            {
+                samples[i] = std::chrono::duration<double, std::nano>(
+                    clock::now() - posted).count();
+                measured.fetch_add(1, std::memory_order_release);
+            });
+            std::this_thread::sleep_for(std::chrono::microseconds{ 100 });
+        }
+        while (measured.load(std::memory_order_acquire) != probes)
+            std::this_thread::yield();
+
+        stop.store(true, std::memory_order_relaxed);
+        producer.join();
+        bulk_done = scheduler.stats(low).executed_;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+void print(const char * name, const std::vector<double> & samples, std::uint64_t bulk_done)
+{
+    std::printf("%-40s %10.0f ns p50 %10.0f ns p99 %10.0f ns max, %llu bulk jobs\n", name,
+                samples[samples.size() / 2], samples[samples.size() * 99 / 100],
+                samples.back(), static_cast<unsigned long long>(bulk_done));
+}
+
+} // namespace
+
+int main()
+{
+    std::uint64_t bulk = 0;
+
+    auto samples = run<1>({ 0 }, 0, 0, bulk);
+    print("one lane (FIFO)", samples, bulk);
+
+    samples = run<2>({ 0 }, 0, 1, bulk);
+    print("two lanes, no aging", samples, bulk);
+
+    samples = run<2>({ 16 }, 0, 1, bulk);
+    print("two lanes, quantum 16", samples, bulk);
+
+    return 0;
+}
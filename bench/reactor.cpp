@@ -0,0 +1,143 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include <delegate.h>
+#include <reactor.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t round_trips = 200'000;
+constexpr std::size_t wakeups = 20'000;
+
+// Two pipes bounce one byte back and forth through the reactor
+void ping_pong()
+{
+    int a[2], b[2];
+    if (::pipe(a) != 0 || ::pipe(b) != 0)
+        return;
+
+    vdk::reactor loop;
+    std::size_t events = 0;
+    char byte = 'x';
+
+    loop.add(a[0], EPOLLIN, [&](std::uint32_t)
+    {
+        [[maybe_unused]] auto r = ::read(a[0], &byte, 1);
+        [[maybe_unused]] auto w = ::write(b[1], &byte, 1);
+        ++events;
+    });
+    loop.add(b[0], EPOLLIN, [&](std::uint32_t)
+    {
+        [[maybe_unused]] auto r = ::read(b[0], &byte, 1);
+        if (++events < 2 * round_trips)
+        {
+            [[maybe_unused]] auto w = ::write(a[1], &byte, 1);
+        }
+        else
+            loop.stop();
+    });
+
+    auto ns = bench::measure([&]
+    {
+        [[maybe_unused]] auto w = ::write(a[1], &byte, 1);
+        loop.run();
+    });
+    bench::report("reactor pipe ping-pong event", ns, events);
+    std::printf("%-40s %12.0f events/s\n", "reactor pipe ping-pong", events / (ns / 1e9));
+
+    loop.remove(a[0]);
+    loop.remove(b[0]);
+    for (int fd : { a[0], a[1], b[0], b[1] })
+        ::close(fd);
+}
+
+// Time from post on another thread until the task starts on the loop
+void wake_up_latency()
+{
+    vdk::reactor loop;
+    std::atomic<std::size_t> executed{ 0 };
+    std::vector<double> samples;
+    samples.reserve(wakeups);
+
+    std::thread producer{ [&]
+    {
+        for (std::size_t i = 0; i < wakeups; ++i)
+        {
+            // Wait until the loop sleeps in epoll_wait again
+            while (executed.load(std::memory_order_acquire) != i)
+                ;
+            std::this_thread::sleep_for(std::chrono::microseconds{ 20 });
+
+            const auto posted = bench::clock::now();
+            loop.post([&, posted]
+            {
+                samples.push_back(std::chrono::duration<double, std::nano>(
+                    bench::clock::now() - posted).count());
+                executed.fetch_add(1, std::memory_order_release);
+            });
+        }
+        loop.stop();
+    }};
+
+    loop.run();
+    producer.join();
+
+    std::sort(samples.begin(), samples.end());
+    if (samples.empty())
+        return;
+    std::printf("%-40s %10.0f ns median %10.0f ns p99\n", "reactor post wake-up latency",
+                samples[samples.size() / 2], samples[samples.size() * 99 / 100]);
+}
+
+// Throughput of posting from several threads to one loop
+void post_throughput()
+{
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t tasks = 1'000'000;
+
+    vdk::reactor loop;
+    std::size_t executed = 0;
+    std::vector<std::thread> threads;
+
+    auto ns = bench::measure([&]
+    {
+        for (std::size_t i = 0; i < producers; ++i)
+        {
+            threads.emplace_back([&]
+            {
+                for (std::size_t j = 0; j < tasks; ++j)
+                    loop.post([&executed] { ++executed; });
+            });
+        }
+        while (executed != producers * tasks)
+            loop.run_once();
+    });
+    for (auto & thread : threads)
+        thread.join();
+    bench::report("reactor post from 4 threads", ns, executed);
+}
+
+} // namespace
+
+int main()
+{
+    ping_pong();
+    wake_up_latency();
+    post_throughput();
+    return 0;
+}
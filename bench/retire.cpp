@@ -0,0 +1,83 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include <delegate.h>
+#include <retire.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t batches = 40;
+constexpr std::size_t batch_size = 256;
+constexpr std::size_t buffer_size = 256 * 1024;
+
+// Handler that owns a large buffer, released when the handler is destroyed
+vdk::delegate<void()> make_handler(std::size_t & sink)
+{
+    auto buffer = std::make_unique<char[]>(buffer_size);
+    std::memset(buffer.get(), 1, buffer_size);
+    return [buffer = std::move(buffer), &sink] { sink += buffer[0]; };
+}
+
+// Invoke each handler once and drop it; returns latencies of iterations
+template<typename Drop>
+std::vector<double> dispatch(Drop && drop)
+{
+    std::size_t sink = 0;
+    std::vector<double> samples;
+    samples.reserve(batches * batch_size);
+
+    std::vector<vdk::delegate<void()>> handlers(batch_size);
+    for (std::size_t b = 0; b < batches; ++b)
+    {
+        for (auto & handler : handlers)
+            handler = make_handler(sink);
+
+        for (auto & handler : handlers)
+        {
+            samples.push_back(bench::measure([&]
+            {
+                handler();
+                drop(handler);
+            }));
+        }
+    }
+    bench::do_not_optimize(sink);
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+void print(const char * name, const std::vector<double> & samples)
+{
+    std::printf("%-40s %10.0f ns p50 %10.0f ns p99 %10.0f ns max\n", name,
+                samples[samples.size() / 2], samples[samples.size() * 99 / 100],
+                samples.back());
+}
+
+} // namespace
+
+int main()
+{
+    print("destroy on dispatching thread", dispatch([](vdk::delegate<void()> & handler)
+    {
+        handler = nullptr;
+    }));
+
+    vdk::retire_queue queue;
+    vdk::retire_thread reclaimer{ queue };
+    print("retire to background thread", dispatch([&queue](vdk::delegate<void()> & handler)
+    {
+        queue.retire(std::move(handler));
+    }));
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+
+#include <delegate.h>
+#include <strand.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t workers = 16;
+constexpr std::size_t producers = 4;
+constexpr std::size_t messages = 1'000'000;
+
+// Thread pool with one shared queue
+class thread_pool
+{
+public:
+
+    explicit thread_pool(std::size_t threads)
+    {
+        for (std::size_t i = 0; i < threads; ++i)
+            threads_.emplace_back([this] { work(); });
+    }
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (auto & t : threads_)
+            t.join();
+    }
+    void post(vdk::delegate<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            queue_.push_back(std::move(task));
+        }
+        cond_.notify_one();
+    }
+
+private:
+
+    void work()
+    {
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            auto task = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<vdk::delegate<void()>> queue_;
+    std::vector<std::thread> threads_;
+    bool stop_{};
+};
+
+// State of one connection updated by its handlers
+struct connection
+{
+    void handle(std::uint32_t message) noexcept
+    {
+        checksum_ = checksum_ * 31 + message;
+        ++received_;
+    }
+
+    std::uint64_t checksum_{};
+    std::uint64_t received_{};
+};
+
+// Producers post messages to random connections; returns when all are handled
+template<typename Post>
+double run(std::size_t connections, Post && post, std::atomic<std::size_t> & done)
+{
+    return bench::measure([&]
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+            {
+                std::mt19937 gen{ static_cast<std::uint32_t>(p) };
+                std::uniform_int_distribution<std::size_t> target{ 0, connections - 1 };
+                for (std::size_t i = 0; i < messages / producers; ++i)
+                    post(target(gen), static_cast<std::uint32_t>(i));
+            });
+        }
+        for (auto & t : threads)
+            t.join();
+        while (done.load(std::memory_order_acquire) != messages)
+            std::this_thread::yield();
+    });
+}
+
+void run(const char * name, std::size_t connections)
+{
+    {
+        // Every handler is a pool task that locks its connection
+        struct guarded : connection
+        {
+            std::mutex mutex_;
+        };
+        std::vector<guarded> list(connections);
+        std::atomic<std::size_t> done{ 0 };
+        thread_pool pool{ workers };
+
+        auto ns = run(connections, [&](std::size_t c, std::uint32_t message)
+        {
+            pool.post([&list, &done, c, message]
+            {
+                {
+                    std::lock_guard<std::mutex> lock{ list[c].mutex_ };
+                    list[c].handle(message);
+                }
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }, done);
+        bench::report((std::string{ "mutex per connection, " } + name).c_str(), ns, messages);
+    }
+    {
+        // Handlers of one connection are serialized by its strand
+        struct serialized : connection
+        {
+            explicit serialized(thread_pool & pool) : strand_{ pool } {}
+            vdk::strand<thread_pool> strand_;
+        };
+        // Pool's threads are joined before strands are destroyed
+        std::vector<std::unique_ptr<serialized>> list;
+        std::atomic<std::size_t> done{ 0 };
+        thread_pool pool{ workers };
+        for (std::size_t c = 0; c < connections; ++c)
+            list.push_back(std::make_unique<serialized>(pool));
+
+        auto ns = run(connections, [&](std::size_t c, std::uint32_t message)
+        {
+            auto & target = *list[c];
+            target.strand_.post([&target, &done, message]
+            {
+                target.handle(message);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }, done);
+        bench::report((std::string{ "strand per connection, " } + name).c_str(), ns, messages);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    run("10k", 10'000);
+    run("100", 100);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <delegate.h>
+#include <string_dispatcher.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t requests = 1'000'000;
+
+using fn_t = void(std::uint64_t &);
+
+std::vector<std::string> make_keys(std::size_t count)
+{
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < count; ++i)
+        keys.push_back("service" + std::to_string(i % 7) + ".method_" + std::to_string(i));
+    return keys;
+}
+
+// Method names of incoming requests in random order
+std::vector<std::string_view> make_requests(const std::vector<std::string> & keys)
+{
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<std::size_t> pick{ 0, keys.size() - 1 };
+    std::vector<std::string_view> names;
+    for (std::size_t i = 0; i < requests; ++i)
+        names.push_back(keys[pick(gen)]);
+    return names;
+}
+
+void run(std::size_t count)
+{
+    const auto keys = make_keys(count);
+    const auto names = make_requests(keys);
+    std::uint64_t sink = 0;
+    char name[64];
+
+    std::unordered_map<std::string, vdk::delegate<fn_t>> map;
+    vdk::string_dispatcher<fn_t> dispatcher;
+    dispatcher.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto handler = [i](std::uint64_t & s) { s += i; };
+        map.emplace(keys[i], handler);
+        dispatcher.add(keys[i], handler);
+    }
+
+    auto ns = bench::measure([&]
+    {
+        for (const auto & n : names)
+            map.find(std::string{ n })->second(sink);
+    });
+    std::snprintf(name, sizeof(name), "unordered_map, %zu keys", count);
+    bench::report(name, ns, requests);
+
+    ns = bench::measure([&]
+    {
+        for (const auto & n : names)
+            (*dispatcher.find(n))(sink);
+    });
+    std::snprintf(name, sizeof(name), "string_dispatcher, %zu keys", count);
+    bench::report(name, ns, requests);
+
+    bench::do_not_optimize(sink);
+}
+
+// Dispatcher over fixed key set; keys are known at compile time
+template<std::size_t N>
+void run_fixed()
+{
+    const auto keys = make_keys(N);
+    const auto names = make_requests(keys);
+    std::uint64_t sink = 0;
+    char name[64];
+
+    std::array<std::string_view, N> views;
+    for (std::size_t i = 0; i < N; ++i)
+        views[i] = keys[i];
+
+    vdk::string_dispatcher<fn_t, N> dispatcher{ vdk::perfect_hash<N>{ views } };
+    for (std::size_t i = 0; i < N; ++i)
+        dispatcher.assign(keys[i], [i](std::uint64_t & s) { s += i; });
+
+    auto ns = bench::measure([&]
+    {
+        for (const auto & n : names)
+            (*dispatcher.find(n))(sink);
+    });
+    std::snprintf(name, sizeof(name), "string_dispatcher<%zu>", N);
+    bench::report(name, ns, requests);
+
+    bench::do_not_optimize(sink);
+}
+
+} // namespace
+
+int main()
+{
+    run(50);
+    run_fixed<50>();
+    run(500);
+    run_fixed<500>();
+    run(5000);
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <queue>
+#include <string>
+#include <memory>
+#include <random>
+#include <vector>
+#include <cstdint>
+
+#include <delegate.h>
+#include <timer_wheel.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t timers = 1'000'000;
+
+using tick_t = std::uint64_t;
+
+// Mix of short, medium and long timeouts
+std::vector<tick_t> make_delays()
+{
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<tick_t> short_delay{ 1, 100 };
+    std::uniform_int_distribution<tick_t> medium_delay{ 100, 10'000 };
+    std::uniform_int_distribution<tick_t> long_delay{ 10'000, 1'000'000 };
+    std::vector<tick_t> delays(timers);
+    for (std::size_t i = 0; i < timers; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0: delays[i] = short_delay(gen); break;
+        case 1: delays[i] = medium_delay(gen); break;
+        default: delays[i] = long_delay(gen); break;
+        }
+    }
+    return delays;
+}
+
+// Conventional design: binary heap of individually allocated timers
+class heap_timers
+{
+public:
+
+    struct timer
+    {
+        vdk::delegate<void()> callback_;
+        bool cancelled_ = false;
+    };
+
+    std::shared_ptr<timer> schedule(tick_t delay, vdk::delegate<void()> callback)
+    {
+        auto node = std::make_shared<timer>();
+        node->callback_ = std::move(callback);
+        heap_.push(entry{ now_ + delay, node });
+        return node;
+    }
+    static void cancel(const std::shared_ptr<timer> & node) noexcept
+    {
+        node->cancelled_ = true;
+        node->callback_ = nullptr;
+    }
+    std::size_t advance(tick_t ticks)
+    {
+        std::size_t fired = 0;
+        now_ += ticks;
+        while (!heap_.empty() && heap_.top().deadline_ <= now_)
+        {
+            auto node = heap_.top().timer_;
+            heap_.pop();
+            if (!node->cancelled_)
+            {
+                node->callback_();
+                ++fired;
+            }
+        }
+        return fired;
+    }
+
+private:
+
+    struct entry
+    {
+        bool operator<(const entry & other) const noexcept
+        {
+            return deadline_ > other.deadline_;
+        }
+        tick_t deadline_;
+        std::shared_ptr<timer> timer_;
+    };
+
+    std::priority_queue<entry> heap_;
+    tick_t now_ = 0;
+};
+
+template<typename Timers, typename Handles>
+void run(const char * name, Timers & wheel, Handles & handles,
+         const std::vector<tick_t> & delays)
+{
+    std::size_t counter = 0;
+
+    auto ns = bench::measure([&]
+    {
+        for (std::size_t i = 0; i < timers; ++i)
+            handles[i] = wheel.schedule(delays[i], [&counter] { ++counter; });
+    });
+    bench::report((std::string{ name } + " schedule").c_str(), ns, timers);
+
+    ns = bench::measure([&]
+    {
+        for (std::size_t i = 0; i < timers; i += 2)
+            wheel.cancel(handles[i]);
+    });
+    bench::report((std::string{ name } + " cancel").c_str(), ns, timers / 2);
+
+    std::size_t fired = 0;
+    ns = bench::measure([&]
+    {
+        for (tick_t tick = 0; tick <= 1'000'000; ++tick)
+            fired += wheel.advance(1);
+    });
+    bench::report((std::string{ name } + " tick").c_str(), ns, 1'000'001);
+    bench::do_not_optimize(counter);
+
+    if (fired != timers / 2)
+        std::printf("unexpected number of expired timers: %zu\n", fired);
+}
+
+} // namespace
+
+int main()
+{
+    const auto delays = make_delays();
+
+    {
+        vdk::timer_wheel wheel{ timers };
+        std::vector<vdk::timer_wheel::handle> handles(timers);
+        run("timer_wheel", wheel, handles, delays);
+    }
+    {
+        heap_timers heap;
+        std::vector<std::shared_ptr<heap_timers::timer>> handles(timers);
+        run("priority_queue", heap, handles, delays);
+    }
+    return 0;
+}
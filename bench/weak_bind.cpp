@@ -0,0 +1,71 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <memory>
+#include <cstdint>
+
+#include <delegate.h>
+#include <weak_bind.h>
+
+#include "bench.h"
+
+namespace
+{
+constexpr std::size_t calls = 10'000'000;
+
+struct counter : vdk::trackable
+{
+    void add(std::uint32_t value) noexcept { total_ += value; }
+
+    std::uint64_t total_{};
+};
+
+void run(const char * name, vdk::delegate<void(std::uint32_t)> & d)
+{
+    auto ns = bench::measure([&]
+    {
+        for (std::uint32_t i = 0; i < calls; ++i)
+            d(i);
+    });
+    bench::report(name, ns, calls);
+}
+
+} // namespace
+
+int main()
+{
+    auto object = std::make_shared<counter>();
+
+    vdk::delegate<void(std::uint32_t)> locking =
+        [weak = std::weak_ptr<counter>{ object }](std::uint32_t value)
+        {
+            if (auto p = weak.lock())
+                p->add(value);
+        };
+    vdk::delegate<void(std::uint32_t)> weak = vdk::weak_bind<&counter::add>(*object);
+    vdk::delegate<void(std::uint32_t)> strong =
+        [p = object.get()](std::uint32_t value) { p->add(value); };
+
+    run("weak_ptr::lock", locking);
+    run("weak_bind", weak);
+    run("raw pointer (no check)", strong);
+
+    // Dead targets
+    auto other = std::make_shared<counter>();
+    locking = [w = std::weak_ptr<counter>{ other }](std::uint32_t value)
+    {
+        if (auto p = w.lock())
+            p->add(value);
+    };
+    weak = vdk::weak_bind<&counter::add>(*other);
+    other.reset();
+
+    run("weak_ptr::lock (expired)", locking);
+    run("weak_bind (expired)", weak);
+
+    bench::do_not_optimize(object->total_);
+    return 0;
+}
@@ -0,0 +1,526 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_ASYNC_H
+#define VDK_ASYNC_H
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <cassert>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+#include "delegate.h"
+
+namespace vdk
+{
+template<typename R>
+class future;
+
+// Internal implementation details
+namespace internal::async
+{
+using vdk::internal::delegate::memory;
+using vdk::internal::delegate::memory_owner;
+
+// Result slot of asynchronous operation
+template<typename R>
+struct result
+{
+    static_assert(!std::is_reference_v<R>,
+                  "asynchronous operations cannot return references");
+
+    template<typename F>
+    void emplace(F & func)
+    {
+        value_.emplace(func());
+    }
+    R take()
+    {
+        return std::move(*value_);
+    }
+
+    std::optional<R> value_;
+};
+
+template<>
+struct result<void>
+{
+    template<typename F>
+    void emplace(F & func)
+    {
+        func();
+    }
+    void take() noexcept {}
+};
+
+// Shared state of asynchronous operation
+template<typename R>
+class state
+{
+public:
+
+    void release() noexcept;
+
+    bool ready() const;
+    void wait() const;
+    R get();
+
+    void then(vdk::delegate<void()> continuation);
+
+    state(const state &) = delete;
+    state & operator=(const state &) = delete;
+
+protected:
+
+    using destroy_t = void(*)(state*) noexcept;
+
+    explicit state(destroy_t destroy) noexcept;
+    ~state() noexcept = default;
+
+    void retain() noexcept;
+
+    template<typename F>
+    void evaluate(F & func) noexcept;
+    void fail(std::exception_ptr error) noexcept;
+
+private:
+
+    void complete() noexcept;
+
+    std::atomic<unsigned> refs_{ 2 };
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cond_;
+    bool ready_{};
+    result<R> result_;
+    std::exception_ptr error_;
+    vdk::delegate<void()> continuation_;
+    destroy_t destroy_;
+};
+
+template<typename R>
+state<R>::state(destroy_t destroy) noexcept
+    : destroy_{ destroy }
+{}
+
+template<typename R>
+void state<R>::retain() noexcept
+{
+    refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename R>
+void state<R>::release() noexcept
+{
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        destroy_(this);
+}
+
+template<typename R>
+bool state<R>::ready() const
+{
+    std::lock_guard<std::mutex> lock{ mutex_ };
+    return ready_;
+}
+
+template<typename R>
+void state<R>::wait() const
+{
+    std::unique_lock<std::mutex> lock{ mutex_ };
+    cond_.wait(lock, [this] { return ready_; });
+}
+
+template<typename R>
+R state<R>::get()
+{
+    wait();
+    if (error_)
+        std::rethrow_exception(error_);
+    return result_.take();
+}
+
+template<typename R>
+void state<R>::then(vdk::delegate<void()> continuation)
+{
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        if (!ready_)
+        {
+            continuation_ = std::move(continuation);
+            return;
+        }
+    }
+    continuation();
+}
+
+template<typename R>
+template<typename F>
+void state<R>::evaluate(F & func) noexcept
+{
+    try
+    {
+        result_.emplace(func);
+    }
+    catch (...)
+    {
+        error_ = std::current_exception();
+    }
+    complete();
+}
+
+template<typename R>
+void state<R>::fail(std::exception_ptr error) noexcept
+{
+    error_ = std::move(error);
+    complete();
+}
+
+template<typename R>
+void state<R>::complete() noexcept
+{
+    vdk::delegate<void()> continuation;
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        ready_ = true;
+        continuation = std::move(continuation_);
+    }
+    cond_.notify_all();
+    if (continuation) continuation();
+}
+
+// Shared state that also stores the task producing the result
+template<typename R, typename F>
+class task_state final : public state<R>
+{
+public:
+
+    template<typename T>
+    static task_state * create(T && func);
+
+    void run() noexcept;
+    void abandon() noexcept;
+
+    void begin_post() noexcept;
+    void end_post(std::exception_ptr error) noexcept;
+
+private:
+
+    template<typename T>
+    explicit task_state(T && func);
+
+    static void destroy(state<R> * self) noexcept;
+
+    // Whether the task is being posted to an executor
+    enum : unsigned { idle, posting, abandoned };
+
+    std::optional<F> func_;
+    std::atomic<unsigned> posting_{ idle };
+};
+
+template<typename R, typename F>
+template<typename T>
+task_state<R, F> * task_state<R, F>::create(T && func)
+{
+    memory_owner mem{ sizeof(task_state), alignof(task_state) };
+
+    if (!mem.get())
+        throw std::bad_alloc{};
+
+    auto self = ::new (mem.get()) task_state{ std::forward<T>(func) };
+    mem.release();
+    return self;
+}
+
+template<typename R, typename F>
+template<typename T>
+task_state<R, F>::task_state(T && func)
+    : state<R>{ &destroy },
+      func_{ std::in_place, std::forward<T>(func) }
+{}
+
+template<typename R, typename F>
+void task_state<R, F>::run() noexcept
+{
+    this->evaluate(*func_);
+    func_.reset();
+    this->release();
+}
+
+template<typename R, typename F>
+void task_state<R, F>::abandon() noexcept
+{
+    func_.reset();
+    // Task abandoned while it is posted is failed by end_post
+    if (posting_.exchange(abandoned, std::memory_order_acq_rel) != posting)
+        this->fail(std::make_exception_ptr(
+            std::future_error{ std::future_errc::broken_promise }));
+    this->release();
+}
+
+template<typename R, typename F>
+void task_state<R, F>::begin_post() noexcept
+{
+    this->retain();
+    posting_.store(posting, std::memory_order_relaxed);
+}
+
+// Fail the task with the error of executor if it was abandoned during posting
+template<typename R, typename F>
+void task_state<R, F>::end_post(std::exception_ptr error) noexcept
+{
+    if (posting_.exchange(idle, std::memory_order_acq_rel) == abandoned)
+        this->fail(error ? std::move(error) : std::make_exception_ptr(
+            std::future_error{ std::future_errc::broken_promise }));
+    this->release();
+}
+
+template<typename R, typename F>
+void task_state<R, F>::destroy(state<R> * self) noexcept
+{
+    auto p = static_cast<task_state*>(self);
+    p->~task_state();
+    memory()->deallocate(p, sizeof(task_state), alignof(task_state));
+}
+
+// Delegate target that runs the task exactly once
+template<typename S>
+class runner
+{
+public:
+
+    explicit runner(S * state) noexcept
+        : state_{ state }
+    {}
+    runner(runner && other) noexcept
+        : state_{ std::exchange(other.state_, nullptr) }
+    {}
+    ~runner() noexcept
+    {
+        if (state_) state_->abandon();
+    }
+    void operator()() noexcept
+    {
+        assert(state_ != nullptr);
+        std::exchange(state_, nullptr)->run();
+    }
+
+    runner & operator=(runner &&) = delete;
+
+private:
+
+    S * state_;
+};
+
+// Result type of continuation invoked with R
+template<typename R, typename F>
+struct continuation_result
+{
+    using type = std::invoke_result_t<F, R>;
+};
+
+template<typename F>
+struct continuation_result<void, F>
+{
+    using type = std::invoke_result_t<F>;
+};
+
+template<typename R, typename F>
+using continuation_result_t = typename continuation_result<R, F>::type;
+
+// Access to private members of future
+struct access
+{
+    template<typename R>
+    static vdk::future<R> make(state<R> * self) noexcept
+    {
+        return vdk::future<R>{ self };
+    }
+};
+
+} // namespace internal::async
+
+// Result of asynchronous operation
+template<typename R>
+class future final
+{
+    using state_t = internal::async::state<R>;
+
+public:
+
+    future() noexcept = default;
+    future(future && other) noexcept;
+    future & operator=(future && other) noexcept;
+    ~future() noexcept;
+
+    bool valid() const noexcept;
+    bool ready() const;
+    void wait() const;
+    R get();
+
+    template<typename F>
+    auto then(F && func) &&;
+
+    template<typename Executor, typename F>
+    auto then(Executor & executor, F && func) &&;
+
+    future(const future &) = delete;
+    future & operator=(const future &) = delete;
+
+private:
+
+    friend struct internal::async::access;
+
+    explicit future(state_t * state) noexcept;
+
+    template<typename F>
+    auto chain(F && func);
+
+    state_t * state_{};
+};
+
+template<typename R>
+future<R>::future(state_t * state) noexcept
+    : state_{ state }
+{}
+
+template<typename R>
+future<R>::future(future && other) noexcept
+    : state_{ std::exchange(other.state_, nullptr) }
+{}
+
+template<typename R>
+future<R> & future<R>::operator=(future && other) noexcept
+{
+    if (this != &other)
+    {
+        if (state_) state_->release();
+        state_ = std::exchange(other.state_, nullptr);
+    }
+    return *this;
+}
+
+template<typename R>
+future<R>::~future() noexcept
+{
+    if (state_) state_->release();
+}
+
+template<typename R>
+bool future<R>::valid() const noexcept
+{
+    return state_ != nullptr;
+}
+
+template<typename R>
+bool future<R>::ready() const
+{
+    assert(state_ != nullptr);
+    return state_->ready();
+}
+
+template<typename R>
+void future<R>::wait() const
+{
+    assert(state_ != nullptr);
+    state_->wait();
+}
+
+template<typename R>
+R future<R>::get()
+{
+    assert(state_ != nullptr);
+    future self{ std::move(*this) };
+    return self.state_->get();
+}
+
+template<typename R>
+template<typename F>
+auto future<R>::chain(F && func)
+{
+    using U = internal::async::continuation_result_t<R, std::decay_t<F>>;
+
+    auto task = [prev = std::move(*this), func = std::forward<F>(func)]() mutable -> U
+    {
+        if constexpr(std::is_void_v<R>)
+        {
+            prev.get();
+            return std::invoke(std::move(func));
+        }
+        else
+        {
+            return std::invoke(std::move(func), prev.get());
+        }
+    };
+
+    using task_t = decltype(task);
+    return internal::async::task_state<U, task_t>::create(std::move(task));
+}
+
+template<typename R>
+template<typename F>
+auto future<R>::then(F && func) &&
+{
+    assert(state_ != nullptr);
+
+    auto prev = state_;
+    auto next = chain(std::forward<F>(func));
+
+    using runner_t = internal::async::runner<std::remove_pointer_t<decltype(next)>>;
+    prev->then(vdk::delegate<void()>{ runner_t{ next } });
+    return internal::async::access::make(next);
+}
+
+template<typename R>
+template<typename Executor, typename F>
+auto future<R>::then(Executor & executor, F && func) &&
+{
+    assert(state_ != nullptr);
+
+    auto prev = state_;
+    auto next = chain(std::forward<F>(func));
+
+    using runner_t = internal::async::runner<std::remove_pointer_t<decltype(next)>>;
+    prev->then(vdk::delegate<void()>{ [&executor, next, run = runner_t{ next }]() mutable
+    {
+        // If posting fails the continuation completes with the executor's exception
+        std::exception_ptr error;
+        next->begin_post();
+        try
+        {
+            executor.post(vdk::delegate<void()>{ std::move(run) });
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        next->end_post(std::move(error));
+    }});
+    return internal::async::access::make(next);
+}
+
+// Run func through executor and obtain future for its result
+template<typename Executor, typename F>
+auto invoke_async(Executor & executor, F && func)
+{
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+    using state_t = internal::async::task_state<R, std::decay_t<F>>;
+    using runner_t = internal::async::runner<state_t>;
+
+    auto state = state_t::create(std::forward<F>(func));
+    auto result = internal::async::access::make<R>(state);
+    executor.post(vdk::delegate<void()>{ runner_t{ state } });
+    return result;
+}
+
+} // namespace vdk
+
+#endif // VDK_ASYNC_H
@@ -0,0 +1,159 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_AWAITABLE_H
+#define VDK_AWAITABLE_H
+
+#if !defined(__cpp_impl_coroutine)
+#error "awaitable.h requires a compiler with C++20 coroutines support"
+#endif
+
+#include <tuple>
+#include <atomic>
+#include <cassert>
+#include <utility>
+#include <optional>
+#include <coroutine>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::awaitable
+{
+using vdk::internal::delegate::traits;
+
+// Value produced by co_await for completion arguments A...
+template<typename ... A>
+struct result
+{
+    using type = std::tuple<std::decay_t<A>...>;
+};
+
+template<typename A>
+struct result<A>
+{
+    using type = std::decay_t<A>;
+};
+
+template<>
+struct result<>
+{
+    using type = void;
+};
+
+// Completion handler signature without qualifiers
+template<typename> struct signature;
+
+template<typename R, typename ... A>
+struct signature<R(*)(A...)>
+{
+    using type = R(A...);
+    static constexpr bool is_noexcept = false;
+};
+
+template<typename R, typename ... A>
+struct signature<R(*)(A...)noexcept>
+{
+    using type = R(A...);
+    static constexpr bool is_noexcept = true;
+};
+
+// Awaiter that suspends the coroutine until the completion handler is called
+template<typename Fn, typename Initiation,
+         typename = typename signature<typename traits<Fn>::fn_t>::type>
+class awaiter;
+
+template<typename Fn, typename Initiation, typename ... A>
+class awaiter<Fn, Initiation, void(A...)>
+{
+    static constexpr bool is_noexcept =
+        signature<typename traits<Fn>::fn_t>::is_noexcept;
+
+    using result_t = typename result<A...>::type;
+    using slot_t = std::conditional_t<std::is_void_v<result_t>,
+                                      std::tuple<>, result_t>;
+
+    enum : int { initiating, completed, suspended };
+
+    // Completion handler stored by the asynchronous operation
+    class handler
+    {
+    public:
+
+        explicit handler(awaiter * self) noexcept
+            : self_{ self }
+        {}
+        void operator()(A ... args) const noexcept(is_noexcept)
+        {
+            self_->complete(std::forward<A>(args)...);
+        }
+
+    private:
+
+        awaiter * self_;
+    };
+
+    static_assert(internal::delegate::is_internal_v<handler>);
+
+public:
+
+    template<typename I>
+    explicit awaiter(I && init)
+        : init_(std::forward<I>(init))
+    {}
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    bool await_suspend(std::coroutine_handle<> coroutine)
+    {
+        coroutine_ = coroutine;
+        std::move(init_)(vdk::delegate<Fn>{ handler{ this } });
+        // Completion handler might have been called during initiation
+        return state_.exchange(suspended, std::memory_order_acq_rel) != completed;
+    }
+    result_t await_resume()
+    {
+        assert(slot_.has_value());
+        if constexpr(!std::is_void_v<result_t>)
+            return std::move(*slot_);
+    }
+
+    awaiter(const awaiter &) = delete;
+    awaiter & operator=(const awaiter &) = delete;
+
+private:
+
+    void complete(A ... args) noexcept(is_noexcept)
+    {
+        slot_.emplace(std::forward<A>(args)...);
+        if (state_.exchange(completed, std::memory_order_acq_rel) == suspended)
+            coroutine_.resume();
+    }
+
+    Initiation init_;
+    std::coroutine_handle<> coroutine_;
+    std::optional<slot_t> slot_;
+    std::atomic<int> state_{ initiating };
+};
+
+} // namespace internal::awaitable
+
+// Turn asynchronous operation that accepts delegate<Fn> into awaitable
+template<typename Fn, typename Initiation>
+auto awaitable(Initiation && init)
+{
+    return internal::awaitable::awaiter<Fn, std::decay_t<Initiation>>{
+        std::forward<Initiation>(init) };
+}
+
+} // namespace vdk
+
+#endif // VDK_AWAITABLE_H
@@ -0,0 +1,239 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_BIND_FRONT_H
+#define VDK_BIND_FRONT_H
+
+#include <array>
+#include <tuple>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::bind_front
+{
+using std::size_t;
+
+// Single bound value; empty types are stored as base classes
+template<size_t I, typename T,
+         bool = std::is_empty_v<T> && !std::is_final_v<T>>
+struct element
+{
+    template<typename U>
+    explicit element(U && value)
+        : value_(std::forward<U>(value))
+    {}
+
+    T & get() noexcept { return value_; }
+    const T & get() const noexcept { return value_; }
+
+    T value_;
+};
+
+template<size_t I, typename T>
+struct element<I, T, true> : T
+{
+    template<typename U>
+    explicit element(U && value)
+        : T(std::forward<U>(value))
+    {}
+
+    T & get() noexcept { return *this; }
+    const T & get() const noexcept { return *this; }
+};
+
+// Order of elements by decreasing alignment to avoid padding
+template<typename ... T>
+constexpr std::array<size_t, sizeof...(T)> layout() noexcept
+{
+    constexpr size_t count = sizeof...(T);
+    constexpr size_t align[]{ alignof(T)... };
+    std::array<size_t, count> order{};
+    for (size_t i = 0; i < count; ++i)
+        order[i] = i;
+    for (size_t i = 1; i < count; ++i)
+        for (size_t j = i; j > 0 && align[order[j - 1]] < align[order[j]]; --j)
+        {
+            auto tmp = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    return order;
+}
+
+template<size_t I, typename ... T>
+using nth_t = std::tuple_element_t<I, std::tuple<T...>>;
+
+template<typename Layout, typename ... T>
+struct compressed;
+
+template<size_t ... L, typename ... T>
+struct compressed<std::index_sequence<L...>, T...>
+    : element<L, nth_t<L, T...>>...
+{
+    template<typename ... U>
+    explicit compressed(std::tuple<U...> && values)
+        : element<L, nth_t<L, T...>>(std::get<L>(std::move(values)))...
+    {}
+};
+
+template<typename Seq, typename ... T>
+struct layout_sequence;
+
+template<size_t ... I, typename ... T>
+struct layout_sequence<std::index_sequence<I...>, T...>
+{
+    static constexpr auto order = layout<T...>();
+    using type = std::index_sequence<order[I]...>;
+};
+
+template<typename ... T>
+using layout_t = typename layout_sequence<
+    std::index_sequence_for<T...>, T...>::type;
+
+// Callable object with leading arguments bound to it
+template<typename F, typename ... Args>
+class bound : compressed<layout_t<F, Args...>, F, Args...>
+{
+    using base = compressed<layout_t<F, Args...>, F, Args...>;
+    using indices = std::index_sequence_for<Args...>;
+
+    template<size_t I>
+    using element_t = element<I, nth_t<I, F, Args...>>;
+
+    template<size_t I>
+    decltype(auto) get() & noexcept
+    {
+        return static_cast<element_t<I>&>(*this).get();
+    }
+    template<size_t I>
+    decltype(auto) get() const & noexcept
+    {
+        return static_cast<const element_t<I>&>(*this).get();
+    }
+    template<size_t I>
+    decltype(auto) get() && noexcept
+    {
+        return std::move(static_cast<element_t<I>&>(*this).get());
+    }
+    template<size_t I>
+    decltype(auto) get() const && noexcept
+    {
+        return std::move(static_cast<const element_t<I>&>(*this).get());
+    }
+
+    template<typename Self, size_t ... I, typename ... Rest>
+    static decltype(auto) call(Self && self, std::index_sequence<I...>,
+                               Rest && ... rest)
+    {
+        return std::invoke(std::forward<Self>(self).template get<0>(),
+                           std::forward<Self>(self).template get<I + 1>()...,
+                           std::forward<Rest>(rest)...);
+    }
+
+    // Values without std::hash, such as pointers to members, are skipped
+    template<size_t ... I>
+    size_t hash(std::index_sequence<I...>) const noexcept
+    {
+        size_t h = 0;
+        ([&h](const auto & value)
+        {
+            using type = std::decay_t<decltype(value)>;
+            if constexpr(internal::delegate::is_hashable_v<type>)
+                h ^= std::hash<type>{}(value) + 0x9E3779B9 + (h << 6) + (h >> 2);
+        }(get<I>()), ...);
+        return h;
+    }
+
+    template<typename Self, size_t ... I>
+    static bool equal(const Self & lhs, const Self & rhs,
+                      std::index_sequence<I...>) noexcept
+    {
+        return ((lhs.template get<I>() == rhs.template get<I>()) && ...);
+    }
+
+public:
+
+    template<typename G, typename ... U, typename = std::enable_if_t<
+        !std::is_same_v<std::decay_t<G>, bound>>>
+    explicit bound(G && func, U && ... args)
+        : base{ std::forward_as_tuple(std::forward<G>(func),
+                                      std::forward<U>(args)...) }
+    {}
+
+    template<typename ... Rest>
+    auto operator()(Rest && ... rest) &
+        -> std::invoke_result_t<F&, Args&..., Rest...>
+    {
+        return call(*this, indices{}, std::forward<Rest>(rest)...);
+    }
+    template<typename ... Rest>
+    auto operator()(Rest && ... rest) const &
+        -> std::invoke_result_t<const F&, const Args&..., Rest...>
+    {
+        return call(*this, indices{}, std::forward<Rest>(rest)...);
+    }
+    template<typename ... Rest>
+    auto operator()(Rest && ... rest) &&
+        -> std::invoke_result_t<F, Args..., Rest...>
+    {
+        return call(std::move(*this), indices{}, std::forward<Rest>(rest)...);
+    }
+    template<typename ... Rest>
+    auto operator()(Rest && ... rest) const &&
+        -> std::invoke_result_t<const F, const Args..., Rest...>
+    {
+        return call(std::move(*this), indices{}, std::forward<Rest>(rest)...);
+    }
+
+    template<typename B = bound, typename = std::enable_if_t<
+        std::is_same_v<B, bound> &&
+        (internal::delegate::is_equality_comparable_v<const F> && ... &&
+         internal::delegate::is_equality_comparable_v<const Args>)>>
+    bool operator==(const B & other) const noexcept
+    {
+        return equal(*this, other, std::index_sequence_for<F, Args...>{});
+    }
+
+    friend struct std::hash<bound>;
+};
+
+template<typename F, typename ... Args>
+using bound_t = bound<std::decay_t<F>, std::decay_t<Args>...>;
+
+} // namespace internal::bind_front
+
+// Create delegate that invokes func with leading arguments args
+template<typename Fn, typename F, typename ... Args>
+delegate<Fn> bind_front(F && func, Args && ... args)
+{
+    return delegate<Fn>{ internal::bind_front::bound_t<F, Args...>{
+        std::forward<F>(func), std::forward<Args>(args)... } };
+}
+
+} // namespace vdk
+
+namespace std
+{
+// Hash of bound values; delegates use it to hash stored bound objects
+template<typename F, typename ... Args>
+struct hash<vdk::internal::bind_front::bound<F, Args...>>
+{
+    size_t operator()(const vdk::internal::bind_front::bound<F, Args...> & b) const noexcept
+    {
+        return b.hash(index_sequence_for<F, Args...>{});
+    }
+};
+
+} // namespace std
+
+#endif // VDK_BIND_FRONT_H
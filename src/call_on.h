@@ -0,0 +1,288 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_CALL_ON_H
+#define VDK_CALL_ON_H
+
+#if !defined(__linux__)
+#error "call_on.h requires Linux (futex)"
+#endif
+
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <type_traits>
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "delegate.h"
+#include "mpsc_queue.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::call_on
+{
+using word = std::atomic<std::uint32_t>;
+
+static_assert(sizeof(word) == sizeof(std::uint32_t) && word::is_always_lock_free,
+              "futex requires lock-free 32-bit atomic");
+
+// Sleep while the word holds the expected value; may return spuriously
+inline void wait(word & w, std::uint32_t expected) noexcept
+{
+    ::syscall(SYS_futex, &w, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+// Wake the thread sleeping on the word; the word itself is not accessed,
+// so the call is harmless if its owner has already returned
+inline void wake(word & w) noexcept
+{
+    ::syscall(SYS_futex, &w, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+// Request queued to inbox; lives on the stack of the waiting caller
+struct task : mpsc::node
+{
+    static constexpr std::uint32_t pending = 0;
+    static constexpr std::uint32_t sleeping = 1;
+    static constexpr std::uint32_t done = 2;
+
+    void wait() noexcept;
+
+    void(*run_)(task*) noexcept;
+    word state_{ pending };
+};
+
+inline void task::wait() noexcept
+{
+    // Short spin covers fast handoffs without system calls
+    for (int i = 0; i < 64; ++i)
+    {
+        if (state_.load(std::memory_order_acquire) == done)
+            return;
+    }
+
+    auto expected = pending;
+    if (!state_.compare_exchange_strong(expected, sleeping, std::memory_order_acq_rel))
+        return;
+    do
+        internal::call_on::wait(state_, sleeping);
+    while (state_.load(std::memory_order_acquire) != done);
+}
+
+// Result slot: value, pointer for references, flag for void
+template<typename R>
+using stored_t = std::conditional_t<std::is_void_v<R>, bool,
+                 std::conditional_t<std::is_reference_v<R>,
+                 std::remove_reference_t<R>*, R>>;
+
+// Invocation of caller's delegate with the result kept in the caller's frame
+template<typename R>
+class call final : public task
+{
+public:
+
+    explicit call(vdk::delegate<R()> & func) noexcept;
+
+    R get();
+
+private:
+
+    static void run(task * self) noexcept;
+
+    vdk::delegate<R()> & func_;
+    std::optional<stored_t<R>> result_;
+    std::exception_ptr error_;
+};
+
+template<typename R>
+call<R>::call(vdk::delegate<R()> & func) noexcept
+    : task{ {}, &run },
+      func_{ func }
+{}
+
+template<typename R>
+R call<R>::get()
+{
+    if (error_)
+        std::rethrow_exception(error_);
+
+    if constexpr(std::is_reference_v<R>)
+        return static_cast<R>(**result_);
+    else if constexpr(!std::is_void_v<R>)
+        return std::move(*result_);
+}
+
+template<typename R>
+void call<R>::run(task * self) noexcept
+{
+    auto p = static_cast<call*>(self);
+    try
+    {
+        if constexpr(std::is_void_v<R>)
+        {
+            p->func_();
+            p->result_.emplace(true);
+        }
+        else if constexpr(std::is_reference_v<R>)
+            p->result_.emplace(std::addressof(p->func_()));
+        else
+            p->result_.emplace(p->func_());
+    }
+    catch (...)
+    {
+        p->error_ = std::current_exception();
+    }
+
+    // Caller may return as soon as it observes the new state
+    auto & state = p->state_;
+    if (state.exchange(done, std::memory_order_acq_rel) == sleeping)
+        wake(state);
+}
+
+} // namespace internal::call_on
+
+// Queue of synchronous calls to be executed by the thread that owns it
+class thread_inbox final
+{
+public:
+
+    thread_inbox() noexcept;
+    ~thread_inbox() noexcept;
+
+    std::size_t drain() noexcept;
+    void wait() noexcept;
+
+    bool owned_by_this_thread() const noexcept;
+
+    thread_inbox(const thread_inbox &) = delete;
+    thread_inbox & operator=(const thread_inbox &) = delete;
+
+private:
+
+    template<typename R>
+    friend R call_on(thread_inbox & inbox, delegate<R()> & func);
+
+    using task = internal::call_on::task;
+
+    void post(task * item) noexcept;
+    task * take() noexcept;
+
+    internal::mpsc::queue queue_;
+    task * next_{};
+
+    // Bumped by every post; owner sleeps on it while the queue is empty
+    alignas(internal::mpsc::cache_line) internal::call_on::word signal_{ 0 };
+    std::atomic<bool> sleeping_{ false };
+
+    const std::thread::id owner_;
+};
+
+inline thread_inbox::thread_inbox() noexcept
+    : owner_{ std::this_thread::get_id() }
+{}
+
+inline thread_inbox::~thread_inbox() noexcept
+{
+    assert(!next_ && !queue_.pop() && "thread_inbox is destroyed with pending calls");
+}
+
+// Only the owner thread may drain the inbox
+inline std::size_t thread_inbox::drain() noexcept
+{
+    assert(owned_by_this_thread());
+
+    std::size_t count = 0;
+    while (auto item = take())
+    {
+        item->run_(item);
+        ++count;
+    }
+    return count;
+}
+
+// Block the owner thread until at least one call is queued
+inline void thread_inbox::wait() noexcept
+{
+    assert(owned_by_this_thread());
+
+    for (;;)
+    {
+        sleeping_.store(true, std::memory_order_seq_cst);
+        const auto seq = signal_.load(std::memory_order_seq_cst);
+
+        if (!next_)
+            next_ = static_cast<task*>(queue_.pop());
+        if (next_)
+            break;
+        internal::call_on::wait(signal_, seq);
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
+}
+
+inline bool thread_inbox::owned_by_this_thread() const noexcept
+{
+    return owner_ == std::this_thread::get_id();
+}
+
+inline void thread_inbox::post(task * item) noexcept
+{
+    queue_.push(item);
+    signal_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_seq_cst))
+        internal::call_on::wake(signal_);
+}
+
+inline thread_inbox::task * thread_inbox::take() noexcept
+{
+    if (next_)
+        return std::exchange(next_, nullptr);
+    return static_cast<task*>(queue_.pop());
+}
+
+// Run func on the thread that owns inbox and wait for its result;
+// called from the owner thread, func runs immediately
+template<typename R>
+R call_on(thread_inbox & inbox, delegate<R()> & func)
+{
+    assert(func);
+    if (inbox.owned_by_this_thread())
+        return func();
+
+    internal::call_on::call<R> request{ func };
+    inbox.post(&request);
+    request.wait();
+    return request.get();
+}
+
+// Temporary delegate is invoked in place as well
+template<typename R>
+R call_on(thread_inbox & inbox, delegate<R()> && func)
+{
+    return call_on(inbox, func);
+}
+
+// Callable object is invoked through a delegate that refers to it,
+// so nothing is allocated regardless of its size
+template<typename F, typename = std::enable_if_t<
+    !std::is_same_v<std::decay_t<F>, delegate<std::invoke_result_t<F&>()>>>>
+decltype(auto) call_on(thread_inbox & inbox, F && func)
+{
+    using result_t = std::invoke_result_t<F&>;
+    return call_on(inbox, delegate<result_t()>{ [&func]() -> result_t { return func(); } });
+}
+
+} // namespace vdk
+
+#endif // VDK_CALL_ON_H
@@ -0,0 +1,224 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_COALESCING_QUEUE_H
+#define VDK_COALESCING_QUEUE_H
+
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::coalescing_queue
+{
+using std::uint32_t;
+using std::uint64_t;
+
+inline constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+
+// Final mixing step of splitmix64; hashes of pointers have zero low bits
+inline uint32_t mix(uint64_t x) noexcept
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<uint32_t>(x ^ (x >> 31));
+}
+
+// Slot of index: hash of pending delegate and its position
+struct slot
+{
+    uint32_t hash_;
+    uint32_t pos_;
+};
+
+} // namespace internal::coalescing_queue
+
+template<typename Fn> class coalescing_queue;
+
+// Queue of pending delegates where a delegate equal to one already
+// pending is dropped; flush runs the unique set in order of posting
+template<typename R, typename ... A>
+class coalescing_queue<R(A...)> final
+{
+public:
+
+    coalescing_queue() noexcept = default;
+
+    bool post(delegate<R(A...)> task);
+    std::size_t flush(A ... args);
+    void clear() noexcept;
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t coalesced() const noexcept;
+
+    coalescing_queue(const coalescing_queue &) = delete;
+    coalescing_queue & operator=(const coalescing_queue &) = delete;
+
+private:
+
+    using slot = internal::coalescing_queue::slot;
+
+    void grow();
+    void reset() noexcept;
+
+    std::vector<delegate<R(A...)>> pending_;
+    std::vector<slot> index_;
+    std::size_t indexed_{};
+    std::size_t coalesced_{};
+};
+
+// Returns false if an equal delegate is pending and task is dropped
+template<typename R, typename ... A>
+bool coalescing_queue<R(A...)>::post(delegate<R(A...)> task)
+{
+    using internal::coalescing_queue::empty;
+    assert(task);
+
+    const auto h = internal::coalescing_queue::mix(std::hash<delegate<R(A...)>>{}(task));
+    const auto mask = index_.size() - 1;
+
+    if (indexed_)
+    {
+        for (auto pos = h & mask; index_[pos].pos_ != empty; pos = (pos + 1) & mask)
+        {
+            if (index_[pos].hash_ == h && pending_[index_[pos].pos_] == task)
+            {
+                ++coalesced_;
+                return false;
+            }
+        }
+    }
+
+    // Target that cannot be compared is never equal to another one
+    if (!(task == task))
+    {
+        pending_.push_back(std::move(task));
+        return true;
+    }
+
+    if ((indexed_ + 1) * 2 > index_.size())
+        grow();
+    pending_.push_back(std::move(task));
+
+    const auto new_mask = index_.size() - 1;
+    auto pos = h & new_mask;
+    while (index_[pos].pos_ != empty)
+        pos = (pos + 1) & new_mask;
+    index_[pos] = { h, static_cast<std::uint32_t>(pending_.size() - 1) };
+    ++indexed_;
+    return true;
+}
+
+// Invoke pending delegates; delegates posted meanwhile run in the next flush.
+// If a delegate throws, the rest of the batch is posted again ahead of them.
+template<typename R, typename ... A>
+std::size_t coalescing_queue<R(A...)>::flush(A ... args)
+{
+    std::vector<delegate<R(A...)>> batch;
+    batch.swap(pending_);
+    reset();
+
+    std::size_t i = 0;
+    try
+    {
+        for (; i < batch.size(); ++i)
+            batch[i](args...);
+    }
+    catch (...)
+    {
+        // Memory is reserved before anything is moved, so posting the
+        // rest of the batch and the delegates posted meanwhile cannot throw
+        const auto rest = batch.size() - i - 1;
+        std::vector<delegate<R(A...)>> posted;
+        posted.reserve(pending_.size() + rest);
+        while ((indexed_ + rest) * 2 > index_.size())
+            grow();
+
+        posted.swap(pending_);
+        reset();
+        while (++i < batch.size())
+            post(std::move(batch[i]));
+        for (auto & task : posted)
+            post(std::move(task));
+        throw;
+    }
+
+    // Keep capacity for the next burst
+    const auto count = batch.size();
+    batch.clear();
+    if (pending_.empty())
+        pending_.swap(batch);
+    return count;
+}
+
+template<typename R, typename ... A>
+void coalescing_queue<R(A...)>::clear() noexcept
+{
+    pending_.clear();
+    reset();
+}
+
+template<typename R, typename ... A>
+std::size_t coalescing_queue<R(A...)>::size() const noexcept
+{
+    return pending_.size();
+}
+
+template<typename R, typename ... A>
+bool coalescing_queue<R(A...)>::empty() const noexcept
+{
+    return pending_.empty();
+}
+
+// Number of posts dropped since construction
+template<typename R, typename ... A>
+std::size_t coalescing_queue<R(A...)>::coalesced() const noexcept
+{
+    return coalesced_;
+}
+
+// Double the index; positions are recomputed from the stored hashes
+template<typename R, typename ... A>
+void coalescing_queue<R(A...)>::grow()
+{
+    using internal::coalescing_queue::empty;
+
+    std::vector<slot> index(index_.empty() ? 16 : index_.size() * 2, slot{ 0, empty });
+    const auto mask = index.size() - 1;
+    for (const auto & s : index_)
+    {
+        if (s.pos_ == empty)
+            continue;
+        auto pos = s.hash_ & mask;
+        while (index[pos].pos_ != empty)
+            pos = (pos + 1) & mask;
+        index[pos] = s;
+    }
+    index_.swap(index);
+}
+
+template<typename R, typename ... A>
+void coalescing_queue<R(A...)>::reset() noexcept
+{
+    if (!indexed_)
+        return;
+    for (auto & s : index_)
+        s.pos_ = internal::coalescing_queue::empty;
+    indexed_ = 0;
+}
+
+} // namespace vdk
+
+#endif // VDK_COALESCING_QUEUE_H
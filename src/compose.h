@@ -0,0 +1,291 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_COMPOSE_H
+#define VDK_COMPOSE_H
+
+#include <tuple>
+#include <cstddef>
+#include <utility>
+#include <optional>
+#include <functional>
+#include <type_traits>
+
+#include "delegate.h"
+#include "bind_front.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::compose
+{
+using std::size_t;
+using internal::bind_front::element;
+using internal::bind_front::compressed;
+using internal::bind_front::layout_t;
+using internal::bind_front::nth_t;
+
+// Value produced by a stage that returns void
+struct none {};
+
+template<typename T>
+using value_t = std::conditional_t<std::is_void_v<T>, none, T>;
+
+template<typename T>
+struct is_optional : std::false_type {};
+template<typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+template<typename T> inline constexpr
+bool is_optional_v = is_optional<std::decay_t<T>>::value;
+
+// Invoke stage with value of previous stage
+template<typename F, typename V>
+decltype(auto) call(F & stage, V && value)
+{
+    if constexpr(std::is_same_v<std::decay_t<V>, none>)
+        return std::invoke(stage);
+    else
+        return std::invoke(stage, std::forward<V>(value));
+}
+
+template<typename F, typename V>
+inline constexpr bool is_direct_v = std::is_same_v<std::decay_t<V>, none> ?
+    std::is_invocable_v<F&> : std::is_invocable_v<F&, V>;
+
+template<typename F, typename V>
+using call_t = value_t<decltype(call(std::declval<F&>(), std::declval<V>()))>;
+
+// Value contained in optional V
+template<typename V, bool = is_optional_v<V>>
+struct unwrap
+{
+    using type = V;
+};
+
+template<typename V>
+struct unwrap<V, true>
+{
+    using type = decltype(*std::declval<V>());
+};
+
+template<typename V>
+using unwrap_t = typename unwrap<V>::type;
+
+// Compile-time walk through stages that determines the result type
+template<bool Short, typename V, typename ... F>
+struct chain
+{
+    static constexpr bool is_short = Short;
+    using type = V;
+};
+
+template<bool Short, typename V, typename F, typename ... Rest>
+struct chain<Short, V, F, Rest...>
+{
+    // Empty optional that the stage cannot accept stops the pipeline
+    static constexpr bool is_direct = is_direct_v<F, V>;
+
+    static_assert(is_direct || (is_optional_v<V> && std::is_invocable_v<F&, unwrap_t<V>>),
+                  "stage of pipeline is not invocable with result of previous stage");
+
+    using arg_t = std::conditional_t<is_direct, V, unwrap_t<V>>;
+    using next = chain<Short || !is_direct, call_t<F, arg_t>, Rest...>;
+
+    static constexpr bool is_short = next::is_short;
+    using type = typename next::type;
+};
+
+// Result of the whole pipeline
+template<bool Short, typename V>
+struct result
+{
+    using type = std::conditional_t<std::is_same_v<V, none>, void, V>;
+};
+
+template<typename V>
+struct result<true, V>
+{
+    using type = std::conditional_t<std::is_same_v<V, none>, void,
+                 std::conditional_t<is_optional_v<V>, std::decay_t<V>,
+                                    std::optional<std::decay_t<V>>>>;
+};
+
+// Callable object that passes result of each stage to the next one
+template<typename ... F>
+class composed : compressed<layout_t<F...>, F...>
+{
+    using base = compressed<layout_t<F...>, F...>;
+
+    static constexpr size_t count = sizeof...(F);
+
+    template<size_t I>
+    using stage_t = nth_t<I, F...>;
+
+    template<size_t I>
+    stage_t<I> & get() noexcept
+    {
+        return static_cast<element<I, stage_t<I>>&>(*this).get();
+    }
+    template<size_t I>
+    const stage_t<I> & get() const noexcept
+    {
+        return static_cast<const element<I, stage_t<I>>&>(*this).get();
+    }
+
+    template<typename Q, typename ... A>
+    using first_t = value_t<std::invoke_result_t<Q&, A...>>;
+
+    template<typename Self, typename ... A>
+    struct info
+    {
+        template<size_t I>
+        using q = std::conditional_t<std::is_const_v<Self>,
+                                     const stage_t<I>, stage_t<I>>;
+
+        template<size_t ... I>
+        static auto walk(std::index_sequence<I...>)
+            -> chain<false, first_t<q<0>, A...>, q<I + 1>...>;
+
+        using chain_t = decltype(walk(std::make_index_sequence<count - 1>{}));
+        using type = typename result<chain_t::is_short,
+                                     typename chain_t::type>::type;
+    };
+
+    template<typename Self, typename ... A>
+    using result_t = typename info<Self, A...>::type;
+
+    // Pass value to stage I and the rest of the pipeline
+    template<typename R, size_t I, typename Self, typename V>
+    static R run(Self & self, V && value)
+    {
+        if constexpr(I == count)
+        {
+            if constexpr(!std::is_void_v<R>)
+                return R(std::forward<V>(value));
+        }
+        else
+        {
+            auto & stage = self.template get<I>();
+            using stage_q = std::remove_reference_t<decltype(stage)>;
+
+            if constexpr(is_direct_v<stage_q, V>)
+            {
+                return step<R, I>(self, stage, std::forward<V>(value));
+            }
+            else
+            {
+                if (!value)
+                {
+                    if constexpr(!std::is_void_v<R>)
+                        return R{};
+                    else
+                        return;
+                }
+                return step<R, I>(self, stage, *std::forward<V>(value));
+            }
+        }
+    }
+
+    template<typename R, size_t I, typename Self, typename Q, typename V>
+    static R step(Self & self, Q & stage, V && value)
+    {
+        if constexpr(std::is_void_v<decltype(call(stage, std::forward<V>(value)))>)
+        {
+            call(stage, std::forward<V>(value));
+            return run<R, I + 1>(self, none{});
+        }
+        else
+        {
+            return run<R, I + 1>(self, call(stage, std::forward<V>(value)));
+        }
+    }
+
+    template<typename R, typename Self, typename ... A>
+    static R start(Self & self, A && ... args)
+    {
+        auto & stage = self.template get<0>();
+        if constexpr(std::is_void_v<std::invoke_result_t<decltype(stage), A...>>)
+        {
+            std::invoke(stage, std::forward<A>(args)...);
+            return run<R, 1>(self, none{});
+        }
+        else
+        {
+            return run<R, 1>(self, std::invoke(stage, std::forward<A>(args)...));
+        }
+    }
+
+    template<size_t ... I>
+    static bool equal(const composed & lhs, const composed & rhs,
+                      std::index_sequence<I...>) noexcept
+    {
+        return ((lhs.template get<I>() == rhs.template get<I>()) && ...);
+    }
+
+public:
+
+    template<typename ... G, typename = std::enable_if_t<
+        sizeof...(G) == count && !std::is_same_v<
+            std::decay_t<nth_t<0, G...>>, composed>>>
+    explicit composed(G && ... stages)
+        : base{ std::forward_as_tuple(std::forward<G>(stages)...) }
+    {}
+
+    template<typename ... A, typename = std::enable_if_t<
+        std::is_invocable_v<stage_t<0>&, A...>>>
+    auto operator()(A && ... args) & -> result_t<composed, A...>
+    {
+        return start<result_t<composed, A...>>(*this, std::forward<A>(args)...);
+    }
+    template<typename ... A, typename = std::enable_if_t<
+        std::is_invocable_v<const stage_t<0>&, A...>>>
+    auto operator()(A && ... args) const & -> result_t<const composed, A...>
+    {
+        return start<result_t<const composed, A...>>(*this, std::forward<A>(args)...);
+    }
+    template<typename ... A, typename = std::enable_if_t<
+        std::is_invocable_v<stage_t<0>&, A...>>>
+    auto operator()(A && ... args) && -> result_t<composed, A...>
+    {
+        return start<result_t<composed, A...>>(*this, std::forward<A>(args)...);
+    }
+    template<typename ... A, typename = std::enable_if_t<
+        std::is_invocable_v<const stage_t<0>&, A...>>>
+    auto operator()(A && ... args) const && -> result_t<const composed, A...>
+    {
+        return start<result_t<const composed, A...>>(*this, std::forward<A>(args)...);
+    }
+
+    template<typename C = composed, typename = std::enable_if_t<
+        std::is_same_v<C, composed> &&
+        (internal::delegate::is_equality_comparable_v<const F> && ...)>>
+    bool operator==(const C & other) const noexcept
+    {
+        return equal(*this, other, std::index_sequence_for<F...>{});
+    }
+};
+
+} // namespace internal::compose
+
+// Create callable object that invokes stages one after another
+template<typename ... F>
+auto compose(F && ... stages)
+{
+    static_assert(sizeof...(F) > 0, "compose requires at least one stage");
+    return internal::compose::composed<std::decay_t<F>...>{
+        std::forward<F>(stages)... };
+}
+
+// Create delegate that invokes stages one after another
+template<typename Fn, typename ... F>
+delegate<Fn> pipeline(F && ... stages)
+{
+    return delegate<Fn>{ compose(std::forward<F>(stages)...) };
+}
+
+} // namespace vdk
+
+#endif // VDK_COMPOSE_H
@@ -11,8 +11,17 @@
 #include <cassert>
 #include <cstddef>
 #include <utility>
+#include <functional>
 #include <type_traits>
 
+#if defined(VDK_DELEGATE_INSTRUMENTATION)
+#include "instrumentation.h"
+#define VDK_DELEGATE_PROBE(T)\
+    vdk::internal::instrumentation::probe<T, traits> probe_{ VDK_DELEGATE_CALL_SITE() }
+#else
+#define VDK_DELEGATE_PROBE(T) static_cast<void>(0)
+#endif
+
 namespace vdk
 {
 namespace memory::delegate
@@ -117,6 +126,16 @@ struct is_equality_comparable<T,
 template<typename T> inline constexpr bool
 is_equality_comparable_v = is_equality_comparable<T>::value;
 
+// Check whether std::hash is enabled for T
+template<typename T, typename = std::size_t>
+struct is_hashable : std::false_type {};
+template<typename T>
+struct is_hashable<T,
+    decltype(std::hash<T>{}(std::declval<const T&>()))>
+    : std::true_type {};
+template<typename T> inline constexpr bool
+is_hashable_v = is_hashable<T>::value;
+
 // Structure to estimate size and alignment of internal buffer
 struct block
 {
@@ -130,15 +149,16 @@ struct block
     undef*p4;
 };
 
-// Check whether T can be stored in internal buffer
-template<typename T> inline constexpr
-bool is_internal_v = sizeof(T) <= sizeof(block) &&
-                     alignof(T) <= alignof(block) &&
-                     std::is_nothrow_move_constructible_v<T>;
-
 // Internal storage for delegate
-struct storage
+template<size_t Size, size_t Align>
+struct basic_storage
 {
+    // Check whether T can be stored in the buffer
+    template<typename T>
+    static constexpr bool fits_v = sizeof(T) <= Size &&
+                                   alignof(T) <= Align &&
+                                   std::is_nothrow_move_constructible_v<T>;
+
     void * get() noexcept;
     const void * get() const noexcept;
     volatile void * get() volatile noexcept;
@@ -153,80 +173,103 @@ struct storage
     template<typename T>
     const volatile T * get_as() const volatile noexcept;
 
-    std::aligned_storage_t<sizeof(block), alignof(block)> data_;
+    std::aligned_storage_t<Size, Align> data_;
 };
 
-inline void * storage::get() noexcept
+template<size_t Size, size_t Align>
+inline void * basic_storage<Size, Align>::get() noexcept
 {
     return &data_;
 }
-inline const void * storage::get() const noexcept
+template<size_t Size, size_t Align>
+inline const void * basic_storage<Size, Align>::get() const noexcept
 {
     return &data_;
 }
-inline volatile void * storage::get() volatile noexcept
+template<size_t Size, size_t Align>
+inline volatile void * basic_storage<Size, Align>::get() volatile noexcept
 {
     return &data_;
 }
-inline const volatile void * storage::get() const volatile noexcept
+template<size_t Size, size_t Align>
+inline const volatile void * basic_storage<Size, Align>::get() const volatile noexcept
 {
     return &data_;
 }
+template<size_t Size, size_t Align>
 template<typename T>
-inline T * storage::get_as() noexcept
+inline T * basic_storage<Size, Align>::get_as() noexcept
 {
-    if constexpr(is_internal_v<T>)
+    if constexpr(fits_v<T>)
         return static_cast<T*>(get());
     else
         return *static_cast<T**>(get());
 }
+template<size_t Size, size_t Align>
 template<typename T>
-inline const T * storage::get_as() const noexcept
+inline const T * basic_storage<Size, Align>::get_as() const noexcept
 {
-    if constexpr(is_internal_v<T>)
+    if constexpr(fits_v<T>)
         return static_cast<const T*>(get());
     else
         return *static_cast<const T*const*>(get());
 }
+template<size_t Size, size_t Align>
 template<typename T>
-inline volatile T * storage::get_as() volatile noexcept
+inline volatile T * basic_storage<Size, Align>::get_as() volatile noexcept
 {
-    if constexpr(is_internal_v<T>)
+    if constexpr(fits_v<T>)
         return static_cast<volatile T*>(get());
     else
         return *static_cast<volatile T*volatile*>(get());
 }
+template<size_t Size, size_t Align>
 template<typename T>
-inline const volatile T * storage::get_as() const volatile noexcept
+inline const volatile T * basic_storage<Size, Align>::get_as() const volatile noexcept
 {
-    if constexpr(is_internal_v<T>)
+    if constexpr(fits_v<T>)
         return static_cast<const volatile T*>(get());
     else
         return *static_cast<const volatile T*const volatile*>(get());
 }
 
+// Storage of delegate: targets that do not fit are allocated
+using storage = basic_storage<sizeof(block), alignof(block)>;
+
+// Check whether T can be stored in internal buffer
+template<typename T> inline constexpr
+bool is_internal_v = storage::fits_v<T>;
+
 // Artificial virtual table
-struct vtbl
+template<typename S>
+struct basic_vtbl
 {
-    void(*move)(storage&, storage&)noexcept;
-    bool(*compare)(const storage&, const storage&)noexcept;
-    void(*destroy)(storage&)noexcept;
+    void(*move)(S&, S&)noexcept;
+    bool(*compare)(const S&, const S&)noexcept;
+    void(*destroy)(S&)noexcept;
+    std::size_t(*hash)(const S&)noexcept;
 };
 
+using vtbl = basic_vtbl<storage>;
+
 // Move stored callable object
-template<typename T>
-inline void move(storage & src, storage & dst) noexcept
+template<typename T, typename S>
+inline void move(S & src, S & dst) noexcept
 {
-    if constexpr(is_internal_v<T>)
-        ::new (dst.get()) T{ std::move(*src.template get_as<T>()) };
+    if constexpr(S::template fits_v<T>)
+    {
+        auto p = src.template get_as<T>();
+        ::new (dst.get()) T{ std::move(*p) };
+        p->~T();
+    }
     else
         *dst.template get_as<T*>() = src.template get_as<T>();
 }
 
 // Compare stored callable objects
-template<typename T>
-inline bool compare([[maybe_unused]] const storage & lhs,
-                    [[maybe_unused]] const storage & rhs) noexcept
+template<typename T, typename S>
+inline bool compare([[maybe_unused]] const S & lhs,
+                    [[maybe_unused]] const S & rhs) noexcept
 {
     if constexpr(is_equality_comparable_v<T>)
         return *lhs.template get_as<T>() == *rhs.template get_as<T>();
@@ -234,11 +277,22 @@ inline bool compare([[maybe_unused]] const storage & lhs,
         return false;
 }
 
+// Hash of stored callable object; equal objects of types without hash share one value,
+// std::hash<delegate> mixes in the virtual table so that distinct types spread
+template<typename T, typename S>
+inline std::size_t hash([[maybe_unused]] const S & self) noexcept
+{
+    if constexpr(is_hashable_v<T>)
+        return std::hash<T>{}(*self.template get_as<T>());
+    else
+        return 0;
+}
+
 // Destroy stored callable object
-template<typename T>
-inline void destroy(storage & self) noexcept
+template<typename T, typename S>
+inline void destroy(S & self) noexcept
 {
-    if constexpr(is_internal_v<T>)
+    if constexpr(S::template fits_v<T>)
     {
         self.template get_as<T>()->~T();
     }
@@ -250,23 +304,131 @@ inline void destroy(storage & self) noexcept
     }
 }
 
-// Obtain virtual table for type T
-template<typename T> inline
-const vtbl * vtable() noexcept
+// Construct callable object in storage
+template<typename T>
+inline bool construct(storage & self, T && func)
+{
+    using type = std::decay_t<T>;
+
+    if constexpr(is_internal_v<type>)
+    {
+        ::new (self.get()) type{ std::forward<T>(func) };
+    }
+    else
+    {
+        memory_owner mem{ sizeof(type), alignof(type) };
+
+        if (!mem.get())
+            return false;
+
+        *self.template get_as<type*>() =
+            ::new (mem.get()) type{ std::forward<T>(func) };
+        mem.release();
+    }
+    return true;
+}
+
+// Obtain virtual table for type T kept in storage S;
+// delegate itself must use delegate_vtable, since apply() relies on its layout
+template<typename T, typename S = storage> inline
+const basic_vtbl<S> * vtable() noexcept
 {
-    static constexpr vtbl tbl{ &move<T>, &compare<T>, &destroy<T> };
+    static constexpr basic_vtbl<S> tbl{
+        &move<T, S>, &compare<T, S>, &destroy<T, S>, &hash<T, S> };
     return &tbl;
 }
 
+// Targets opt in to batch calls by declaring member type batch_overload
+template<typename T, typename = void>
+struct has_batch_overload : std::false_type {};
+
+template<typename T>
+struct has_batch_overload<T, std::void_t<typename T::batch_overload>> : std::true_type {};
+
+// Batch calls over arrays for element-wise signatures R(A)
+template<typename Fn>
+struct batch_traits
+{
+    static constexpr bool enabled = false;
+};
+
+#define VDK_NONE
+#define VDK_BATCH_TRAITS(CVQUAL, NOEXCEPT)\
+template<typename R, typename A>\
+struct batch_traits<R(A) CVQUAL NOEXCEPT>\
+{\
+    using value_t = std::remove_cv_t<std::remove_reference_t<A>>;\
+    using result_t = std::remove_reference_t<R>;\
+    using call_t = void(*)(CVQUAL storage*, const value_t*, result_t*, size_t)NOEXCEPT;\
+\
+    static constexpr bool enabled = !std::is_void_v<R> && !std::is_reference_v<R> &&\
+        (!std::is_reference_v<A> || std::is_const_v<std::remove_reference_t<A>>);\
+    static constexpr bool is_const = std::is_const_v<CVQUAL value_t>;\
+    static constexpr bool is_noexcept = noexcept(std::declval<void(*)()NOEXCEPT>()());\
+\
+    template<typename T>\
+    static void call(CVQUAL storage * self, const value_t * in,\
+                     result_t * out, size_t count)NOEXCEPT\
+    {\
+        (*self->template get_as<T>())(in, out, count);\
+    }\
+\
+    template<typename T>\
+    static constexpr call_t thunk() noexcept\
+    {\
+        if constexpr(!has_batch_overload<T>::value)\
+            return nullptr;\
+        else if constexpr(is_noexcept ?\
+            std::is_nothrow_invocable_v<CVQUAL T&, const value_t*, result_t*, size_t> :\
+            std::is_invocable_v<CVQUAL T&, const value_t*, result_t*, size_t>)\
+            return &call<T>;\
+        else\
+            return nullptr;\
+    }\
+};
+
+VDK_BATCH_TRAITS(VDK_NONE, VDK_NONE)
+VDK_BATCH_TRAITS(const, VDK_NONE)
+VDK_BATCH_TRAITS(VDK_NONE, noexcept)
+VDK_BATCH_TRAITS(const, noexcept)
+
+#undef VDK_NONE
+#undef VDK_BATCH_TRAITS
+
+// Virtual table with batch call thunk; thunk is null if target has no batch overload
+template<typename S, typename B>
+struct batch_vtbl : basic_vtbl<S>
+{
+    B batch;
+};
+
+// Obtain virtual table for type T kept in delegate with signature Fn;
+// for batch-enabled signatures every vptr_ of delegate<Fn> must come from here
+template<typename T, typename Fn> inline
+const vtbl * delegate_vtable() noexcept
+{
+    using batch = batch_traits<Fn>;
+
+    if constexpr(batch::enabled)
+    {
+        static constexpr batch_vtbl<storage, typename batch::call_t> tbl{
+            { &move<T, storage>, &compare<T, storage>, &destroy<T, storage>, &hash<T, storage> },
+            batch::template thunk<T>() };
+        return &tbl;
+    }
+    else
+        return vtable<T>();
+}
+
 // Traits for supported delegate types
-template<typename> struct traits;
+template<typename, typename = storage> struct traits;
 
 #define VDK_NONE
 #define VDK_TRAITS_CV_LR(CVQUAL, LRQUAL)\
-template<typename R, typename ... A>\
-struct traits<R(A...) CVQUAL LRQUAL> : storage\
+template<typename R, typename ... A, typename S>\
+struct traits<R(A...) CVQUAL LRQUAL, S> : S\
 {\
-    R(*call_)(CVQUAL storage*, A&&...) {};\
+    R(*call_)(CVQUAL S*, A&&...) {};\
 \
     using fn_t = R(*)(A...);\
 \
@@ -275,9 +437,10 @@ struct traits<R(A...) CVQUAL LRQUAL> : storage\
         std::is_invocable_r_v<R, CVQUAL T LRQUAL, A...>;\
 \
     template<typename T>\
-    static R invoke(CVQUAL storage * self, A&& ... args)\
+    static R invoke(CVQUAL S * self, A&& ... args)\
     {\
-        return (*self->get_as<T>())(std::forward<A>(args)...);\
+        VDK_DELEGATE_PROBE(T);\
+        return (*self->template get_as<T>())(std::forward<A>(args)...);\
     }\
     inline R operator()(A ... args) CVQUAL LRQUAL\
     {\
@@ -286,10 +449,10 @@ struct traits<R(A...) CVQUAL LRQUAL> : storage\
     }\
 };
 #define VDK_TRAITS_CV_LR_NOEXCEPT(CVQUAL, LRQUAL)\
-template<typename R, typename ... A>\
-struct traits<R(A...) CVQUAL LRQUAL noexcept> : storage\
+template<typename R, typename ... A, typename S>\
+struct traits<R(A...) CVQUAL LRQUAL noexcept, S> : S\
 {\
-    R(*call_)(CVQUAL storage*, A&&...)noexcept {};\
+    R(*call_)(CVQUAL S*, A&&...)noexcept {};\
 \
     using fn_t = R(*)(A...)noexcept;\
 \
@@ -298,9 +461,10 @@ struct traits<R(A...) CVQUAL LRQUAL noexcept> : storage\
         std::is_nothrow_invocable_r_v<R, CVQUAL T LRQUAL, A...>;\
 \
     template<typename T>\
-    static R invoke(CVQUAL storage * self, A&& ... args)noexcept\
+    static R invoke(CVQUAL S * self, A&& ... args)noexcept\
     {\
-        return (*self->get_as<T>())(std::forward<A>(args)...);\
+        VDK_DELEGATE_PROBE(T);\
+        return (*self->template get_as<T>())(std::forward<A>(args)...);\
     }\
     inline R operator()(A ... args) CVQUAL LRQUAL noexcept\
     {\
@@ -309,10 +473,10 @@ struct traits<R(A...) CVQUAL LRQUAL noexcept> : storage\
     }\
 };
 #define VDK_TRAITS_CV_RR(CVQUAL)\
-template<typename R, typename ... A>\
-struct traits<R(A...) CVQUAL &&> : storage\
+template<typename R, typename ... A, typename S>\
+struct traits<R(A...) CVQUAL &&, S> : S\
 {\
-    R(*call_)(CVQUAL storage*, A&&...) {};\
+    R(*call_)(CVQUAL S*, A&&...) {};\
 \
     using fn_t = R(*)(A...);\
 \
@@ -321,9 +485,10 @@ struct traits<R(A...) CVQUAL &&> : storage\
         std::is_invocable_r_v<R, CVQUAL T &&, A...>;\
 \
     template<typename T>\
-    static R invoke(CVQUAL storage * self, A&& ... args)\
+    static R invoke(CVQUAL S * self, A&& ... args)\
     {\
-        return std::move(*self->get_as<T>())(std::forward<A>(args)...);\
+        VDK_DELEGATE_PROBE(T);\
+        return std::move(*self->template get_as<T>())(std::forward<A>(args)...);\
     }\
     inline R operator()(A ... args) CVQUAL &&\
     {\
@@ -332,10 +497,10 @@ struct traits<R(A...) CVQUAL &&> : storage\
     }\
 };
 #define VDK_TRAITS_CV_RR_NOEXCEPT(CVQUAL)\
-template<typename R, typename ... A>\
-struct traits<R(A...) CVQUAL && noexcept> : storage\
+template<typename R, typename ... A, typename S>\
+struct traits<R(A...) CVQUAL && noexcept, S> : S\
 {\
-    R(*call_)(CVQUAL storage*, A&&...)noexcept {};\
+    R(*call_)(CVQUAL S*, A&&...)noexcept {};\
 \
     using fn_t = R(*)(A...)noexcept;\
 \
@@ -344,9 +509,10 @@ struct traits<R(A...) CVQUAL && noexcept> : storage\
         std::is_nothrow_invocable_r_v<R, CVQUAL T &&, A...>;\
 \
     template<typename T>\
-    static R invoke(CVQUAL storage * self, A&& ... args)noexcept\
+    static R invoke(CVQUAL S * self, A&& ... args)noexcept\
     {\
-        return std::move(*self->get_as<T>())(std::forward<A>(args)...);\
+        VDK_DELEGATE_PROBE(T);\
+        return std::move(*self->template get_as<T>())(std::forward<A>(args)...);\
     }\
     inline R operator()(A ... args) CVQUAL && noexcept\
     {\
@@ -385,6 +551,7 @@ VDK_TRAITS_CV_RR_NOEXCEPT(const volatile)
 #undef VDK_TRAITS_CV_LR_NOEXCEPT
 #undef VDK_TRAITS_CV_RR
 #undef VDK_TRAITS_CV_RR_NOEXCEPT
+#undef VDK_DELEGATE_PROBE
 
 } // namespace internal::delegate
 
@@ -398,6 +565,8 @@ class delegate final : internal::delegate::traits<Fn>
     using base::call_;
     using typename base::fn_t;
 
+    using batch = internal::delegate::batch_traits<Fn>;
+
     template<typename T> static constexpr
         bool is_internal_v = internal::delegate::is_internal_v<T>;
     template<typename T> static constexpr
@@ -427,6 +596,16 @@ public:
     using base::operator();
     explicit operator bool() const noexcept;
 
+    template<typename B = batch, typename =
+        std::enable_if_t<B::enabled>>
+    void apply(const typename B::value_t * in, typename B::result_t * out,
+               std::size_t count) noexcept(B::is_noexcept);
+
+    template<typename B = batch, typename =
+        std::enable_if_t<B::enabled && B::is_const>>
+    void apply(const typename B::value_t * in, typename B::result_t * out,
+               std::size_t count) const noexcept(B::is_noexcept);
+
     bool operator==(const delegate & other) const noexcept;
     bool operator!=(const delegate & other) const noexcept;
 
@@ -435,6 +614,12 @@ public:
 
 private:
 
+    template<typename B, typename Self>
+    static void apply_batch(Self & self, const typename B::value_t * in,
+                      typename B::result_t * out, std::size_t count) noexcept(B::is_noexcept);
+
+    friend struct std::hash<delegate>;
+
     const vtbl * vptr_{};
 };
 
@@ -444,7 +629,7 @@ delegate<Fn>::delegate(fn_t func) noexcept
     if (!func) return;
     *(base::template get_as<fn_t>()) = func;
     call_ = &base::template invoke<fn_t>;
-    vptr_ = internal::delegate::vtable<fn_t>();
+    vptr_ = internal::delegate::delegate_vtable<fn_t, Fn>();
 }
 
 template<typename Fn>
@@ -454,26 +639,11 @@ delegate<Fn>::delegate(F func) noexcept(is_internal_v<F>)
     if constexpr(std::is_pointer_v<F>)
         if (!func) return;
 
-    if constexpr(is_internal_v<F>)
-    {
-        ::new (base::get()) F{ std::move(func) };
-    }
-    else
-    {
-        internal::delegate::memory_owner mem{ sizeof(F), alignof(F) };
-
-        if (mem.get())
-        {
-            *(base::template get_as<F*>()) =
-                ::new (mem.get()) F{ std::move(func) };
-            mem.release();
-        }
-        else
-            return;
-    }
+    if (!internal::delegate::construct(*this, std::move(func)))
+        return;
 
     call_ = &base::template invoke<F>;
-    vptr_ = internal::delegate::vtable<F>();
+    vptr_ = internal::delegate::delegate_vtable<F, Fn>();
 }
 
 template<typename Fn>
@@ -517,7 +687,7 @@ delegate<Fn> & delegate<Fn>::operator=(fn_t func) noexcept
     if (vptr_) vptr_->destroy(*this);
     *(base::template get_as<fn_t>()) = func;
     call_ = &base::template invoke<fn_t>;
-    vptr_ = internal::delegate::vtable<fn_t>();
+    vptr_ = internal::delegate::delegate_vtable<fn_t, Fn>();
     return *this;
 }
 
@@ -549,7 +719,7 @@ delegate<Fn> & delegate<Fn>::operator=(F func) noexcept(is_internal_v<F>)
     }
 
     call_ = &base::template invoke<F>;
-    vptr_ = internal::delegate::vtable<F>();
+    vptr_ = internal::delegate::delegate_vtable<F, Fn>();
     return *this;
 }
 
@@ -565,6 +735,41 @@ delegate<Fn>::operator bool() const noexcept
     return vptr_ != nullptr;
 }
 
+template<typename Fn>
+template<typename B, typename>
+void delegate<Fn>::apply(const typename B::value_t * in, typename B::result_t * out,
+                         std::size_t count) noexcept(B::is_noexcept)
+{
+    apply_batch<B>(*this, in, out, count);
+}
+
+template<typename Fn>
+template<typename B, typename>
+void delegate<Fn>::apply(const typename B::value_t * in, typename B::result_t * out,
+                         std::size_t count) const noexcept(B::is_noexcept)
+{
+    apply_batch<B>(*this, in, out, count);
+}
+
+// Batch thunk of the target, or one call per element if the target has none
+template<typename Fn>
+template<typename B, typename Self>
+void delegate<Fn>::apply_batch(Self & self, const typename B::value_t * in,
+                         typename B::result_t * out, std::size_t count) noexcept(B::is_noexcept)
+{
+    assert(self.vptr_ != nullptr);
+    using table_t = internal::delegate::batch_vtbl<
+        internal::delegate::storage, typename B::call_t>;
+
+    if (auto thunk = static_cast<const table_t*>(self.vptr_)->batch)
+    {
+        thunk(&self, in, out, count);
+        return;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = self(in[i]);
+}
+
 template<typename Fn>
 bool delegate<Fn>::operator==(const delegate & other) const noexcept
 {
@@ -607,4 +812,22 @@ bool operator!=(std::nullptr_t, const delegate<Fn> & rhs) noexcept
 
 } // namespace vdk
 
+namespace std
+{
+// Hash consistent with operator==: equal delegates keep targets
+// of the same type, so the virtual table is a part of the hash
+template<typename Fn>
+struct hash<vdk::delegate<Fn>>
+{
+    std::size_t operator()(const vdk::delegate<Fn> & d) const noexcept
+    {
+        if (!d.vptr_)
+            return 0;
+        const auto type = std::hash<const void*>{}(d.vptr_);
+        return type ^ (d.vptr_->hash(d) + 0x9E3779B9 + (type << 6) + (type >> 2));
+    }
+};
+
+} // namespace std
+
 #endif // VDK_DELEGATE_H
\ No newline at end of file
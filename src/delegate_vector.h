@@ -0,0 +1,520 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_DELEGATE_VECTOR_H
+#define VDK_DELEGATE_VECTOR_H
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "delegate.h"
+#include "dispatch_table.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::delegate_vector
+{
+using std::size_t;
+using vdk::internal::delegate::storage;
+using vdk::internal::delegate::memory;
+
+// Bump allocator over a list of chunks; memory of single targets is never freed,
+// it is reclaimed only when all chunks are released
+class arena
+{
+public:
+
+    arena() noexcept = default;
+    arena(arena && other) noexcept;
+    arena & operator=(arena && other) noexcept;
+    ~arena() noexcept;
+
+    void * allocate(size_t size, size_t align);
+    bool reserve(size_t size);
+    void adopt(arena & other) noexcept;
+    void clear() noexcept;
+
+    size_t used() const noexcept;
+
+    arena(const arena &) = delete;
+    arena & operator=(const arena &) = delete;
+
+private:
+
+    struct chunk
+    {
+        chunk * next_;
+        size_t size_;
+    };
+
+    static constexpr size_t alignment = alignof(std::max_align_t);
+    static constexpr size_t header =
+        (sizeof(chunk) + alignment - 1) / alignment * alignment;
+    static constexpr size_t min_chunk = 4 * 1024;
+    static constexpr size_t max_chunk = 1024 * 1024;
+
+    bool grow(size_t size);
+
+    chunk * head_{};
+    std::byte * top_{};
+    std::byte * end_{};
+    size_t next_{ min_chunk };
+    size_t used_{};
+};
+
+inline arena::arena(arena && other) noexcept
+    : head_{ std::exchange(other.head_, nullptr) },
+      top_{ std::exchange(other.top_, nullptr) },
+      end_{ std::exchange(other.end_, nullptr) },
+      next_{ std::exchange(other.next_, min_chunk) },
+      used_{ std::exchange(other.used_, 0) }
+{}
+
+inline arena & arena::operator=(arena && other) noexcept
+{
+    if (this != &other)
+    {
+        clear();
+        head_ = std::exchange(other.head_, nullptr);
+        top_ = std::exchange(other.top_, nullptr);
+        end_ = std::exchange(other.end_, nullptr);
+        next_ = std::exchange(other.next_, min_chunk);
+        used_ = std::exchange(other.used_, 0);
+    }
+    return *this;
+}
+
+inline arena::~arena() noexcept
+{
+    clear();
+}
+
+// Returns null pointer if memory resource returns null pointer
+inline void * arena::allocate(size_t size, size_t align)
+{
+    void * addr = top_;
+    auto space = static_cast<size_t>(end_ - top_);
+
+    if (!addr || !std::align(align, size, addr, space))
+    {
+        if (!grow(size + align - 1))
+            return nullptr;
+        addr = top_;
+        space = static_cast<size_t>(end_ - top_);
+        std::align(align, size, addr, space);
+    }
+    top_ = static_cast<std::byte*>(addr) + size;
+    used_ += size;
+    return addr;
+}
+
+// Make sure that the next size bytes are allocated from one chunk
+inline bool arena::reserve(size_t size)
+{
+    if (static_cast<size_t>(end_ - top_) >= size)
+        return true;
+    return grow(size);
+}
+
+// Take chunks of other arena; allocation continues in the current chunk
+inline void arena::adopt(arena & other) noexcept
+{
+    if (!other.head_)
+        return;
+
+    if (head_)
+    {
+        auto last = other.head_;
+        while (last->next_)
+            last = last->next_;
+        last->next_ = head_->next_;
+        head_->next_ = other.head_;
+        used_ += other.used_;
+        other.head_ = nullptr;
+        other.top_ = nullptr;
+        other.end_ = nullptr;
+        other.next_ = min_chunk;
+        other.used_ = 0;
+    }
+    else
+        *this = std::move(other);
+}
+
+inline void arena::clear() noexcept
+{
+    while (head_)
+    {
+        auto next = head_->next_;
+        memory()->deallocate(head_, head_->size_, alignment);
+        head_ = next;
+    }
+    top_ = nullptr;
+    end_ = nullptr;
+    next_ = min_chunk;
+    used_ = 0;
+}
+
+// Bytes handed out by the arena, excluding padding
+inline size_t arena::used() const noexcept
+{
+    return used_;
+}
+
+inline bool arena::grow(size_t size)
+{
+    const auto bytes = std::max(header + size, next_);
+    auto addr = memory()->allocate(bytes, alignment);
+    if (!addr)
+        return false;
+
+    head_ = ::new (addr) chunk{ head_, bytes };
+    top_ = static_cast<std::byte*>(addr) + header;
+    end_ = static_cast<std::byte*>(addr) + bytes;
+    next_ = std::min(next_ * 2, max_chunk);
+    return true;
+}
+
+// Artificial virtual table of element; memory of targets belongs to arena
+struct element_vtbl
+{
+    void(*move)(storage&, storage&)noexcept;
+    void(*destroy)(storage&)noexcept;
+    void(*relocate)(storage&, void*);
+    size_t size;
+    size_t align;
+};
+
+// Destroy stored callable object without releasing its memory
+template<typename T>
+inline void destroy(storage & self) noexcept
+{
+    self.template get_as<T>()->~T();
+}
+
+// Move callable object kept outside of storage to the given address
+template<typename T>
+inline void relocate(storage & self, void * addr)
+{
+    auto p = self.template get_as<T>();
+    auto q = ::new (addr) T{ std::move(*p) };
+    p->~T();
+    *self.template get_as<T*>() = q;
+}
+
+// Obtain virtual table for type T kept in element
+template<typename T> inline
+const element_vtbl * vtable() noexcept
+{
+    using vdk::internal::delegate::move;
+
+    if constexpr(vdk::internal::delegate::is_internal_v<T>)
+    {
+        static constexpr element_vtbl tbl{
+            &move<T, storage>, &destroy<T>, nullptr, 0, 0 };
+        return &tbl;
+    }
+    else
+    {
+        static constexpr element_vtbl tbl{
+            &move<T, storage>, &destroy<T>, &relocate<T>, sizeof(T), alignof(T) };
+        return &tbl;
+    }
+}
+
+// Single element: call thunk, target and virtual table
+template<typename Call>
+struct element
+{
+    element() noexcept = default;
+    element(element && other) noexcept;
+    element & operator=(element && other) noexcept;
+    ~element() noexcept;
+
+    Call call_{};
+    storage target_;
+    const element_vtbl * vptr_{};
+};
+
+template<typename Call>
+element<Call>::element(element && other) noexcept
+    : call_{ std::exchange(other.call_, nullptr) },
+      vptr_{ std::exchange(other.vptr_, nullptr) }
+{
+    if (vptr_) vptr_->move(other.target_, target_);
+}
+
+template<typename Call>
+element<Call> & element<Call>::operator=(element && other) noexcept
+{
+    if (this != &other)
+    {
+        if (vptr_) vptr_->destroy(target_);
+        call_ = std::exchange(other.call_, nullptr);
+        vptr_ = std::exchange(other.vptr_, nullptr);
+        if (vptr_) vptr_->move(other.target_, target_);
+    }
+    return *this;
+}
+
+template<typename Call>
+element<Call>::~element() noexcept
+{
+    if (vptr_) vptr_->destroy(target_);
+}
+
+} // namespace internal::delegate_vector
+
+// Sequence of delegate targets; targets that do not fit into elements
+// are kept in the container's own arena in insertion order
+template<typename Fn>
+class delegate_vector final
+{
+    using traits = internal::delegate::traits<Fn>;
+    using invoker = internal::dispatch_table::invoker<typename traits::fn_t>;
+    using call_t = typename invoker::call_t;
+    using element = internal::delegate_vector::element<call_t>;
+
+    static_assert(std::is_same_v<Fn, std::remove_pointer_t<typename traits::fn_t>>,
+                  "delegate_vector supports only signatures without cv | ref qualifiers");
+
+    template<typename T> static constexpr
+        bool is_internal_v = internal::delegate::is_internal_v<T>;
+    template<typename T> static constexpr
+        bool is_invocable_v = traits::template is_invocable_v<T>;
+
+public:
+
+    using fn_t = typename traits::fn_t;
+
+    delegate_vector() noexcept = default;
+    delegate_vector(delegate_vector && other) noexcept;
+    delegate_vector & operator=(delegate_vector && other) noexcept;
+    ~delegate_vector() noexcept;
+
+    void push_back(fn_t func);
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    void push_back(F func);
+
+    void erase(std::size_t index) noexcept;
+    void pop_back() noexcept;
+    void clear() noexcept;
+
+    void reserve(std::size_t count);
+    void compact();
+
+    template<typename ... Args>
+    decltype(auto) invoke(std::size_t index, Args && ... args)
+        noexcept(std::is_nothrow_invocable_v<Fn*, Args...>);
+
+    template<typename ... Args>
+    void invoke_all(Args && ... args)
+        noexcept(std::is_nothrow_invocable_v<Fn*, Args&...>);
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t reclaimable() const noexcept;
+
+    delegate_vector(const delegate_vector &) = delete;
+    delegate_vector & operator=(const delegate_vector &) = delete;
+
+private:
+
+    // Arena outlives elements whose targets it keeps
+    internal::delegate_vector::arena arena_;
+    std::vector<element> elements_;
+    std::size_t live_{};
+};
+
+template<typename Fn>
+delegate_vector<Fn>::delegate_vector(delegate_vector && other) noexcept
+    : arena_{ std::move(other.arena_) },
+      elements_{ std::move(other.elements_) },
+      live_{ std::exchange(other.live_, 0) }
+{
+    other.elements_.clear();
+}
+
+template<typename Fn>
+delegate_vector<Fn> & delegate_vector<Fn>::operator=(delegate_vector && other) noexcept
+{
+    if (this != &other)
+    {
+        clear();
+        elements_ = std::move(other.elements_);
+        arena_ = std::move(other.arena_);
+        live_ = std::exchange(other.live_, 0);
+        other.elements_.clear();
+    }
+    return *this;
+}
+
+template<typename Fn>
+delegate_vector<Fn>::~delegate_vector() noexcept
+{
+    clear();
+}
+
+template<typename Fn>
+void delegate_vector<Fn>::push_back(fn_t func)
+{
+    if (!func) return;
+    auto & e = elements_.emplace_back();
+    *(e.target_.template get_as<fn_t>()) = func;
+    e.call_ = &traits::template invoke<fn_t>;
+    e.vptr_ = internal::delegate_vector::vtable<fn_t>();
+}
+
+template<typename Fn>
+template<typename F, typename>
+void delegate_vector<Fn>::push_back(F func)
+{
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return;
+
+    auto & e = elements_.emplace_back();
+
+    if constexpr(is_internal_v<F>)
+    {
+        ::new (e.target_.get()) F{ std::move(func) };
+    }
+    else
+    {
+        struct guard
+        {
+            // Element without virtual table owns nothing
+            ~guard() noexcept { if (!done_) elements_.pop_back(); }
+            std::vector<element> & elements_;
+            bool done_;
+        } adding{ elements_, false };
+
+        // Memory of a target that failed to construct is reclaimed by compaction
+        auto addr = arena_.allocate(sizeof(F), alignof(F));
+        if (!addr)
+            return;
+        *(e.target_.template get_as<F*>()) = ::new (addr) F{ std::move(func) };
+        live_ += sizeof(F);
+        adding.done_ = true;
+    }
+
+    e.call_ = &traits::template invoke<F>;
+    e.vptr_ = internal::delegate_vector::vtable<F>();
+}
+
+template<typename Fn>
+void delegate_vector<Fn>::erase(std::size_t index) noexcept
+{
+    assert(index < elements_.size());
+    live_ -= elements_[index].vptr_->size;
+    elements_.erase(elements_.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+template<typename Fn>
+void delegate_vector<Fn>::pop_back() noexcept
+{
+    assert(!elements_.empty());
+    live_ -= elements_.back().vptr_->size;
+    elements_.pop_back();
+}
+
+template<typename Fn>
+void delegate_vector<Fn>::clear() noexcept
+{
+    elements_.clear();
+    arena_.clear();
+    live_ = 0;
+}
+
+template<typename Fn>
+void delegate_vector<Fn>::reserve(std::size_t count)
+{
+    elements_.reserve(count);
+}
+
+// Move targets into one new chunk in the order of elements, then release old chunks
+template<typename Fn>
+void delegate_vector<Fn>::compact()
+{
+    std::size_t bytes = 0;
+    for (const auto & e : elements_)
+        if (e.vptr_->relocate)
+            bytes += e.vptr_->size + e.vptr_->align - 1;
+
+    internal::delegate_vector::arena fresh;
+    if (bytes && !fresh.reserve(bytes))
+        return;
+
+    struct guard
+    {
+        // If a move throws, moved targets stay in the new chunk and the rest in old ones
+        ~guard() noexcept
+        {
+            if (!done_) fresh_.adopt(arena_);
+            arena_ = std::move(fresh_);
+        }
+        internal::delegate_vector::arena & fresh_;
+        internal::delegate_vector::arena & arena_;
+        bool done_;
+    } compacting{ fresh, arena_, false };
+
+    for (auto & e : elements_)
+    {
+        if (auto relocate = e.vptr_->relocate)
+            relocate(e.target_, fresh.allocate(e.vptr_->size, e.vptr_->align));
+    }
+    compacting.done_ = true;
+}
+
+template<typename Fn>
+template<typename ... Args>
+decltype(auto) delegate_vector<Fn>::invoke(std::size_t index, Args && ... args)
+    noexcept(std::is_nothrow_invocable_v<Fn*, Args...>)
+{
+    assert(index < elements_.size());
+    auto & e = elements_[index];
+    return invoker::call(e.call_, &e.target_, std::forward<Args>(args)...);
+}
+
+// Arguments are passed to every target as lvalues
+template<typename Fn>
+template<typename ... Args>
+void delegate_vector<Fn>::invoke_all(Args && ... args)
+    noexcept(std::is_nothrow_invocable_v<Fn*, Args&...>)
+{
+    for (auto & e : elements_)
+        invoker::call(e.call_, &e.target_, args...);
+}
+
+template<typename Fn>
+std::size_t delegate_vector<Fn>::size() const noexcept
+{
+    return elements_.size();
+}
+
+template<typename Fn>
+bool delegate_vector<Fn>::empty() const noexcept
+{
+    return elements_.empty();
+}
+
+// Bytes of arena taken by erased targets that compact() would release
+template<typename Fn>
+std::size_t delegate_vector<Fn>::reclaimable() const noexcept
+{
+    return arena_.used() - live_;
+}
+
+} // namespace vdk
+
+#endif // VDK_DELEGATE_VECTOR_H
@@ -0,0 +1,295 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_DISPATCH_TABLE_H
+#define VDK_DISPATCH_TABLE_H
+
+#include <new>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::dispatch_table
+{
+using vdk::internal::delegate::storage;
+
+// Invocation of stored call thunks with the table's signature
+template<typename> struct invoker;
+
+template<typename R, typename ... A>
+struct invoker<R(*)(A...)>
+{
+    using call_t = R(*)(storage*, A&&...);
+
+    static R call(call_t func, storage * self, A ... args)
+    {
+        assert(func != nullptr);
+        return func(self, std::forward<A>(args)...);
+    }
+};
+
+template<typename R, typename ... A>
+struct invoker<R(*)(A...)noexcept>
+{
+    using call_t = R(*)(storage*, A&&...)noexcept;
+
+    static R call(call_t func, storage * self, A ... args) noexcept
+    {
+        assert(func != nullptr);
+        return func(self, std::forward<A>(args)...);
+    }
+};
+
+// Issue a read prefetch for the given address
+inline void prefetch([[maybe_unused]] const void * addr) noexcept
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(addr, 0, 3);
+#endif
+}
+
+} // namespace internal::dispatch_table
+
+// Fixed-size table of delegate targets indexed by number
+template<typename Fn, std::size_t N>
+class dispatch_table final
+{
+    using traits = internal::delegate::traits<Fn>;
+    using storage = internal::delegate::storage;
+    using vtbl = internal::delegate::vtbl;
+    using invoker = internal::dispatch_table::invoker<typename traits::fn_t>;
+    using call_t = typename invoker::call_t;
+
+    static_assert(std::is_same_v<Fn, std::remove_pointer_t<typename traits::fn_t>>,
+                  "dispatch_table supports only signatures without cv | ref qualifiers");
+
+    template<typename T> static constexpr
+        bool is_internal_v = internal::delegate::is_internal_v<T>;
+    template<typename T> static constexpr
+        bool is_invocable_v = traits::template is_invocable_v<T>;
+
+public:
+
+    using fn_t = typename traits::fn_t;
+
+    class reference;
+
+    dispatch_table() noexcept = default;
+    ~dispatch_table() noexcept;
+
+    void assign(std::size_t index, fn_t func) noexcept;
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    void assign(std::size_t index, F func) noexcept(is_internal_v<F>);
+
+    template<typename InputIt>
+    void assign(std::size_t first, InputIt begin, InputIt end);
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    void fill(const F & func);
+
+    void reset(std::size_t index) noexcept;
+    void clear() noexcept;
+
+    bool contains(std::size_t index) const noexcept;
+    void prefetch(std::size_t index) const noexcept;
+
+    reference operator[](std::size_t index) noexcept;
+    static constexpr std::size_t size() noexcept;
+
+    dispatch_table(const dispatch_table &) = delete;
+    dispatch_table & operator=(const dispatch_table &) = delete;
+
+private:
+
+    call_t calls_[N]{};
+    storage targets_[N];
+    const vtbl * vptrs_[N]{};
+};
+
+// Proxy for a single entry of dispatch table
+template<typename Fn, std::size_t N>
+class dispatch_table<Fn, N>::reference final
+{
+public:
+
+    template<typename ... Args>
+    decltype(auto) operator()(Args && ... args) const
+        noexcept(std::is_nothrow_invocable_v<Fn*, Args...>);
+
+    template<typename F>
+    reference & operator=(F func);
+
+    explicit operator bool() const noexcept;
+
+private:
+
+    friend class dispatch_table;
+
+    reference(dispatch_table & table, std::size_t index) noexcept;
+
+    dispatch_table & table_;
+    std::size_t index_;
+};
+
+template<typename Fn, std::size_t N>
+dispatch_table<Fn, N>::~dispatch_table() noexcept
+{
+    clear();
+}
+
+template<typename Fn, std::size_t N>
+void dispatch_table<Fn, N>::assign(std::size_t index, fn_t func) noexcept
+{
+    assert(index < N);
+    if (!func) return;
+    reset(index);
+    *(targets_[index].template get_as<fn_t>()) = func;
+    calls_[index] = &traits::template invoke<fn_t>;
+    vptrs_[index] = internal::delegate::vtable<fn_t>();
+}
+
+template<typename Fn, std::size_t N>
+template<typename F, typename>
+void dispatch_table<Fn, N>::
+assign(std::size_t index, F func) noexcept(is_internal_v<F>)
+{
+    assert(index < N);
+
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return;
+
+    auto & target = targets_[index];
+
+    if constexpr(is_internal_v<F>)
+    {
+        reset(index);
+        ::new (target.get()) F{ std::move(func) };
+    }
+    else
+    {
+        internal::delegate::memory_owner mem{ sizeof(F), alignof(F) };
+
+        if (mem.get())
+        {
+            auto addr = ::new (mem.get()) F{ std::move(func) };
+            reset(index);
+            *(target.template get_as<F*>()) = addr;
+            mem.release();
+        }
+        else
+            return;
+    }
+
+    calls_[index] = &traits::template invoke<F>;
+    vptrs_[index] = internal::delegate::vtable<F>();
+}
+
+template<typename Fn, std::size_t N>
+template<typename InputIt>
+void dispatch_table<Fn, N>::
+assign(std::size_t first, InputIt begin, InputIt end)
+{
+    for (; begin != end; ++begin, ++first)
+        assign(first, *begin);
+}
+
+template<typename Fn, std::size_t N>
+template<typename F, typename>
+void dispatch_table<Fn, N>::fill(const F & func)
+{
+    for (std::size_t index = 0; index < N; ++index)
+        assign(index, func);
+}
+
+template<typename Fn, std::size_t N>
+void dispatch_table<Fn, N>::reset(std::size_t index) noexcept
+{
+    assert(index < N);
+    if (vptrs_[index]) vptrs_[index]->destroy(targets_[index]);
+    calls_[index] = nullptr;
+    vptrs_[index] = nullptr;
+}
+
+template<typename Fn, std::size_t N>
+void dispatch_table<Fn, N>::clear() noexcept
+{
+    for (std::size_t index = 0; index < N; ++index)
+        reset(index);
+}
+
+template<typename Fn, std::size_t N>
+bool dispatch_table<Fn, N>::contains(std::size_t index) const noexcept
+{
+    assert(index < N);
+    return calls_[index] != nullptr;
+}
+
+template<typename Fn, std::size_t N>
+void dispatch_table<Fn, N>::prefetch(std::size_t index) const noexcept
+{
+    assert(index < N);
+    internal::dispatch_table::prefetch(&calls_[index]);
+    internal::dispatch_table::prefetch(&targets_[index]);
+}
+
+template<typename Fn, std::size_t N>
+typename dispatch_table<Fn, N>::reference
+dispatch_table<Fn, N>::operator[](std::size_t index) noexcept
+{
+    assert(index < N);
+    return reference{ *this, index };
+}
+
+template<typename Fn, std::size_t N>
+constexpr std::size_t dispatch_table<Fn, N>::size() noexcept
+{
+    return N;
+}
+
+template<typename Fn, std::size_t N>
+dispatch_table<Fn, N>::reference::
+reference(dispatch_table & table, std::size_t index) noexcept
+    : table_{ table },
+      index_{ index }
+{}
+
+template<typename Fn, std::size_t N>
+template<typename ... Args>
+decltype(auto) dispatch_table<Fn, N>::reference::
+operator()(Args && ... args) const
+    noexcept(std::is_nothrow_invocable_v<Fn*, Args...>)
+{
+    return invoker::call(table_.calls_[index_], &table_.targets_[index_],
+                         std::forward<Args>(args)...);
+}
+
+template<typename Fn, std::size_t N>
+template<typename F>
+typename dispatch_table<Fn, N>::reference &
+dispatch_table<Fn, N>::reference::operator=(F func)
+{
+    table_.assign(index_, std::move(func));
+    return *this;
+}
+
+template<typename Fn, std::size_t N>
+dispatch_table<Fn, N>::reference::operator bool() const noexcept
+{
+    return table_.contains(index_);
+}
+
+} // namespace vdk
+
+#endif // VDK_DISPATCH_TABLE_H
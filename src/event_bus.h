@@ -0,0 +1,483 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_EVENT_BUS_H
+#define VDK_EVENT_BUS_H
+
+#include <tuple>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "delegate.h"
+#include "weak_bind.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::event_bus
+{
+using std::size_t;
+
+// Position of type E in the list of event types
+template<typename E, typename ... Events>
+struct index_of;
+
+template<typename E, typename ... Rest>
+struct index_of<E, E, Rest...> : std::integral_constant<size_t, 0>
+{
+    static_assert(!(std::is_same_v<E, Rest> || ...),
+                  "event type is listed more than once");
+};
+
+template<typename E, typename First, typename ... Rest>
+struct index_of<E, First, Rest...>
+    : std::integral_constant<size_t, 1 + index_of<E, Rest...>::value>
+{};
+
+template<typename E>
+struct index_of<E>
+{
+    static_assert(sizeof(E) == 0, "type is not an event type of this event_bus");
+};
+
+// Subscriber of one event type
+template<typename E>
+struct subscriber
+{
+    // Set in id_ of subscriber removed while it may be running
+    static constexpr std::uint64_t removed = std::uint64_t{ 1 } << 63;
+
+    bool alive() const noexcept;
+
+    vdk::delegate<void(const E &)> handler_;
+    std::uint64_t id_;
+    vdk::weak_ref owner_;
+};
+
+template<typename E>
+bool subscriber<E>::alive() const noexcept
+{
+    return !(id_ & removed) && !(owner_ && owner_.expired());
+}
+
+// Subscribers and queued events of one event type
+template<typename E>
+struct channel
+{
+    void commit();
+    bool remove(std::uint64_t id) noexcept;
+
+    std::vector<subscriber<E>> subscribers_;
+
+    // Subscriptions made during publishing are added afterwards
+    std::vector<subscriber<E>> added_;
+
+    std::vector<E> queue_;
+    std::vector<E> batch_;
+
+    // Events of batch_ before this one have been delivered
+    size_t delivered_{};
+
+    unsigned depth_{};
+    bool removed_{};
+};
+
+template<typename E>
+void channel<E>::commit()
+{
+    if (removed_)
+    {
+        subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+            [](const subscriber<E> & s) { return (s.id_ & subscriber<E>::removed) != 0; }),
+            subscribers_.end());
+        removed_ = false;
+    }
+
+    subscribers_.reserve(subscribers_.size() + added_.size());
+    for (auto & s : added_)
+        subscribers_.push_back(std::move(s));
+    added_.clear();
+}
+
+template<typename E>
+bool channel<E>::remove(std::uint64_t id) noexcept
+{
+    // Identifiers are increasing, so both lists stay sorted
+    const auto less = [](const subscriber<E> & s, std::uint64_t value) noexcept
+    {
+        return (s.id_ & ~subscriber<E>::removed) < value;
+    };
+
+    auto it = std::lower_bound(subscribers_.begin(), subscribers_.end(), id, less);
+    if (it != subscribers_.end() && (it->id_ & ~subscriber<E>::removed) == id)
+    {
+        if (it->id_ & subscriber<E>::removed)
+            return false;
+
+        // Running subscriber is destroyed after publishing completes
+        if (depth_)
+        {
+            it->id_ |= subscriber<E>::removed;
+            removed_ = true;
+        }
+        else
+            subscribers_.erase(it);
+        return true;
+    }
+
+    auto added = std::lower_bound(added_.begin(), added_.end(), id, less);
+    if (added != added_.end() && added->id_ == id)
+    {
+        added_.erase(added);
+        return true;
+    }
+    return false;
+}
+
+} // namespace internal::event_bus
+
+// Publish | subscribe hub with subscriber lists indexed by event type
+template<typename ... Events>
+class event_bus final
+{
+    static_assert(sizeof...(Events) > 0, "event_bus requires at least one event type");
+    static_assert(((std::is_same_v<Events, std::decay_t<Events>>) && ...),
+                  "event types must not be references or cv-qualified");
+
+    template<typename E>
+    static constexpr std::size_t index_v =
+        internal::event_bus::index_of<E, Events...>::value;
+
+    template<typename E>
+    using channel = internal::event_bus::channel<E>;
+
+public:
+
+    class subscription;
+
+    template<typename E>
+    using handler_t = delegate<void(const E &)>;
+
+    event_bus() = default;
+
+    template<typename E>
+    subscription subscribe(handler_t<E> handler);
+
+    template<typename E, typename F, typename =
+        std::enable_if_t<internal::weak::is_bound_v<F>>>
+    subscription subscribe(F target);
+
+    bool unsubscribe(subscription token) noexcept;
+
+    template<typename E>
+    void publish(const E & event);
+
+    template<typename E>
+    void enqueue(E && event);
+
+    std::size_t dispatch();
+
+    template<typename E>
+    std::size_t subscribers() const noexcept;
+    std::size_t queued() const noexcept;
+
+    event_bus(const event_bus &) = delete;
+    event_bus & operator=(const event_bus &) = delete;
+
+private:
+
+    template<typename E>
+    channel<E> & get() noexcept;
+    template<typename E>
+    const channel<E> & get() const noexcept;
+
+    template<typename E>
+    subscription add(handler_t<E> handler, weak_ref owner);
+
+    template<typename E>
+    static bool remove(event_bus & self, std::uint64_t id) noexcept;
+    template<typename E>
+    static std::size_t drain(event_bus & self);
+
+    std::tuple<channel<Events>...> channels_;
+    std::vector<std::size_t> pending_;
+    std::size_t queued_{};
+    std::uint64_t next_id_{};
+    bool dispatching_{};
+};
+
+// Token that identifies one subscription
+template<typename ... Events>
+class event_bus<Events...>::subscription final
+{
+public:
+
+    subscription() noexcept = default;
+
+    explicit operator bool() const noexcept;
+
+    bool operator==(const subscription & other) const noexcept;
+    bool operator!=(const subscription & other) const noexcept;
+
+private:
+
+    friend class event_bus;
+
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    subscription(std::size_t type, std::uint64_t id) noexcept;
+
+    std::size_t type_{ npos };
+    std::uint64_t id_{};
+};
+
+template<typename ... Events>
+event_bus<Events...>::subscription::
+subscription(std::size_t type, std::uint64_t id) noexcept
+    : type_{ type },
+      id_{ id }
+{}
+
+template<typename ... Events>
+event_bus<Events...>::subscription::operator bool() const noexcept
+{
+    return type_ != npos;
+}
+
+template<typename ... Events>
+bool event_bus<Events...>::subscription::
+operator==(const subscription & other) const noexcept
+{
+    return type_ == other.type_ && id_ == other.id_;
+}
+
+template<typename ... Events>
+bool event_bus<Events...>::subscription::
+operator!=(const subscription & other) const noexcept
+{
+    return !(*this == other);
+}
+
+template<typename ... Events>
+template<typename E>
+typename event_bus<Events...>::subscription
+event_bus<Events...>::subscribe(handler_t<E> handler)
+{
+    return add<E>(std::move(handler), {});
+}
+
+// Subscriber bound weakly is removed after its object is destroyed
+template<typename ... Events>
+template<typename E, typename F, typename>
+typename event_bus<Events...>::subscription
+event_bus<Events...>::subscribe(F target)
+{
+    auto owner = target.owner();
+    return add<E>(std::move(target), owner);
+}
+
+template<typename ... Events>
+bool event_bus<Events...>::unsubscribe(subscription token) noexcept
+{
+    using remove_t = bool(*)(event_bus&, std::uint64_t) noexcept;
+    static constexpr remove_t removers[]{ &remove<Events>... };
+
+    if (!token)
+        return false;
+    assert(token.type_ < sizeof...(Events));
+    return removers[token.type_](*this, token.id_);
+}
+
+template<typename ... Events>
+template<typename E>
+void event_bus<Events...>::publish(const E & event)
+{
+    auto & ch = get<E>();
+    if (!ch.depth_ && (ch.removed_ || !ch.added_.empty()))
+        ch.commit();
+    {
+        // Subscribers may subscribe | unsubscribe while they are invoked
+        struct guard
+        {
+            ~guard() noexcept { --depth_; }
+            unsigned & depth_;
+        } publishing{ ++ch.depth_ };
+
+        for (std::size_t i = 0, n = ch.subscribers_.size(); i < n; ++i)
+        {
+            auto & s = ch.subscribers_[i];
+            if (s.id_ & internal::event_bus::subscriber<E>::removed)
+                continue;
+
+            // Subscribers of destroyed objects are removed lazily
+            if (s.owner_ && s.owner_.expired())
+            {
+                s.id_ |= internal::event_bus::subscriber<E>::removed;
+                ch.removed_ = true;
+                continue;
+            }
+            s.handler_(event);
+        }
+    }
+    if (!ch.depth_ && (ch.removed_ || !ch.added_.empty()))
+        ch.commit();
+}
+
+template<typename ... Events>
+template<typename E>
+void event_bus<Events...>::enqueue(E && event)
+{
+    using type = std::decay_t<E>;
+    constexpr auto index = index_v<type>;
+
+    auto & ch = get<type>();
+    if (ch.queue_.empty())
+    {
+        pending_.reserve(pending_.size() + 1);
+        ch.queue_.push_back(std::forward<E>(event));
+        pending_.push_back(index);
+    }
+    else
+        ch.queue_.push_back(std::forward<E>(event));
+    ++queued_;
+}
+
+template<typename ... Events>
+std::size_t event_bus<Events...>::dispatch()
+{
+    using drain_t = std::size_t(*)(event_bus&);
+    static constexpr drain_t drains[]{ &drain<Events>... };
+
+    // Events queued by subscribers are delivered by the next call
+    if (dispatching_)
+        return 0;
+
+    struct guard
+    {
+        ~guard() noexcept
+        {
+            auto & pending = self_.pending_;
+            pending.erase(pending.begin(), pending.begin() + done_);
+            self_.dispatching_ = false;
+        }
+        event_bus & self_;
+        std::ptrdiff_t done_;
+    } dispatching{ *this, 0 };
+
+    dispatching_ = true;
+
+    std::size_t count = 0;
+    for (std::size_t i = 0, n = pending_.size(); i < n; ++i)
+    {
+        // Type stays pending if one of its subscribers throws
+        count += drains[pending_[i]](*this);
+        ++dispatching.done_;
+    }
+    return count;
+}
+
+template<typename ... Events>
+template<typename E>
+std::size_t event_bus<Events...>::subscribers() const noexcept
+{
+    const auto & ch = get<E>();
+    const auto alive = [](const internal::event_bus::subscriber<E> & s)
+    {
+        return s.alive();
+    };
+    return static_cast<std::size_t>(
+        std::count_if(ch.subscribers_.begin(), ch.subscribers_.end(), alive) +
+        std::count_if(ch.added_.begin(), ch.added_.end(), alive));
+}
+
+template<typename ... Events>
+std::size_t event_bus<Events...>::queued() const noexcept
+{
+    return queued_;
+}
+
+template<typename ... Events>
+template<typename E>
+typename event_bus<Events...>::subscription
+event_bus<Events...>::add(handler_t<E> handler, weak_ref owner)
+{
+    constexpr auto type = index_v<E>;
+    if (!handler)
+        return {};
+
+    auto & ch = get<E>();
+    const auto id = next_id_;
+
+    // Changes left by a throwing subscriber keep identifiers sorted
+    if (!ch.depth_ && (ch.removed_ || !ch.added_.empty()))
+        ch.commit();
+
+    if (ch.depth_)
+        ch.added_.push_back({ std::move(handler), id, owner });
+    else
+        ch.subscribers_.push_back({ std::move(handler), id, owner });
+    ++next_id_;
+    return { type, id };
+}
+
+template<typename ... Events>
+template<typename E>
+internal::event_bus::channel<E> & event_bus<Events...>::get() noexcept
+{
+    return std::get<index_v<E>>(channels_);
+}
+
+template<typename ... Events>
+template<typename E>
+const internal::event_bus::channel<E> & event_bus<Events...>::get() const noexcept
+{
+    return std::get<index_v<E>>(channels_);
+}
+
+template<typename ... Events>
+template<typename E>
+bool event_bus<Events...>::remove(event_bus & self, std::uint64_t id) noexcept
+{
+    return self.template get<E>().remove(id);
+}
+
+template<typename ... Events>
+template<typename E>
+std::size_t event_bus<Events...>::drain(event_bus & self)
+{
+    auto & ch = self.template get<E>();
+
+    // All queued events of one type are delivered together; events left
+    // by a throwing subscriber are delivered before newer ones
+    if (ch.delivered_ == ch.batch_.size())
+    {
+        ch.batch_.clear();
+        ch.delivered_ = 0;
+        ch.batch_.swap(ch.queue_);
+    }
+
+    const auto first = ch.delivered_;
+    while (ch.delivered_ < ch.batch_.size())
+    {
+        --self.queued_;
+        self.publish(ch.batch_[ch.delivered_++]);
+    }
+
+    const auto count = ch.batch_.size() - first;
+    ch.batch_.clear();
+    ch.delivered_ = 0;
+    return count;
+}
+
+} // namespace vdk
+
+#endif // VDK_EVENT_BUS_H
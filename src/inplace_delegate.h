@@ -0,0 +1,267 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_INPLACE_DELEGATE_H
+#define VDK_INPLACE_DELEGATE_H
+
+#include <new>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::delegate
+{
+// Compile-time check that target fits into inplace buffer;
+// compiler diagnostics show actual size | alignment as template arguments
+template<size_t Size, size_t Capacity, size_t Align, size_t Alignment>
+struct target_fits
+{
+    static_assert(Size <= Capacity,
+        "inplace_delegate target is too large: Size (sizeof target) > Capacity");
+    static_assert(Align <= Alignment,
+        "inplace_delegate target is over-aligned: Align (alignof target) > Alignment");
+
+    static constexpr bool value = true;
+};
+
+} // namespace internal::delegate
+
+// Delegate with fixed-size internal buffer that never allocates memory
+template<typename Fn,
+         std::size_t Capacity = sizeof(internal::delegate::block),
+         std::size_t Alignment = alignof(internal::delegate::block)>
+class inplace_delegate final
+    : internal::delegate::traits<Fn,
+        internal::delegate::basic_storage<Capacity, Alignment>>
+{
+    using storage = internal::delegate::basic_storage<Capacity, Alignment>;
+    using base = internal::delegate::traits<Fn, storage>;
+    using vtbl = internal::delegate::basic_vtbl<storage>;
+
+    using base::call_;
+    using typename base::fn_t;
+
+    template<typename T> static constexpr
+        bool is_invocable_v = base::template is_invocable_v<T> &&
+                              !std::is_same_v<T, inplace_delegate>;
+
+    template<typename T>
+    static constexpr bool check() noexcept;
+
+public:
+
+    inplace_delegate() noexcept = default;
+    inplace_delegate(std::nullptr_t) noexcept {}
+    inplace_delegate(fn_t func) noexcept;
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    inplace_delegate(F func) noexcept;
+
+    inplace_delegate(inplace_delegate && other) noexcept;
+    inplace_delegate & operator=(inplace_delegate && other) noexcept;
+    inplace_delegate & operator=(std::nullptr_t) noexcept;
+    inplace_delegate & operator=(fn_t func) noexcept;
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    inplace_delegate & operator=(F func) noexcept;
+
+    ~inplace_delegate() noexcept;
+
+    using base::operator();
+    explicit operator bool() const noexcept;
+
+    bool operator==(const inplace_delegate & other) const noexcept;
+    bool operator!=(const inplace_delegate & other) const noexcept;
+
+    static constexpr std::size_t capacity() noexcept;
+
+    inplace_delegate(const inplace_delegate &) = delete;
+    inplace_delegate & operator=(const inplace_delegate &) = delete;
+
+private:
+
+    const vtbl * vptr_{};
+};
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+template<typename T>
+constexpr bool inplace_delegate<Fn, Capacity, Alignment>::check() noexcept
+{
+    static_assert(internal::delegate::target_fits<
+        sizeof(T), Capacity, alignof(T), Alignment>::value);
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+        "inplace_delegate target must be nothrow move constructible");
+    return true;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+inplace_delegate<Fn, Capacity, Alignment>::inplace_delegate(fn_t func) noexcept
+{
+    static_assert(check<fn_t>());
+
+    if (!func) return;
+    *(base::template get_as<fn_t>()) = func;
+    call_ = &base::template invoke<fn_t>;
+    vptr_ = internal::delegate::vtable<fn_t, storage>();
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+template<typename F, typename>
+inplace_delegate<Fn, Capacity, Alignment>::inplace_delegate(F func) noexcept
+{
+    static_assert(check<F>());
+
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return;
+
+    ::new (base::get()) F{ std::move(func) };
+    call_ = &base::template invoke<F>;
+    vptr_ = internal::delegate::vtable<F, storage>();
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+inplace_delegate<Fn, Capacity, Alignment>::
+inplace_delegate(inplace_delegate && other) noexcept
+{
+    call_ = other.call_;
+    vptr_ = other.vptr_;
+    if (vptr_) vptr_->move(other, *this);
+    other.call_ = nullptr;
+    other.vptr_ = nullptr;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+inplace_delegate<Fn, Capacity, Alignment> &
+inplace_delegate<Fn, Capacity, Alignment>::operator=(inplace_delegate && other) noexcept
+{
+    if (this != &other)
+    {
+        if (vptr_) vptr_->destroy(*this);
+        call_ = other.call_;
+        vptr_ = other.vptr_;
+        if (vptr_) vptr_->move(other, *this);
+        other.call_ = nullptr;
+        other.vptr_ = nullptr;
+    }
+    return *this;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+inplace_delegate<Fn, Capacity, Alignment> &
+inplace_delegate<Fn, Capacity, Alignment>::operator=(std::nullptr_t) noexcept
+{
+    if (vptr_) vptr_->destroy(*this);
+    call_ = nullptr;
+    vptr_ = nullptr;
+    return *this;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+inplace_delegate<Fn, Capacity, Alignment> &
+inplace_delegate<Fn, Capacity, Alignment>::operator=(fn_t func) noexcept
+{
+    static_assert(check<fn_t>());
+
+    if (!func) return *this;
+    if (vptr_) vptr_->destroy(*this);
+    *(base::template get_as<fn_t>()) = func;
+    call_ = &base::template invoke<fn_t>;
+    vptr_ = internal::delegate::vtable<fn_t, storage>();
+    return *this;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+template<typename F, typename>
+inplace_delegate<Fn, Capacity, Alignment> &
+inplace_delegate<Fn, Capacity, Alignment>::operator=(F func) noexcept
+{
+    static_assert(check<F>());
+
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return *this;
+
+    if (vptr_) vptr_->destroy(*this);
+    ::new (base::get()) F{ std::move(func) };
+    call_ = &base::template invoke<F>;
+    vptr_ = internal::delegate::vtable<F, storage>();
+    return *this;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+inplace_delegate<Fn, Capacity, Alignment>::~inplace_delegate() noexcept
+{
+    if (vptr_) vptr_->destroy(*this);
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+inplace_delegate<Fn, Capacity, Alignment>::operator bool() const noexcept
+{
+    return vptr_ != nullptr;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+bool inplace_delegate<Fn, Capacity, Alignment>::
+operator==(const inplace_delegate & other) const noexcept
+{
+    if (!vptr_ && !other.vptr_)
+        return true;
+    if (vptr_ != other.vptr_)
+        return false;
+    return vptr_->compare(*this, other);
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+bool inplace_delegate<Fn, Capacity, Alignment>::
+operator!=(const inplace_delegate & other) const noexcept
+{
+    return !(*this == other);
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+constexpr std::size_t inplace_delegate<Fn, Capacity, Alignment>::capacity() noexcept
+{
+    return Capacity;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+bool operator==(const inplace_delegate<Fn, Capacity, Alignment> & lhs,
+                std::nullptr_t) noexcept
+{
+    return !lhs;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+bool operator==(std::nullptr_t,
+                const inplace_delegate<Fn, Capacity, Alignment> & rhs) noexcept
+{
+    return !rhs;
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+bool operator!=(const inplace_delegate<Fn, Capacity, Alignment> & lhs,
+                std::nullptr_t) noexcept
+{
+    return static_cast<bool>(lhs);
+}
+
+template<typename Fn, std::size_t Capacity, std::size_t Alignment>
+bool operator!=(std::nullptr_t,
+                const inplace_delegate<Fn, Capacity, Alignment> & rhs) noexcept
+{
+    return static_cast<bool>(rhs);
+}
+
+} // namespace vdk
+
+#endif // VDK_INPLACE_DELEGATE_H
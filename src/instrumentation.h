@@ -0,0 +1,501 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_INSTRUMENTATION_H
+#define VDK_INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <string_view>
+
+#if defined(VDK_DELEGATE_INSTRUMENTATION_TSC)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VDK_DELEGATE_CALL_SITE() _ReturnAddress()
+#else
+#define VDK_DELEGATE_CALL_SITE() __builtin_return_address(0)
+#endif
+
+namespace vdk
+{
+namespace instrumentation
+{
+// Number of latency histogram buckets; bucket i counts calls that took
+// [2^(i-1), 2^i) clock units, the last bucket counts all longer calls
+inline constexpr std::size_t buckets = 32;
+
+// Snapshot of counters of one target type
+struct record
+{
+    std::string_view name_;
+    std::uint64_t calls_;
+    std::uint64_t total_;
+    std::uint64_t histogram_[buckets];
+
+    std::uint64_t percentile(double p) const noexcept;
+};
+
+std::vector<record> snapshot();
+void report(std::FILE * out = stdout);
+void reset() noexcept;
+const char * unit() noexcept;
+
+void start_trace(std::size_t capacity = 1 << 20);
+void stop_trace() noexcept;
+bool write_trace(std::FILE * out);
+bool write_perf_map(const char * path = nullptr);
+
+} // namespace instrumentation
+
+// Internal implementation details
+namespace internal::instrumentation
+{
+using vdk::instrumentation::buckets;
+
+// Counters of one call thunk, linked into the global registry
+struct counters
+{
+    counters(std::string_view name, const void * thunk) noexcept;
+
+    void add(std::uint64_t elapsed, const void * site) noexcept;
+
+    std::string_view name_;
+    const void * thunk_;
+    std::atomic<const void*> site_{};
+    std::atomic<std::uint64_t> calls_{};
+    std::atomic<std::uint64_t> total_{};
+    std::atomic<std::uint64_t> histogram_[buckets]{};
+    counters * next_{};
+};
+
+// Head of the list of all counters
+inline std::atomic<counters*> & registry() noexcept
+{
+    static std::atomic<counters*> head{ nullptr };
+    return head;
+}
+
+// Timed invocation recorded while tracing is active
+struct event
+{
+    const counters * target_;
+    const void * site_;
+    std::uint64_t start_;
+    std::uint64_t duration_;
+    std::uint32_t thread_;
+};
+
+// Buffer of trace events
+struct trace
+{
+    std::unique_ptr<event[]> events_;
+    std::size_t capacity_{};
+    std::atomic<std::size_t> size_{};
+    std::atomic<bool> active_{};
+
+    // Probes that may be writing into events_
+    std::atomic<std::size_t> writers_{};
+    std::uint64_t clock_start_{};
+    std::chrono::steady_clock::time_point steady_start_{};
+    std::uint64_t clock_stop_{};
+    std::chrono::steady_clock::time_point steady_stop_{};
+};
+
+inline trace & tracer() noexcept
+{
+    static trace instance;
+    return instance;
+}
+
+// Small sequential number of the calling thread
+inline std::uint32_t thread_number() noexcept
+{
+    static std::atomic<std::uint32_t> next{ 1 };
+    thread_local const std::uint32_t number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+// Current time in clock units
+inline std::uint64_t now() noexcept
+{
+#if defined(VDK_DELEGATE_INSTRUMENTATION_TSC)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline counters::counters(std::string_view name, const void * thunk) noexcept
+    : name_{ name },
+      thunk_{ thunk }
+{
+    auto & head = registry();
+    next_ = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(next_, this,
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+inline void counters::add(std::uint64_t elapsed, const void * site) noexcept
+{
+    std::size_t bucket = 0;
+    while (bucket + 1 < buckets && (elapsed >> bucket) != 0)
+        ++bucket;
+
+    calls_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(elapsed, std::memory_order_relaxed);
+    histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    // Avoid writing shared cache line when call site does not change
+    if (site_.load(std::memory_order_relaxed) != site)
+        site_.store(site, std::memory_order_relaxed);
+}
+
+// Readable name of type T extracted from the function signature
+template<typename T>
+constexpr std::string_view type_name() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::string_view name{ __FUNCSIG__ };
+    const std::string_view prefix{ "type_name<" };
+    const std::string_view suffix{ ">(void) noexcept" };
+#else
+    std::string_view name{ __PRETTY_FUNCTION__ };
+    const std::string_view prefix{ "T = " };
+    const std::string_view suffix{ "]" };
+#endif
+    const auto first = name.find(prefix);
+    if (first == std::string_view::npos)
+        return name;
+    name.remove_prefix(first + prefix.size());
+#if defined(__GNUC__) && !defined(__clang__)
+    // GCC appends "; std::string_view = ..." after the template argument
+    const auto last = name.find(';');
+    if (last != std::string_view::npos)
+        return name.substr(0, last);
+#endif
+    if (name.size() >= suffix.size() &&
+        name.substr(name.size() - suffix.size()) == suffix)
+        name.remove_suffix(suffix.size());
+    return name;
+}
+
+// Counters of call thunk of target type T in delegate traits Owner
+template<typename T, typename Owner>
+inline counters & counters_of() noexcept
+{
+    static counters instance{ type_name<T>(),
+        reinterpret_cast<const void*>(&Owner::template invoke<T>) };
+    return instance;
+}
+
+// Records one invocation of target type T in its destructor
+template<typename T, typename Owner>
+class probe
+{
+public:
+
+    explicit probe(const void * site) noexcept
+        : site_{ site },
+          start_{ now() }
+    {}
+    ~probe() noexcept
+    {
+        const auto duration = now() - start_;
+        auto & target = counters_of<T, Owner>();
+        target.add(duration, site_);
+
+        auto & log = tracer();
+        if (log.active_.load(std::memory_order_relaxed))
+        {
+            // Announce the write before checking again, so stop_trace either
+            // waits for it or the probe sees tracing stopped
+            log.writers_.fetch_add(1, std::memory_order_seq_cst);
+            if (log.active_.load(std::memory_order_seq_cst))
+            {
+                const auto index = log.size_.fetch_add(1, std::memory_order_relaxed);
+                if (index < log.capacity_)
+                    log.events_[index] = event{ &target, site_, start_, duration, thread_number() };
+            }
+            log.writers_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    probe(const probe &) = delete;
+    probe & operator=(const probe &) = delete;
+
+private:
+
+    const void * site_;
+    std::uint64_t start_;
+};
+
+// Escape string for JSON output
+inline std::string escape(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20)
+            result += c;
+    }
+    return result;
+}
+
+} // namespace internal::instrumentation
+
+namespace instrumentation
+{
+// Approximate value below which fraction p of calls fall
+inline std::uint64_t record::percentile(double p) const noexcept
+{
+    if (calls_ == 0)
+        return 0;
+
+    const auto target = std::min(
+        static_cast<std::uint64_t>(p * static_cast<double>(calls_)), calls_ - 1);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets; ++i)
+    {
+        seen += histogram_[i];
+        if (seen > target)
+            return std::uint64_t{ 1 } << i;
+    }
+    return std::uint64_t{ 1 } << (buckets - 1);
+}
+
+// Counters of all target types invoked so far, sorted by total time
+inline std::vector<record> snapshot()
+{
+    std::vector<record> records;
+    auto node = internal::instrumentation::registry().load(std::memory_order_acquire);
+    for (; node; node = node->next_)
+    {
+        record r{ node->name_,
+                  node->calls_.load(std::memory_order_relaxed),
+                  node->total_.load(std::memory_order_relaxed), {} };
+        for (std::size_t i = 0; i < buckets; ++i)
+            r.histogram_[i] = node->histogram_[i].load(std::memory_order_relaxed);
+        records.push_back(r);
+    }
+
+    // Merge thunks of the same target type used with different signatures
+    std::sort(records.begin(), records.end(), [](const record & lhs, const record & rhs)
+    {
+        return lhs.name_ < rhs.name_;
+    });
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        if (size != 0 && records[size - 1].name_ == records[i].name_)
+        {
+            auto & r = records[size - 1];
+            r.calls_ += records[i].calls_;
+            r.total_ += records[i].total_;
+            for (std::size_t j = 0; j < buckets; ++j)
+                r.histogram_[j] += records[i].histogram_[j];
+        }
+        else
+            records[size++] = records[i];
+    }
+    records.resize(size);
+
+    std::stable_sort(records.begin(), records.end(), [](const record & lhs, const record & rhs)
+    {
+        return lhs.total_ > rhs.total_;
+    });
+    return records;
+}
+
+// Print table of all target types sorted by total time
+inline void report(std::FILE * out)
+{
+    std::fprintf(out, "%14s %16s %10s %10s %10s  %s\n",
+                 "calls", "total", "mean", "p50 <", "p99 <", "target");
+    for (const auto & r : snapshot())
+    {
+        if (r.calls_ == 0)
+            continue;
+        std::fprintf(out, "%14llu %16llu %10llu %10llu %10llu  %.*s\n",
+                     static_cast<unsigned long long>(r.calls_),
+                     static_cast<unsigned long long>(r.total_),
+                     static_cast<unsigned long long>(r.total_ / r.calls_),
+                     static_cast<unsigned long long>(r.percentile(0.5)),
+                     static_cast<unsigned long long>(r.percentile(0.99)),
+                     static_cast<int>(r.name_.size()), r.name_.data());
+    }
+    std::fprintf(out, "(time in %s)\n", unit());
+}
+
+// Reset all counters to zero
+inline void reset() noexcept
+{
+    auto node = internal::instrumentation::registry().load(std::memory_order_acquire);
+    for (; node; node = node->next_)
+    {
+        node->calls_.store(0, std::memory_order_relaxed);
+        node->total_.store(0, std::memory_order_relaxed);
+        for (auto & bucket : node->histogram_)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Unit of recorded times
+inline const char * unit() noexcept
+{
+#if defined(VDK_DELEGATE_INSTRUMENTATION_TSC)
+    return "TSC ticks";
+#else
+    return "ns";
+#endif
+}
+
+// Start recording up to capacity timed invocations
+inline void start_trace(std::size_t capacity)
+{
+    auto & log = internal::instrumentation::tracer();
+    assert(!log.active_.load(std::memory_order_relaxed));
+    assert(log.writers_.load(std::memory_order_relaxed) == 0);
+
+    log.events_.reset(new internal::instrumentation::event[capacity]);
+    log.capacity_ = capacity;
+    log.size_.store(0, std::memory_order_relaxed);
+    log.clock_start_ = internal::instrumentation::now();
+    log.steady_start_ = std::chrono::steady_clock::now();
+    log.active_.store(true, std::memory_order_seq_cst);
+}
+
+// Stop recording invocations; recorded events are kept until next start
+inline void stop_trace() noexcept
+{
+    auto & log = internal::instrumentation::tracer();
+    log.active_.store(false, std::memory_order_seq_cst);
+
+    // Wait for probes that are still writing their events
+    while (log.writers_.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+    log.clock_stop_ = internal::instrumentation::now();
+    log.steady_stop_ = std::chrono::steady_clock::now();
+}
+
+// Write recorded invocations in Chrome trace event format
+inline bool write_trace(std::FILE * out)
+{
+    using namespace internal::instrumentation;
+
+    auto & log = tracer();
+    assert(!log.active_.load(std::memory_order_relaxed));
+    const auto count = std::min(log.size_.load(std::memory_order_relaxed), log.capacity_);
+
+    // Convert clock units into microseconds using the interval of the trace
+    double scale = 1e-3;
+#if defined(VDK_DELEGATE_INSTRUMENTATION_TSC)
+    const auto ticks = static_cast<double>(log.clock_stop_ - log.clock_start_);
+    const auto micros = std::chrono::duration<double, std::micro>(
+        log.steady_stop_ - log.steady_start_).count();
+    if (ticks > 0) scale = micros / ticks;
+#endif
+
+#if defined(_WIN32)
+    const int pid = ::_getpid();
+#else
+    const int pid = ::getpid();
+#endif
+
+    std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto & e = log.events_[i];
+        std::fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"delegate\",\"ph\":\"X\","
+                     "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,"
+                     "\"args\":{\"thunk\":\"%p\",\"call_site\":\"%p\"}}",
+                     i ? "," : "", escape(e.target_->name_).c_str(),
+                     static_cast<double>(e.start_ - log.clock_start_) * scale,
+                     static_cast<double>(e.duration_) * scale,
+                     pid, static_cast<unsigned>(e.thread_),
+                     e.target_->thunk_, e.site_);
+    }
+    std::fprintf(out, "\n]}\n");
+    return std::ferror(out) == 0;
+}
+
+// Write symbol map of call thunks in the format of /tmp/perf-<pid>.map
+inline bool write_perf_map(const char * path)
+{
+    using namespace internal::instrumentation;
+
+    std::vector<const counters*> thunks;
+    auto node = registry().load(std::memory_order_acquire);
+    for (; node; node = node->next_)
+        thunks.push_back(node);
+    std::sort(thunks.begin(), thunks.end(), [](const counters * lhs, const counters * rhs)
+    {
+        return lhs->thunk_ < rhs->thunk_;
+    });
+
+    std::string name;
+    if (!path)
+    {
+#if defined(_WIN32)
+        name = "perf-" + std::to_string(::_getpid()) + ".map";
+#else
+        name = "/tmp/perf-" + std::to_string(::getpid()) + ".map";
+#endif
+        path = name.c_str();
+    }
+
+    std::FILE * out = std::fopen(path, "w");
+    if (!out)
+        return false;
+
+    // Sizes of thunks are unknown; each one extends up to the next thunk
+    constexpr std::uintptr_t max_size = 256;
+    for (std::size_t i = 0; i < thunks.size(); ++i)
+    {
+        const auto start = reinterpret_cast<std::uintptr_t>(thunks[i]->thunk_);
+        auto size = max_size;
+        if (i + 1 < thunks.size())
+            size = std::min(size, reinterpret_cast<std::uintptr_t>(thunks[i + 1]->thunk_) - start);
+        if (size == 0)
+            continue;
+        std::fprintf(out, "%llx %llx vdk::delegate invoke<%.*s>\n",
+                     static_cast<unsigned long long>(start),
+                     static_cast<unsigned long long>(size),
+                     static_cast<int>(thunks[i]->name_.size()), thunks[i]->name_.data());
+    }
+    const bool ok = std::ferror(out) == 0;
+    return std::fclose(out) == 0 && ok;
+}
+
+} // namespace instrumentation
+} // namespace vdk
+
+#endif // VDK_INSTRUMENTATION_H
@@ -0,0 +1,428 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_MEMOIZED_H
+#define VDK_MEMOIZED_H
+
+#include <array>
+#include <mutex>
+#include <tuple>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Counters of one memoized callable
+struct memoize_stats
+{
+    double hit_rate() const noexcept;
+
+    std::uint64_t hits_;
+    std::uint64_t misses_;
+    std::uint64_t evictions_;
+
+    // Time spent in the wrapped callable on misses, in nanoseconds
+    std::uint64_t miss_time_;
+};
+
+inline double memoize_stats::hit_rate() const noexcept
+{
+    const auto calls = hits_ + misses_;
+    return calls ? static_cast<double>(hits_) / static_cast<double>(calls) : 0.0;
+}
+
+// Internal implementation details
+namespace internal::memoized
+{
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+inline constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+
+// Final mixing step of splitmix64; std::hash of integers is often identity
+inline uint64_t mix(uint64_t x) noexcept
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+template<typename ... A>
+uint64_t hash(const A & ... args)
+{
+    uint64_t h = 0;
+    ((h = mix(h + std::hash<A>{}(args))), ...);
+    return h;
+}
+
+inline size_t ceil2(size_t n) noexcept
+{
+    size_t value = 1;
+    while (value < n)
+        value *= 2;
+    return value;
+}
+
+// Bounded table of results; open addressing with linear probing over
+// an index of entries, CLOCK eviction over the entries themselves
+template<typename Key, typename Value>
+class cache
+{
+public:
+
+    explicit cache(size_t capacity);
+
+    template<typename ... A>
+    const Value * find(uint64_t h, const A & ... args) noexcept;
+    void insert(uint64_t h, Key && key, Value && value);
+    void clear() noexcept;
+
+    size_t size() const noexcept;
+
+    memoize_stats stats_{};
+
+private:
+
+    struct entry
+    {
+        std::optional<std::pair<Key, Value>> item_;
+        uint32_t hash_;
+        bool referenced_;
+    };
+
+    // Slot of index; home position is given by the low bits of hash
+    struct bucket
+    {
+        uint32_t hash_;
+        uint32_t entry_;
+    };
+
+    size_t victim() noexcept;
+    void unlink(uint32_t index) noexcept;
+
+    std::vector<entry> entries_;
+    std::vector<bucket> index_;
+    const size_t capacity_;
+    size_t hand_{};
+    size_t size_{};
+};
+
+template<typename Key, typename Value>
+cache<Key, Value>::cache(size_t capacity)
+    : index_(ceil2(capacity * 2), bucket{ 0, empty }),
+      capacity_{ capacity }
+{
+    assert(capacity > 0 && capacity < empty / 2);
+    entries_.reserve(capacity);
+}
+
+template<typename Key, typename Value>
+template<typename ... A>
+const Value * cache<Key, Value>::find(uint64_t h, const A & ... args) noexcept
+{
+    const auto mask = index_.size() - 1;
+    const auto tag = static_cast<uint32_t>(h);
+
+    for (auto pos = tag & mask; index_[pos].entry_ != empty; pos = (pos + 1) & mask)
+    {
+        if (index_[pos].hash_ != tag)
+            continue;
+        auto & e = entries_[index_[pos].entry_];
+        if (e.item_->first == std::tie(args...))
+        {
+            e.referenced_ = true;
+            return &e.item_->second;
+        }
+    }
+    return nullptr;
+}
+
+// Key must not be in the table
+template<typename Key, typename Value>
+void cache<Key, Value>::insert(uint64_t h, Key && key, Value && value)
+{
+    uint32_t index;
+    if (entries_.size() < capacity_)
+    {
+        entries_.push_back({ std::nullopt, 0, false });
+        index = static_cast<uint32_t>(entries_.size() - 1);
+    }
+    else
+    {
+        index = static_cast<uint32_t>(victim());
+        if (entries_[index].item_)
+        {
+            unlink(index);
+            entries_[index].item_.reset();
+            --size_;
+            ++stats_.evictions_;
+        }
+    }
+
+    // Entry stays free if construction throws
+    auto & e = entries_[index];
+    e.item_.emplace(std::move(key), std::move(value));
+    e.hash_ = static_cast<uint32_t>(h);
+    e.referenced_ = false;
+    ++size_;
+
+    const auto mask = index_.size() - 1;
+    auto pos = e.hash_ & mask;
+    while (index_[pos].entry_ != empty)
+        pos = (pos + 1) & mask;
+    index_[pos] = { e.hash_, index };
+}
+
+template<typename Key, typename Value>
+void cache<Key, Value>::clear() noexcept
+{
+    entries_.clear();
+    for (auto & b : index_)
+        b.entry_ = empty;
+    hand_ = 0;
+    size_ = 0;
+}
+
+template<typename Key, typename Value>
+size_t cache<Key, Value>::size() const noexcept
+{
+    return size_;
+}
+
+// Entry that was not used since the hand passed it last time
+template<typename Key, typename Value>
+size_t cache<Key, Value>::victim() noexcept
+{
+    for (;;)
+    {
+        auto & e = entries_[hand_];
+        const auto index = hand_;
+        hand_ = (hand_ + 1) % capacity_;
+
+        if (!e.item_ || !e.referenced_)
+            return index;
+        e.referenced_ = false;
+    }
+}
+
+// Remove entry from index; following buckets are shifted back to keep probe chains intact
+template<typename Key, typename Value>
+void cache<Key, Value>::unlink(uint32_t index) noexcept
+{
+    const auto mask = index_.size() - 1;
+    auto hole = entries_[index].hash_ & mask;
+    while (index_[hole].entry_ != index)
+        hole = (hole + 1) & mask;
+
+    for (auto pos = (hole + 1) & mask; index_[pos].entry_ != empty; pos = (pos + 1) & mask)
+    {
+        const auto home = index_[pos].hash_ & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask))
+        {
+            index_[hole] = index_[pos];
+            hole = pos;
+        }
+    }
+    index_[hole].entry_ = empty;
+}
+
+// Cache guarded by its own mutex
+template<typename Cache>
+struct alignas(64) shard
+{
+    explicit shard(size_t capacity) : cache_{ capacity } {}
+
+    std::mutex mutex_;
+    Cache cache_;
+};
+
+} // namespace internal::memoized
+
+template<typename Fn, std::size_t Shards = 0> class memoized;
+
+// Wraps delegate with a bounded cache of results keyed by arguments.
+// With Shards == 0 the cache is not synchronized; otherwise it is split
+// into Shards parts, each guarded by its own mutex.
+template<typename R, typename ... A, std::size_t Shards>
+class memoized<R(A...), Shards> final
+{
+    static_assert(!std::is_void_v<R> && !std::is_reference_v<R>,
+                  "memoized callable must return a value");
+
+public:
+
+    memoized(delegate<R(A...)> func, std::size_t capacity);
+
+    R operator()(A ... args);
+
+    void clear() noexcept;
+    std::size_t size() const noexcept;
+    std::size_t capacity() const noexcept;
+
+    memoize_stats stats() const noexcept;
+    void reset_stats() noexcept;
+
+    memoized(const memoized &) = delete;
+    memoized & operator=(const memoized &) = delete;
+
+private:
+
+    using key_t = std::tuple<std::decay_t<A>...>;
+    using cache_t = internal::memoized::cache<key_t, R>;
+    using shard_t = internal::memoized::shard<cache_t>;
+
+    static constexpr std::size_t shard_count = Shards ? Shards : 1;
+
+    template<std::size_t ... I>
+    memoized(delegate<R(A...)> func, std::size_t capacity, std::index_sequence<I...>);
+
+    shard_t & shard_of(std::uint64_t h) const noexcept;
+
+    delegate<R(A...)> func_;
+    mutable std::array<shard_t, shard_count> shards_;
+    const std::size_t capacity_;
+};
+
+template<typename R, typename ... A, std::size_t Shards>
+memoized<R(A...), Shards>::memoized(delegate<R(A...)> func, std::size_t capacity)
+    : memoized{ std::move(func), (std::max)(capacity, shard_count) / shard_count,
+                std::make_index_sequence<shard_count>{} }
+{}
+
+template<typename R, typename ... A, std::size_t Shards>
+template<std::size_t ... I>
+memoized<R(A...), Shards>::memoized(delegate<R(A...)> func, std::size_t capacity,
+                                    std::index_sequence<I...>)
+    : func_{ std::move(func) },
+      shards_{ { shard_t{ (static_cast<void>(I), capacity) }... } },
+      capacity_{ capacity }
+{
+    assert(func_);
+}
+
+// Result is returned from cache if the same arguments were seen before;
+// otherwise the callable is invoked with no lock held, so it may recurse
+template<typename R, typename ... A, std::size_t Shards>
+R memoized<R(A...), Shards>::operator()(A ... args)
+{
+    const auto h = internal::memoized::hash(static_cast<const std::decay_t<A>&>(args)...);
+    auto & s = shard_of(h);
+    {
+        std::unique_lock<std::mutex> lock{ s.mutex_, std::defer_lock };
+        if constexpr(Shards != 0)
+            lock.lock();
+        if (auto value = s.cache_.find(h, args...))
+        {
+            ++s.cache_.stats_.hits_;
+            return *value;
+        }
+    }
+
+    key_t key{ args... };
+    const auto start = std::chrono::steady_clock::now();
+    R result = func_(std::forward<A>(args)...);
+    const auto time = std::chrono::steady_clock::now() - start;
+
+    std::unique_lock<std::mutex> lock{ s.mutex_, std::defer_lock };
+    if constexpr(Shards != 0)
+        lock.lock();
+    auto & stats = s.cache_.stats_;
+    ++stats.misses_;
+    stats.miss_time_ += static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+
+    // Another thread | recursive call may have computed the same result
+    if (!std::apply([&](const auto & ... k) { return s.cache_.find(h, k...); }, key))
+        s.cache_.insert(h, std::move(key), R{ result });
+    return result;
+}
+
+template<typename R, typename ... A, std::size_t Shards>
+void memoized<R(A...), Shards>::clear() noexcept
+{
+    for (std::size_t i = 0; i < shard_count; ++i)
+    {
+        std::unique_lock<std::mutex> lock{ shards_[i].mutex_, std::defer_lock };
+        if constexpr(Shards != 0)
+            lock.lock();
+        shards_[i].cache_.clear();
+    }
+}
+
+template<typename R, typename ... A, std::size_t Shards>
+std::size_t memoized<R(A...), Shards>::size() const noexcept
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < shard_count; ++i)
+    {
+        std::unique_lock<std::mutex> lock{ shards_[i].mutex_, std::defer_lock };
+        if constexpr(Shards != 0)
+            lock.lock();
+        count += shards_[i].cache_.size();
+    }
+    return count;
+}
+
+template<typename R, typename ... A, std::size_t Shards>
+std::size_t memoized<R(A...), Shards>::capacity() const noexcept
+{
+    return capacity_ * shard_count;
+}
+
+// Sum of counters of all shards
+template<typename R, typename ... A, std::size_t Shards>
+memoize_stats memoized<R(A...), Shards>::stats() const noexcept
+{
+    memoize_stats total{};
+    for (std::size_t i = 0; i < shard_count; ++i)
+    {
+        std::unique_lock<std::mutex> lock{ shards_[i].mutex_, std::defer_lock };
+        if constexpr(Shards != 0)
+            lock.lock();
+        const auto & s = shards_[i].cache_.stats_;
+        total.hits_ += s.hits_;
+        total.misses_ += s.misses_;
+        total.evictions_ += s.evictions_;
+        total.miss_time_ += s.miss_time_;
+    }
+    return total;
+}
+
+template<typename R, typename ... A, std::size_t Shards>
+void memoized<R(A...), Shards>::reset_stats() noexcept
+{
+    for (std::size_t i = 0; i < shard_count; ++i)
+    {
+        std::unique_lock<std::mutex> lock{ shards_[i].mutex_, std::defer_lock };
+        if constexpr(Shards != 0)
+            lock.lock();
+        shards_[i].cache_.stats_ = {};
+    }
+}
+
+template<typename R, typename ... A, std::size_t Shards>
+typename memoized<R(A...), Shards>::shard_t &
+memoized<R(A...), Shards>::shard_of(std::uint64_t h) const noexcept
+{
+    // Low bits select the home bucket within a shard
+    return shards_[static_cast<std::size_t>(h >> 32) % shard_count];
+}
+
+} // namespace vdk
+
+#endif // VDK_MEMOIZED_H
@@ -0,0 +1,136 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_MPSC_QUEUE_H
+#define VDK_MPSC_QUEUE_H
+
+#include <new>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::mpsc
+{
+using vdk::internal::delegate::memory;
+using vdk::internal::delegate::memory_owner;
+
+// Size of cache line to keep producers and consumer apart
+inline constexpr std::size_t cache_line = 64;
+
+// Intrusive node of the queue
+struct node
+{
+    std::atomic<node*> next_{ nullptr };
+};
+
+// Intrusive lock-free queue: many producers, single consumer
+class queue
+{
+public:
+
+    queue() noexcept;
+
+    void push(node * item) noexcept;
+    node * pop() noexcept;
+
+    queue(const queue &) = delete;
+    queue & operator=(const queue &) = delete;
+
+private:
+
+    alignas(cache_line) std::atomic<node*> head_;
+    alignas(cache_line) node * tail_;
+    node stub_;
+};
+
+inline queue::queue() noexcept
+    : head_{ &stub_ },
+      tail_{ &stub_ }
+{}
+
+inline void queue::push(node * item) noexcept
+{
+    item->next_.store(nullptr, std::memory_order_relaxed);
+    auto prev = head_.exchange(item, std::memory_order_acq_rel);
+    prev->next_.store(item, std::memory_order_release);
+}
+
+// Returns nullptr if the queue is empty or a producer is in the middle of push
+inline node * queue::pop() noexcept
+{
+    auto tail = tail_;
+    auto next = tail->next_.load(std::memory_order_acquire);
+
+    if (tail == &stub_)
+    {
+        if (!next)
+            return nullptr;
+        tail_ = next;
+        tail = next;
+        next = next->next_.load(std::memory_order_acquire);
+    }
+
+    if (next)
+    {
+        tail_ = next;
+        return tail;
+    }
+
+    if (tail != head_.load(std::memory_order_acquire))
+        return nullptr;
+
+    push(&stub_);
+
+    next = tail->next_.load(std::memory_order_acquire);
+    if (next)
+    {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+// Queue node that carries a delegate
+template<typename Fn>
+struct delegate_node : node
+{
+    static delegate_node * create(vdk::delegate<Fn> func);
+    static void destroy(node * self) noexcept;
+
+    vdk::delegate<Fn> func_;
+};
+
+template<typename Fn>
+delegate_node<Fn> * delegate_node<Fn>::create(vdk::delegate<Fn> func)
+{
+    memory_owner mem{ sizeof(delegate_node), alignof(delegate_node) };
+
+    if (!mem.get())
+        throw std::bad_alloc{};
+
+    auto self = ::new (mem.get()) delegate_node{};
+    self->func_ = std::move(func);
+    mem.release();
+    return self;
+}
+
+template<typename Fn>
+void delegate_node<Fn>::destroy(node * self) noexcept
+{
+    auto p = static_cast<delegate_node*>(self);
+    p->~delegate_node();
+    memory()->deallocate(p, sizeof(delegate_node), alignof(delegate_node));
+}
+
+} // namespace internal::mpsc
+} // namespace vdk
+
+#endif // VDK_MPSC_QUEUE_H
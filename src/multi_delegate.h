@@ -0,0 +1,287 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_MULTI_DELEGATE_H
+#define VDK_MULTI_DELEGATE_H
+
+#include <tuple>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+template<typename ... Fn>
+class multi_delegate;
+
+// Internal implementation details
+namespace internal::delegate
+{
+// Artificial virtual table with one call thunk per signature
+template<typename S, typename ... Fn>
+struct multi_vtbl : basic_vtbl<S>
+{
+    std::tuple<decltype(traits<Fn, S>::call_)...> calls_;
+};
+
+// Obtain virtual table for type T kept in storage S
+template<typename T, typename S, typename ... Fn> inline
+const multi_vtbl<S, Fn...> * multi_vtable() noexcept
+{
+    static constexpr multi_vtbl<S, Fn...> tbl{
+        { &move<T, S>, &compare<T, S>, &destroy<T, S>, &hash<T, S> },
+        { &traits<Fn, S>::template invoke<T>... } };
+    return &tbl;
+}
+
+// Call operator of multi_delegate D for signature number I
+template<typename Fn, size_t I, typename D>
+struct multi_call;
+
+#define VDK_NONE
+#define VDK_MULTI_CALL(CVQUAL, LRQUAL, NOEXCEPT)\
+template<typename R, typename ... A, size_t I, typename D>\
+struct multi_call<R(A...) CVQUAL LRQUAL NOEXCEPT, I, D>\
+{\
+    inline R operator()(A ... args) CVQUAL LRQUAL NOEXCEPT\
+    {\
+        auto self = static_cast<CVQUAL D*>(this);\
+        assert(self->vptr_ != nullptr);\
+        return std::get<I>(self->vptr_->calls_)(\
+            static_cast<CVQUAL storage*>(self), std::forward<A>(args)...);\
+    }\
+};
+
+VDK_MULTI_CALL(VDK_NONE, VDK_NONE, VDK_NONE)
+VDK_MULTI_CALL(const, VDK_NONE, VDK_NONE)
+VDK_MULTI_CALL(volatile, VDK_NONE, VDK_NONE)
+VDK_MULTI_CALL(const volatile, VDK_NONE, VDK_NONE)
+VDK_MULTI_CALL(VDK_NONE, &, VDK_NONE)
+VDK_MULTI_CALL(const, &, VDK_NONE)
+VDK_MULTI_CALL(volatile, &, VDK_NONE)
+VDK_MULTI_CALL(const volatile, &, VDK_NONE)
+VDK_MULTI_CALL(VDK_NONE, &&, VDK_NONE)
+VDK_MULTI_CALL(const, &&, VDK_NONE)
+VDK_MULTI_CALL(volatile, &&, VDK_NONE)
+VDK_MULTI_CALL(const volatile, &&, VDK_NONE)
+VDK_MULTI_CALL(VDK_NONE, VDK_NONE, noexcept)
+VDK_MULTI_CALL(const, VDK_NONE, noexcept)
+VDK_MULTI_CALL(volatile, VDK_NONE, noexcept)
+VDK_MULTI_CALL(const volatile, VDK_NONE, noexcept)
+VDK_MULTI_CALL(VDK_NONE, &, noexcept)
+VDK_MULTI_CALL(const, &, noexcept)
+VDK_MULTI_CALL(volatile, &, noexcept)
+VDK_MULTI_CALL(const volatile, &, noexcept)
+VDK_MULTI_CALL(VDK_NONE, &&, noexcept)
+VDK_MULTI_CALL(const, &&, noexcept)
+VDK_MULTI_CALL(volatile, &&, noexcept)
+VDK_MULTI_CALL(const volatile, &&, noexcept)
+
+#undef VDK_NONE
+#undef VDK_MULTI_CALL
+
+// Call operators of multi_delegate D for all its signatures
+template<typename D, typename Seq, typename ... Fn>
+struct multi_calls;
+
+template<typename D, size_t ... I, typename ... Fn>
+struct multi_calls<D, std::index_sequence<I...>, Fn...>
+    : multi_call<Fn, I, D>...
+{
+    using multi_call<Fn, I, D>::operator()...;
+};
+
+} // namespace internal::delegate
+
+// Delegate with several call signatures that stores its target once
+template<typename ... Fn>
+class multi_delegate final
+    : internal::delegate::storage,
+      public internal::delegate::multi_calls<multi_delegate<Fn...>,
+                                             std::index_sequence_for<Fn...>, Fn...>
+{
+    static_assert(sizeof...(Fn) > 0, "multi_delegate requires at least one signature");
+
+    using storage = internal::delegate::storage;
+    using calls = internal::delegate::multi_calls<multi_delegate,
+                                                  std::index_sequence_for<Fn...>, Fn...>;
+    using vtbl = internal::delegate::multi_vtbl<storage, Fn...>;
+
+    template<typename, std::size_t, typename>
+    friend struct internal::delegate::multi_call;
+
+    template<typename T> static constexpr
+        bool is_internal_v = internal::delegate::is_internal_v<T>;
+    template<typename T> static constexpr
+        bool is_invocable_v = !std::is_same_v<T, multi_delegate> &&
+            (internal::delegate::traits<Fn, storage>::template is_invocable_v<T> && ...);
+
+public:
+
+    multi_delegate() noexcept = default;
+    multi_delegate(std::nullptr_t) noexcept {}
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    multi_delegate(F func) noexcept(is_internal_v<F>);
+
+    multi_delegate(multi_delegate && other) noexcept;
+    multi_delegate & operator=(multi_delegate && other) noexcept;
+    multi_delegate & operator=(std::nullptr_t) noexcept;
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    multi_delegate & operator=(F func) noexcept(is_internal_v<F>);
+
+    ~multi_delegate() noexcept;
+
+    using calls::operator();
+    explicit operator bool() const noexcept;
+
+    bool operator==(const multi_delegate & other) const noexcept;
+    bool operator!=(const multi_delegate & other) const noexcept;
+
+    multi_delegate(const multi_delegate &) = delete;
+    multi_delegate & operator=(const multi_delegate &) = delete;
+
+private:
+
+    const vtbl * vptr_{};
+};
+
+template<typename ... Fn>
+template<typename F, typename>
+multi_delegate<Fn...>::multi_delegate(F func) noexcept(is_internal_v<F>)
+{
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return;
+
+    if (!internal::delegate::construct(*this, std::move(func)))
+        return;
+
+    vptr_ = internal::delegate::multi_vtable<F, storage, Fn...>();
+}
+
+template<typename ... Fn>
+multi_delegate<Fn...>::multi_delegate(multi_delegate && other) noexcept
+{
+    vptr_ = other.vptr_;
+    if (vptr_) vptr_->move(other, *this);
+    other.vptr_ = nullptr;
+}
+
+template<typename ... Fn>
+multi_delegate<Fn...> &
+multi_delegate<Fn...>::operator=(multi_delegate && other) noexcept
+{
+    if (this != &other)
+    {
+        if (vptr_) vptr_->destroy(*this);
+        vptr_ = other.vptr_;
+        if (vptr_) vptr_->move(other, *this);
+        other.vptr_ = nullptr;
+    }
+    return *this;
+}
+
+template<typename ... Fn>
+multi_delegate<Fn...> & multi_delegate<Fn...>::operator=(std::nullptr_t) noexcept
+{
+    if (vptr_) vptr_->destroy(*this);
+    vptr_ = nullptr;
+    return *this;
+}
+
+template<typename ... Fn>
+template<typename F, typename>
+multi_delegate<Fn...> &
+multi_delegate<Fn...>::operator=(F func) noexcept(is_internal_v<F>)
+{
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return *this;
+
+    if constexpr(is_internal_v<F>)
+    {
+        if (vptr_) vptr_->destroy(*this);
+        ::new (storage::get()) F{ std::move(func) };
+    }
+    else
+    {
+        internal::delegate::memory_owner mem{ sizeof(F), alignof(F) };
+
+        if (mem.get())
+        {
+            auto addr = ::new (mem.get()) F{ std::move(func) };
+            if (vptr_) vptr_->destroy(*this);
+            *(storage::template get_as<F*>()) = addr;
+            mem.release();
+        }
+        else
+            return *this;
+    }
+
+    vptr_ = internal::delegate::multi_vtable<F, storage, Fn...>();
+    return *this;
+}
+
+template<typename ... Fn>
+multi_delegate<Fn...>::~multi_delegate() noexcept
+{
+    if (vptr_) vptr_->destroy(*this);
+}
+
+template<typename ... Fn>
+multi_delegate<Fn...>::operator bool() const noexcept
+{
+    return vptr_ != nullptr;
+}
+
+template<typename ... Fn>
+bool multi_delegate<Fn...>::operator==(const multi_delegate & other) const noexcept
+{
+    if (!vptr_ && !other.vptr_)
+        return true;
+    if (vptr_ != other.vptr_)
+        return false;
+    return vptr_->compare(*this, other);
+}
+
+template<typename ... Fn>
+bool multi_delegate<Fn...>::operator!=(const multi_delegate & other) const noexcept
+{
+    return !(*this == other);
+}
+
+template<typename ... Fn>
+bool operator==(const multi_delegate<Fn...> & lhs, std::nullptr_t) noexcept
+{
+    return !lhs;
+}
+
+template<typename ... Fn>
+bool operator==(std::nullptr_t, const multi_delegate<Fn...> & rhs) noexcept
+{
+    return !rhs;
+}
+
+template<typename ... Fn>
+bool operator!=(const multi_delegate<Fn...> & lhs, std::nullptr_t) noexcept
+{
+    return static_cast<bool>(lhs);
+}
+
+template<typename ... Fn>
+bool operator!=(std::nullptr_t, const multi_delegate<Fn...> & rhs) noexcept
+{
+    return static_cast<bool>(rhs);
+}
+
+} // namespace vdk
+
+#endif // VDK_MULTI_DELEGATE_H
@@ -0,0 +1,284 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_ONCE_DELEGATE_H
+#define VDK_ONCE_DELEGATE_H
+
+#include <new>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "delegate.h"
+
+#if defined(VDK_DELEGATE_INSTRUMENTATION)
+#define VDK_DELEGATE_PROBE(T)\
+    vdk::internal::instrumentation::probe<T, once_traits> probe_{ VDK_DELEGATE_CALL_SITE() }
+#else
+#define VDK_DELEGATE_PROBE(T) static_cast<void>(0)
+#endif
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::delegate
+{
+// Release target of type T kept outside of storage
+template<typename T>
+struct heap_target
+{
+    ~heap_target() noexcept
+    {
+        ptr_->~T();
+        memory()->deallocate(ptr_, sizeof(T), alignof(T));
+    }
+    T * ptr_;
+};
+
+// Take target of type T out of storage, leaving the storage free
+template<typename T>
+inline T take(storage & self) noexcept
+{
+    auto p = self.template get_as<T>();
+    T target{ std::move(*p) };
+    p->~T();
+    return target;
+}
+
+// Traits of one-shot delegate; thunk invokes and destroys target
+template<typename> struct once_traits;
+
+template<typename R, typename ... A>
+struct once_traits<R(A...)> : storage
+{
+    R(*call_)(storage*, A&&...) {};
+    const vtbl * vptr_{};
+
+    template<typename T>
+    static constexpr bool is_invocable_v = std::is_invocable_r_v<R, T&&, A...>;
+
+    template<typename T>
+    static R invoke(storage * self, A&& ... args)
+    {
+        VDK_DELEGATE_PROBE(T);
+        if constexpr(is_internal_v<T>)
+        {
+            return take<T>(*self)(std::forward<A>(args)...);
+        }
+        else
+        {
+            heap_target<T> target{ self->template get_as<T>() };
+            return std::move(*target.ptr_)(std::forward<A>(args)...);
+        }
+    }
+    inline R operator()(A ... args) &&
+    {
+        assert(call_ != nullptr);
+        // Delegate is empty during the call, so the target may assign a new one
+        auto call = std::exchange(call_, nullptr);
+        vptr_ = nullptr;
+        return call(this, std::forward<A>(args)...);
+    }
+};
+
+template<typename R, typename ... A>
+struct once_traits<R(A...)noexcept> : storage
+{
+    R(*call_)(storage*, A&&...)noexcept {};
+    const vtbl * vptr_{};
+
+    template<typename T>
+    static constexpr bool is_invocable_v = std::is_nothrow_invocable_r_v<R, T&&, A...>;
+
+    template<typename T>
+    static R invoke(storage * self, A&& ... args) noexcept
+    {
+        VDK_DELEGATE_PROBE(T);
+        if constexpr(is_internal_v<T>)
+        {
+            return take<T>(*self)(std::forward<A>(args)...);
+        }
+        else
+        {
+            heap_target<T> target{ self->template get_as<T>() };
+            return std::move(*target.ptr_)(std::forward<A>(args)...);
+        }
+    }
+    inline R operator()(A ... args) && noexcept
+    {
+        assert(call_ != nullptr);
+        // Delegate is empty during the call, so the target may assign a new one
+        auto call = std::exchange(call_, nullptr);
+        vptr_ = nullptr;
+        return call(this, std::forward<A>(args)...);
+    }
+};
+
+#undef VDK_DELEGATE_PROBE
+
+} // namespace internal::delegate
+
+// Delegate that can be invoked once; invocation consumes the target
+template<typename Fn>
+class once_delegate final : internal::delegate::once_traits<Fn>
+{
+    using base = internal::delegate::once_traits<Fn>;
+
+    using base::call_;
+    using base::vptr_;
+
+    template<typename T> static constexpr
+        bool is_internal_v = internal::delegate::is_internal_v<T>;
+    template<typename T> static constexpr
+        bool is_invocable_v = base::template is_invocable_v<T> &&
+                              !std::is_same_v<T, once_delegate>;
+
+public:
+
+    once_delegate() noexcept = default;
+    once_delegate(std::nullptr_t) noexcept {}
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    once_delegate(F func) noexcept(is_internal_v<F>);
+
+    once_delegate(once_delegate && other) noexcept;
+    once_delegate & operator=(once_delegate && other) noexcept;
+    once_delegate & operator=(std::nullptr_t) noexcept;
+
+    template<typename F, typename =
+        std::enable_if_t<is_invocable_v<F>>>
+    once_delegate & operator=(F func) noexcept(is_internal_v<F>);
+
+    ~once_delegate() noexcept;
+
+    using base::operator();
+    explicit operator bool() const noexcept;
+
+    once_delegate(const once_delegate &) = delete;
+    once_delegate & operator=(const once_delegate &) = delete;
+};
+
+template<typename Fn>
+template<typename F, typename>
+once_delegate<Fn>::once_delegate(F func) noexcept(is_internal_v<F>)
+{
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return;
+
+    if (!internal::delegate::construct(*this, std::move(func)))
+        return;
+
+    call_ = &base::template invoke<F>;
+    vptr_ = internal::delegate::vtable<F>();
+}
+
+template<typename Fn>
+once_delegate<Fn>::once_delegate(once_delegate && other) noexcept
+{
+    call_ = other.call_;
+    vptr_ = other.vptr_;
+    if (vptr_) vptr_->move(other, *this);
+    other.call_ = nullptr;
+    other.vptr_ = nullptr;
+}
+
+template<typename Fn>
+once_delegate<Fn> & once_delegate<Fn>::operator=(once_delegate && other) noexcept
+{
+    if (this != &other)
+    {
+        if (vptr_) vptr_->destroy(*this);
+        call_ = other.call_;
+        vptr_ = other.vptr_;
+        if (vptr_) vptr_->move(other, *this);
+        other.call_ = nullptr;
+        other.vptr_ = nullptr;
+    }
+    return *this;
+}
+
+template<typename Fn>
+once_delegate<Fn> & once_delegate<Fn>::operator=(std::nullptr_t) noexcept
+{
+    if (vptr_) vptr_->destroy(*this);
+    call_ = nullptr;
+    vptr_ = nullptr;
+    return *this;
+}
+
+template<typename Fn>
+template<typename F, typename>
+once_delegate<Fn> & once_delegate<Fn>::operator=(F func) noexcept(is_internal_v<F>)
+{
+    if constexpr(std::is_pointer_v<F>)
+        if (!func) return *this;
+
+    if constexpr(is_internal_v<F>)
+    {
+        if (vptr_) vptr_->destroy(*this);
+        ::new (base::get()) F{ std::move(func) };
+    }
+    else
+    {
+        internal::delegate::memory_owner mem{ sizeof(F), alignof(F) };
+
+        if (mem.get())
+        {
+            auto addr = ::new (mem.get()) F{ std::move(func) };
+            if (vptr_) vptr_->destroy(*this);
+            *(base::template get_as<F*>()) = addr;
+            mem.release();
+        }
+        else
+            return *this;
+    }
+
+    call_ = &base::template invoke<F>;
+    vptr_ = internal::delegate::vtable<F>();
+    return *this;
+}
+
+template<typename Fn>
+once_delegate<Fn>::~once_delegate() noexcept
+{
+    if (vptr_) vptr_->destroy(*this);
+}
+
+template<typename Fn>
+once_delegate<Fn>::operator bool() const noexcept
+{
+    return vptr_ != nullptr;
+}
+
+template<typename Fn>
+bool operator==(const once_delegate<Fn> & lhs, std::nullptr_t) noexcept
+{
+    return !lhs;
+}
+
+template<typename Fn>
+bool operator==(std::nullptr_t, const once_delegate<Fn> & rhs) noexcept
+{
+    return !rhs;
+}
+
+template<typename Fn>
+bool operator!=(const once_delegate<Fn> & lhs, std::nullptr_t) noexcept
+{
+    return static_cast<bool>(lhs);
+}
+
+template<typename Fn>
+bool operator!=(std::nullptr_t, const once_delegate<Fn> & rhs) noexcept
+{
+    return static_cast<bool>(rhs);
+}
+
+} // namespace vdk
+
+#endif // VDK_ONCE_DELEGATE_H
@@ -0,0 +1,292 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_PARALLEL_EMIT_H
+#define VDK_PARALLEL_EMIT_H
+
+#include <new>
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Partitioning of subscribers between threads
+struct emit_policy
+{
+    // Minimum number of subscribers per chunk; lists of at most
+    // this size are invoked on the calling thread
+    std::size_t grain_ = 64;
+
+    // Maximum number of threads invoking subscribers at once,
+    // including the calling thread; 0 means hardware concurrency
+    std::size_t concurrency_ = 0;
+};
+
+// Internal implementation details
+namespace internal::parallel_emit
+{
+using std::size_t;
+using vdk::internal::delegate::memory;
+using vdk::internal::delegate::memory_owner;
+
+// One emission shared by the threads that invoke its chunks of subscribers;
+// Args is a tuple of references for blocking emission, of values otherwise
+template<typename Fn, typename Args>
+class emission
+{
+public:
+
+    using done_t = vdk::delegate<void(std::exception_ptr)>;
+
+    static emission * create(vdk::delegate<Fn> * subscribers, size_t count,
+                             size_t grain, size_t refs, Args && args, done_t done);
+
+    void work() noexcept;
+    void wait() noexcept;
+    std::exception_ptr error() const noexcept;
+
+    void release(size_t refs = 1) noexcept;
+
+private:
+
+    emission(vdk::delegate<Fn> * subscribers, size_t count, size_t grain,
+             size_t refs, Args && args, done_t done);
+
+    void complete() noexcept;
+
+    vdk::delegate<Fn> * const subscribers_;
+    const size_t count_;
+    const size_t grain_;
+    const size_t chunks_;
+    Args args_;
+    done_t done_;
+
+    alignas(64) std::atomic<size_t> next_{ 0 };
+    alignas(64) std::atomic<size_t> completed_{ 0 };
+    std::atomic<size_t> refs_;
+
+    std::mutex mutex_;
+    std::condition_variable finished_;
+    std::exception_ptr error_;
+    bool complete_{};
+};
+
+template<typename Fn, typename Args>
+emission<Fn, Args>::emission(vdk::delegate<Fn> * subscribers, size_t count,
+                             size_t grain, size_t refs, Args && args, done_t done)
+    : subscribers_{ subscribers },
+      count_{ count },
+      grain_{ grain },
+      chunks_{ (count + grain - 1) / grain },
+      args_{ std::move(args) },
+      done_{ std::move(done) },
+      refs_{ refs }
+{}
+
+template<typename Fn, typename Args>
+emission<Fn, Args> * emission<Fn, Args>::create(vdk::delegate<Fn> * subscribers,
+    size_t count, size_t grain, size_t refs, Args && args, done_t done)
+{
+    memory_owner mem{ sizeof(emission), alignof(emission) };
+    if (!mem.get())
+        throw std::bad_alloc{};
+
+    auto self = ::new (mem.get()) emission{ subscribers, count, grain, refs,
+                                            std::move(args), std::move(done) };
+    mem.release();
+    return self;
+}
+
+// Claim chunks until none is left; a thread that comes late finds no work
+template<typename Fn, typename Args>
+void emission<Fn, Args>::work() noexcept
+{
+    for (;;)
+    {
+        const auto chunk = next_.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= chunks_)
+            return;
+
+        const auto first = chunk * grain_;
+        const auto last = (std::min)(first + grain_, count_);
+        try
+        {
+            for (auto i = first; i < last; ++i)
+                std::apply([this, i](auto & ... args) { subscribers_[i](args...); }, args_);
+        }
+        catch (...)
+        {
+            // Rest of the chunk is skipped; other chunks run
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            if (!error_)
+                error_ = std::current_exception();
+        }
+
+        if (completed_.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks_)
+            complete();
+    }
+}
+
+// Block until all chunks have been invoked
+template<typename Fn, typename Args>
+void emission<Fn, Args>::wait() noexcept
+{
+    std::unique_lock<std::mutex> lock{ mutex_ };
+    finished_.wait(lock, [this] { return complete_; });
+}
+
+template<typename Fn, typename Args>
+std::exception_ptr emission<Fn, Args>::error() const noexcept
+{
+    return error_;
+}
+
+template<typename Fn, typename Args>
+void emission<Fn, Args>::release(size_t refs) noexcept
+{
+    if (refs_.fetch_sub(refs, std::memory_order_acq_rel) == refs)
+    {
+        this->~emission();
+        memory()->deallocate(this, sizeof(emission), alignof(emission));
+    }
+}
+
+// Invoked by the thread that finishes the last chunk
+template<typename Fn, typename Args>
+void emission<Fn, Args>::complete() noexcept
+{
+    if (done_)
+    {
+        done_(error_);
+        return;
+    }
+    std::lock_guard<std::mutex> lock{ mutex_ };
+    complete_ = true;
+    finished_.notify_all();
+}
+
+// Queried once: hardware_concurrency may read system files on every call
+inline size_t hardware_threads() noexcept
+{
+    static const size_t threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+    return threads;
+}
+
+// Number of threads that can usefully take chunks of count subscribers
+inline size_t participants(size_t count, const emit_policy & policy) noexcept
+{
+    const auto grain = (std::max)(policy.grain_, size_t{ 1 });
+    const auto chunks = (count + grain - 1) / grain;
+    const auto limit = policy.concurrency_ ? policy.concurrency_ : hardware_threads();
+    return (std::min)(chunks, limit);
+}
+
+// Post helpers that share the work and return the number posted; executor
+// that fails to accept a helper leaves its share to the others
+template<typename Executor, typename E>
+size_t post_helpers(Executor & executor, E * state, size_t helpers) noexcept
+{
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        try
+        {
+            executor.post(vdk::delegate<void()>{ [state] { state->work(); state->release(); } });
+        }
+        catch (...)
+        {
+            state->release(helpers - i);
+            return i;
+        }
+    }
+    return helpers;
+}
+
+} // namespace internal::parallel_emit
+
+// Invoke count subscribers with args, splitting them into chunks run in parallel
+// by the calling thread and by tasks posted to executor; returns when all are done
+template<typename Executor, typename ... A, typename ... Args>
+void parallel_emit(Executor & executor, delegate<void(A...)> * subscribers,
+                   std::size_t count, emit_policy policy, Args && ... args)
+{
+    using args_t = std::tuple<std::remove_reference_t<Args>&...>;
+    using emission_t = internal::parallel_emit::emission<void(A...), args_t>;
+
+    const auto grain = (std::max)(policy.grain_, std::size_t{ 1 });
+    const auto threads = internal::parallel_emit::participants(count, policy);
+    if (threads <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            subscribers[i](args...);
+        return;
+    }
+
+    // Calling thread holds one reference and takes chunks as well
+    auto state = emission_t::create(subscribers, count, grain, threads,
+                                    args_t{ args... }, nullptr);
+    internal::parallel_emit::post_helpers(executor, state, threads - 1);
+    state->work();
+    state->wait();
+
+    const auto error = state->error();
+    state->release();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Same as parallel_emit, but returns at once; args are copied, and done
+// is invoked with the first exception thrown by subscribers, if any, by
+// the thread that completes the last chunk. Subscribers must stay alive
+// until then.
+template<typename Executor, typename ... A, typename ... Args>
+void parallel_emit_async(Executor & executor, delegate<void(A...)> * subscribers,
+                         std::size_t count, emit_policy policy,
+                         delegate<void(std::exception_ptr)> done, Args && ... args)
+{
+    using args_t = std::tuple<std::decay_t<Args>...>;
+    using emission_t = internal::parallel_emit::emission<void(A...), args_t>;
+
+    assert(done);
+    const auto grain = (std::max)(policy.grain_, std::size_t{ 1 });
+    const auto threads = internal::parallel_emit::participants(count, policy);
+    if (threads <= 1)
+    {
+        std::exception_ptr error;
+        try
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                subscribers[i](args...);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        done(error);
+        return;
+    }
+
+    // Creator's reference covers posting; if no helper is accepted, work runs here
+    auto state = emission_t::create(subscribers, count, grain, threads + 1,
+                                    args_t{ std::forward<Args>(args)... }, std::move(done));
+    if (!internal::parallel_emit::post_helpers(executor, state, threads))
+        state->work();
+    state->release();
+}
+
+} // namespace vdk
+
+#endif // VDK_PARALLEL_EMIT_H
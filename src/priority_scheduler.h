@@ -0,0 +1,337 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_PRIORITY_SCHEDULER_H
+#define VDK_PRIORITY_SCHEDULER_H
+
+#include <new>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <condition_variable>
+
+#include "delegate.h"
+#include "mpsc_queue.h"
+
+namespace vdk
+{
+// Starvation control of priority_scheduler
+struct scheduler_policy
+{
+    // Number of tasks from higher lanes that may run while a lower lane
+    // is not empty before the lower lane is served; 0 disables aging
+    std::size_t quantum_ = 16;
+};
+
+// Counters of one lane of priority_scheduler
+struct lane_stats
+{
+    std::size_t depth_;
+    std::uint64_t executed_;
+
+    // Time from post to start of execution, in nanoseconds
+    std::uint64_t total_wait_;
+    std::uint64_t max_wait_;
+};
+
+// Internal implementation details
+namespace internal::priority_scheduler
+{
+using clock = std::chrono::steady_clock;
+
+inline std::uint64_t now() noexcept
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<
+        std::chrono::nanoseconds>(clock::now().time_since_epoch()).count());
+}
+
+// Task with the time of its post
+struct task : mpsc::node
+{
+    static task * create(vdk::delegate<void()> func);
+    static void destroy(task * self) noexcept;
+
+    vdk::delegate<void()> func_;
+    std::uint64_t posted_;
+};
+
+inline task * task::create(vdk::delegate<void()> func)
+{
+    mpsc::memory_owner mem{ sizeof(task), alignof(task) };
+    if (!mem.get())
+        throw std::bad_alloc{};
+
+    auto self = ::new (mem.get()) task{};
+    mem.release();
+    self->func_ = std::move(func);
+    self->posted_ = now();
+    return self;
+}
+
+inline void task::destroy(task * self) noexcept
+{
+    self->~task();
+    mpsc::memory()->deallocate(self, sizeof(task), alignof(task));
+}
+
+// Queue of one priority; producers never wait, consumers take turns
+struct alignas(mpsc::cache_line) lane
+{
+    task * try_pop() noexcept;
+    void record(std::uint64_t wait) noexcept;
+
+    mpsc::queue queue_;
+
+    alignas(mpsc::cache_line) std::atomic<bool> busy_{ false };
+    std::atomic<std::size_t> depth_{ 0 };
+    std::atomic<std::size_t> bypassed_{ 0 };
+
+    alignas(mpsc::cache_line) std::atomic<std::uint64_t> executed_{ 0 };
+    std::atomic<std::uint64_t> total_wait_{ 0 };
+    std::atomic<std::uint64_t> max_wait_{ 0 };
+};
+
+// Returns nullptr if the lane is empty or another worker is taking from it
+inline task * lane::try_pop() noexcept
+{
+    if (depth_.load(std::memory_order_acquire) == 0 ||
+        busy_.exchange(true, std::memory_order_acquire))
+        return nullptr;
+
+    auto item = static_cast<task*>(queue_.pop());
+    busy_.store(false, std::memory_order_release);
+
+    if (item)
+        depth_.fetch_sub(1, std::memory_order_relaxed);
+    return item;
+}
+
+inline void lane::record(std::uint64_t wait) noexcept
+{
+    executed_.fetch_add(1, std::memory_order_relaxed);
+    total_wait_.fetch_add(wait, std::memory_order_relaxed);
+
+    auto max = max_wait_.load(std::memory_order_relaxed);
+    while (wait > max &&
+           !max_wait_.compare_exchange_weak(max, wait, std::memory_order_relaxed))
+    {}
+}
+
+} // namespace internal::priority_scheduler
+
+// Pool of worker threads running delegate tasks from Lanes priority lanes;
+// lane 0 has the highest priority
+template<std::size_t Lanes>
+class priority_scheduler final
+{
+    static_assert(Lanes > 0, "priority_scheduler requires at least one lane");
+
+public:
+
+    explicit priority_scheduler(std::size_t threads, scheduler_policy policy = {});
+    ~priority_scheduler() noexcept;
+
+    void post(std::size_t lane, delegate<void()> task);
+
+    lane_stats stats(std::size_t lane) const noexcept;
+    std::size_t threads() const noexcept;
+
+    priority_scheduler(const priority_scheduler &) = delete;
+    priority_scheduler & operator=(const priority_scheduler &) = delete;
+
+private:
+
+    using task = internal::priority_scheduler::task;
+    using lane = internal::priority_scheduler::lane;
+
+    void work() noexcept;
+    void shutdown() noexcept;
+    task * take(std::size_t & index) noexcept;
+    void age(std::size_t served) noexcept;
+
+    std::array<lane, Lanes> lanes_;
+    const scheduler_policy policy_;
+
+    // Tasks posted and not taken yet; workers sleep while it is zero
+    alignas(internal::mpsc::cache_line) std::atomic<std::size_t> pending_{ 0 };
+    std::atomic<std::size_t> sleeping_{ 0 };
+    std::atomic<bool> stop_{ false };
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<std::thread> threads_;
+};
+
+template<std::size_t Lanes>
+priority_scheduler<Lanes>::priority_scheduler(std::size_t threads, scheduler_policy policy)
+    : policy_{ policy }
+{
+    assert(threads > 0);
+    try
+    {
+        for (std::size_t i = 0; i < threads; ++i)
+            threads_.emplace_back([this] { work(); });
+    }
+    catch (...)
+    {
+        shutdown();
+        throw;
+    }
+}
+
+template<std::size_t Lanes>
+priority_scheduler<Lanes>::~priority_scheduler() noexcept
+{
+    shutdown();
+}
+
+// Task must not throw exceptions; its worker thread has nowhere to report them
+template<std::size_t Lanes>
+void priority_scheduler<Lanes>::post(std::size_t lane, delegate<void()> func)
+{
+    assert(lane < Lanes && func);
+
+    auto item = task::create(std::move(func));
+
+    // Counters are never less than the number of queued tasks
+    auto & l = lanes_[lane];
+    pending_.fetch_add(1, std::memory_order_seq_cst);
+    l.depth_.fetch_add(1, std::memory_order_relaxed);
+    l.queue_.push(item);
+
+    if (sleeping_.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        wake_.notify_one();
+    }
+}
+
+// Snapshot of counters of lane; depth includes tasks being posted right now
+template<std::size_t Lanes>
+lane_stats priority_scheduler<Lanes>::stats(std::size_t lane) const noexcept
+{
+    assert(lane < Lanes);
+    const auto & l = lanes_[lane];
+    return { l.depth_.load(std::memory_order_relaxed),
+             l.executed_.load(std::memory_order_relaxed),
+             l.total_wait_.load(std::memory_order_relaxed),
+             l.max_wait_.load(std::memory_order_relaxed) };
+}
+
+template<std::size_t Lanes>
+std::size_t priority_scheduler<Lanes>::threads() const noexcept
+{
+    return threads_.size();
+}
+
+template<std::size_t Lanes>
+void priority_scheduler<Lanes>::work() noexcept
+{
+    for (;;)
+    {
+        std::size_t index = 0;
+        if (auto item = take(index))
+        {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+
+            const auto start = internal::priority_scheduler::now();
+            lanes_[index].record(start - item->posted_);
+            item->func_();
+            task::destroy(item);
+            continue;
+        }
+
+        // Task is counted, but its producer may be in the middle of push
+        if (pending_.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{ mutex_ };
+        sleeping_.fetch_add(1, std::memory_order_seq_cst);
+        while (!pending_.load(std::memory_order_seq_cst) &&
+               !stop_.load(std::memory_order_relaxed))
+            wake_.wait(lock);
+        sleeping_.fetch_sub(1, std::memory_order_relaxed);
+
+        // Workers exit only when no tasks are left
+        if (!pending_.load(std::memory_order_seq_cst) &&
+            stop_.load(std::memory_order_relaxed))
+            return;
+    }
+}
+
+// Wait for all posted tasks, including tasks posted by them, then join workers
+template<std::size_t Lanes>
+void priority_scheduler<Lanes>::shutdown() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        stop_.store(true, std::memory_order_seq_cst);
+    }
+    wake_.notify_all();
+    for (auto & t : threads_)
+        t.join();
+    threads_.clear();
+}
+
+// Lane that was bypassed too many times goes first, then lanes in order of priority
+template<std::size_t Lanes>
+typename priority_scheduler<Lanes>::task *
+priority_scheduler<Lanes>::take(std::size_t & index) noexcept
+{
+    if (policy_.quantum_)
+    {
+        for (std::size_t i = Lanes; i-- > 1;)
+        {
+            auto & l = lanes_[i];
+            if (l.bypassed_.load(std::memory_order_relaxed) < policy_.quantum_)
+                continue;
+            if (auto item = l.try_pop())
+            {
+                l.bypassed_.store(0, std::memory_order_relaxed);
+                index = i;
+                return item;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < Lanes; ++i)
+    {
+        if (auto item = lanes_[i].try_pop())
+        {
+            age(i);
+            index = i;
+            return item;
+        }
+    }
+    return nullptr;
+}
+
+// Count the task of lane served against every lower lane that is waiting
+template<std::size_t Lanes>
+void priority_scheduler<Lanes>::age(std::size_t served) noexcept
+{
+    if (!policy_.quantum_)
+        return;
+
+    lanes_[served].bypassed_.store(0, std::memory_order_relaxed);
+    for (auto i = served + 1; i < Lanes; ++i)
+        if (lanes_[i].depth_.load(std::memory_order_relaxed))
+            lanes_[i].bypassed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace vdk
+
+#endif // VDK_PRIORITY_SCHEDULER_H
@@ -0,0 +1,326 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_REACTOR_H
+#define VDK_REACTOR_H
+
+#if !defined(__linux__)
+#error "reactor.h requires Linux (epoll and eventfd)"
+#endif
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <system_error>
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "delegate.h"
+#include "mpsc_queue.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::reactor
+{
+[[noreturn]] inline void throw_system_error(const char * what)
+{
+    throw std::system_error{ errno, std::system_category(), what };
+}
+
+} // namespace internal::reactor
+
+// Event loop that dispatches file descriptor readiness to delegates
+class reactor final
+{
+public:
+
+    using handler_t = delegate<void(std::uint32_t)>;
+
+    explicit reactor(std::size_t max_events = 256);
+    ~reactor() noexcept;
+
+    void add(int fd, std::uint32_t events, handler_t handler);
+    void modify(int fd, std::uint32_t events);
+    void remove(int fd) noexcept;
+
+    void post(delegate<void()> task);
+
+    std::size_t run_once(int timeout = -1);
+    void run();
+    void stop() noexcept;
+
+    reactor(const reactor &) = delete;
+    reactor & operator=(const reactor &) = delete;
+
+private:
+
+    using task_node = internal::mpsc::delegate_node<void()>;
+
+    static constexpr std::size_t chunk_size = 256;
+
+    // Registered file descriptor
+    struct entry
+    {
+        handler_t handler_;
+        std::uint32_t generation_{};
+    };
+
+    static std::uint64_t key(int fd, std::uint32_t generation) noexcept;
+    entry * find(int fd) const noexcept;
+    void wake() noexcept;
+    std::size_t drain();
+
+    // Entries are allocated in chunks so they never move while a handler runs
+    std::vector<std::unique_ptr<entry[]>> entries_;
+    std::vector<epoll_event> events_;
+
+    // Events of the batch after a throwing handler are dispatched next
+    int next_event_{};
+    int event_count_{};
+    internal::mpsc::queue tasks_;
+    handler_t replacement_;
+    int current_fd_{ -1 };
+    bool current_removed_{};
+    std::atomic<bool> wake_pending_{ false };
+    std::atomic<bool> stopped_{ false };
+    int epoll_fd_{ -1 };
+    int event_fd_{ -1 };
+};
+
+inline reactor::reactor(std::size_t max_events)
+    : events_(max_events ? max_events : 1)
+{
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+        internal::reactor::throw_system_error("epoll_create1");
+
+    event_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd_ < 0)
+    {
+        ::close(epoll_fd_);
+        internal::reactor::throw_system_error("eventfd");
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = key(event_fd_, 0);
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event) < 0)
+    {
+        ::close(event_fd_);
+        ::close(epoll_fd_);
+        internal::reactor::throw_system_error("epoll_ctl");
+    }
+}
+
+inline reactor::~reactor() noexcept
+{
+    while (auto item = tasks_.pop())
+        task_node::destroy(item);
+    ::close(event_fd_);
+    ::close(epoll_fd_);
+}
+
+inline void reactor::add(int fd, std::uint32_t events, handler_t handler)
+{
+    assert(fd >= 0 && fd != event_fd_);
+    assert(handler);
+
+    const auto chunk = static_cast<std::size_t>(fd) / chunk_size;
+    while (entries_.size() <= chunk)
+        entries_.emplace_back(new entry[chunk_size]);
+
+    auto & target = entries_[chunk][static_cast<std::size_t>(fd) % chunk_size];
+
+    // Handler of the current event removed its own descriptor and adds it again
+    const bool replace = fd == current_fd_ && current_removed_;
+    assert(!target.handler_ || replace);
+
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = key(fd, target.generation_);
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0)
+        internal::reactor::throw_system_error("epoll_ctl");
+
+    if (replace)
+        replacement_ = std::move(handler);
+    else
+        target.handler_ = std::move(handler);
+}
+
+inline void reactor::modify(int fd, std::uint32_t events)
+{
+    auto target = find(fd);
+    assert(target && target->handler_);
+
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = key(fd, target->generation_);
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) < 0)
+        internal::reactor::throw_system_error("epoll_ctl");
+}
+
+inline void reactor::remove(int fd) noexcept
+{
+    auto target = find(fd);
+    if (!target || !target->handler_)
+        return;
+
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ++target->generation_;
+
+    // Running handler is destroyed after it returns
+    if (fd == current_fd_)
+    {
+        current_removed_ = true;
+        replacement_ = nullptr;
+    }
+    else
+        target->handler_ = nullptr;
+}
+
+inline void reactor::post(delegate<void()> task)
+{
+    assert(task);
+    tasks_.push(task_node::create(std::move(task)));
+    wake();
+}
+
+inline std::size_t reactor::run_once(int timeout)
+{
+    // Rest of a batch left by a throwing handler is dispatched without waiting
+    if (next_event_ == event_count_)
+    {
+        int count = ::epoll_wait(epoll_fd_, events_.data(),
+                                 static_cast<int>(events_.size()), timeout);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                return 0;
+            internal::reactor::throw_system_error("epoll_wait");
+        }
+        next_event_ = 0;
+        event_count_ = count;
+    }
+
+    std::size_t dispatched = 0;
+    bool has_tasks = false;
+
+    while (next_event_ < event_count_)
+    {
+        const auto & event = events_[next_event_++];
+        const auto fd = static_cast<int>(event.data.u64 & 0xFFFFFFFF);
+        const auto generation = static_cast<std::uint32_t>(event.data.u64 >> 32);
+
+        if (fd == event_fd_)
+        {
+            has_tasks = true;
+            continue;
+        }
+
+        // Skip events of descriptors removed earlier in this batch
+        auto target = find(fd);
+        if (!target || target->generation_ != generation || !target->handler_)
+            continue;
+
+        current_fd_ = fd;
+        current_removed_ = false;
+
+        struct guard
+        {
+            ~guard()
+            {
+                if (self.current_removed_)
+                    target.handler_ = std::move(self.replacement_);
+                self.current_fd_ = -1;
+                self.current_removed_ = false;
+            }
+            reactor & self;
+            entry & target;
+        } finalize{ *this, *target };
+
+        target->handler_(event.events);
+        ++dispatched;
+    }
+
+    if (has_tasks)
+        dispatched += drain();
+
+    return dispatched;
+}
+
+inline void reactor::run()
+{
+    while (!stopped_.load(std::memory_order_acquire))
+        run_once();
+    stopped_.store(false, std::memory_order_relaxed);
+}
+
+inline void reactor::stop() noexcept
+{
+    stopped_.store(true, std::memory_order_release);
+    wake();
+}
+
+inline std::uint64_t reactor::key(int fd, std::uint32_t generation) noexcept
+{
+    return (std::uint64_t{ generation } << 32) | static_cast<std::uint32_t>(fd);
+}
+
+inline reactor::entry * reactor::find(int fd) const noexcept
+{
+    const auto chunk = static_cast<std::size_t>(fd) / chunk_size;
+    if (fd < 0 || chunk >= entries_.size())
+        return nullptr;
+    return &entries_[chunk][static_cast<std::size_t>(fd) % chunk_size];
+}
+
+inline void reactor::wake() noexcept
+{
+    // Only the first producer since the last drain writes to eventfd
+    if (!wake_pending_.exchange(true, std::memory_order_acq_rel))
+    {
+        std::uint64_t value = 1;
+        [[maybe_unused]] auto result = ::write(event_fd_, &value, sizeof(value));
+    }
+}
+
+inline std::size_t reactor::drain()
+{
+    std::uint64_t value;
+    [[maybe_unused]] auto result = ::read(event_fd_, &value, sizeof(value));
+    wake_pending_.exchange(false, std::memory_order_acq_rel);
+
+    std::size_t executed = 0;
+    while (auto item = tasks_.pop())
+    {
+        auto task = std::move(static_cast<task_node*>(item)->func_);
+        task_node::destroy(item);
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            // Remaining tasks stay queued and run on the next iteration
+            wake();
+            throw;
+        }
+        ++executed;
+    }
+    return executed;
+}
+
+} // namespace vdk
+
+#endif // VDK_REACTOR_H
@@ -0,0 +1,222 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_RETIRE_H
+#define VDK_RETIRE_H
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <condition_variable>
+
+#include "delegate.h"
+#include "mpsc_queue.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::retire
+{
+using vdk::internal::delegate::memory;
+using vdk::internal::delegate::memory_owner;
+
+// Queue node of retired object of any type
+struct retired : mpsc::node
+{
+    using destroy_t = void(*)(retired*) noexcept;
+    using release_t = void(*)(retired*) noexcept;
+
+    destroy_t destroy_;
+    release_t release_;
+};
+
+// Queue node that owns retired object of type T
+template<typename T>
+struct retired_object final : retired
+{
+    template<typename U>
+    static retired_object * create(U && object);
+
+    static void destroy(retired * self) noexcept;
+    static void release(retired * self) noexcept;
+
+    explicit retired_object(T && object) noexcept(
+        std::is_nothrow_move_constructible_v<T>);
+
+    T object_;
+};
+
+template<typename T>
+template<typename U>
+retired_object<T> * retired_object<T>::create(U && object)
+{
+    memory_owner mem{ sizeof(retired_object), alignof(retired_object) };
+
+    if (!mem.get())
+        throw std::bad_alloc{};
+
+    auto self = ::new (mem.get()) retired_object{ std::forward<U>(object) };
+    mem.release();
+    return self;
+}
+
+template<typename T>
+retired_object<T>::retired_object(T && object) noexcept(
+    std::is_nothrow_move_constructible_v<T>)
+    : retired{ {}, &destroy, &release },
+      object_{ std::move(object) }
+{}
+
+template<typename T>
+void retired_object<T>::destroy(retired * self) noexcept
+{
+    static_cast<retired_object*>(self)->~retired_object();
+}
+
+template<typename T>
+void retired_object<T>::release(retired * self) noexcept
+{
+    memory()->deallocate(self, sizeof(retired_object), alignof(retired_object));
+}
+
+} // namespace internal::retire
+
+// Lock-free list of objects whose destruction is deferred
+class retire_queue final
+{
+public:
+
+    retire_queue() noexcept = default;
+    ~retire_queue() noexcept;
+
+    template<typename T>
+    void retire(T && object);
+
+    std::size_t drain() noexcept;
+
+    retire_queue(const retire_queue &) = delete;
+    retire_queue & operator=(const retire_queue &) = delete;
+
+private:
+
+    using retired = internal::retire::retired;
+
+    internal::mpsc::queue queue_;
+    std::vector<retired*> batch_;
+    std::atomic<bool> draining_{ false };
+};
+
+inline retire_queue::~retire_queue() noexcept
+{
+    drain();
+}
+
+template<typename T>
+void retire_queue::retire(T && object)
+{
+    static_assert(!std::is_lvalue_reference_v<T>,
+                  "retire takes ownership of the object; pass an rvalue");
+
+    using node_t = internal::retire::retired_object<std::remove_cv_t<T>>;
+    queue_.push(node_t::create(std::move(object)));
+}
+
+inline std::size_t retire_queue::drain() noexcept
+{
+    // Only one thread at a time can consume the queue
+    if (draining_.exchange(true, std::memory_order_acquire))
+        return 0;
+
+    std::size_t count = 0;
+    while (auto item = queue_.pop())
+    {
+        auto node = static_cast<retired*>(item);
+        node->destroy_(node);
+
+        // Node memory is returned in batches after the objects are destroyed
+        try
+        {
+            batch_.push_back(node);
+        }
+        catch (...)
+        {
+            node->release_(node);
+        }
+        ++count;
+    }
+
+    for (auto node : batch_)
+        node->release_(node);
+    batch_.clear();
+
+    draining_.store(false, std::memory_order_release);
+    return count;
+}
+
+// Background thread that periodically drains retire queue
+class retire_thread final
+{
+public:
+
+    explicit retire_thread(retire_queue & queue,
+        std::chrono::microseconds period = std::chrono::milliseconds{ 1 });
+    ~retire_thread() noexcept;
+
+    retire_thread(const retire_thread &) = delete;
+    retire_thread & operator=(const retire_thread &) = delete;
+
+private:
+
+    void run() noexcept;
+
+    retire_queue & queue_;
+    std::chrono::microseconds period_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_{};
+    std::thread thread_;
+};
+
+inline retire_thread::retire_thread(retire_queue & queue,
+                                    std::chrono::microseconds period)
+    : queue_{ queue },
+      period_{ period },
+      thread_{ [this] { run(); } }
+{}
+
+inline retire_thread::~retire_thread() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        stop_ = true;
+    }
+    cond_.notify_one();
+    thread_.join();
+}
+
+inline void retire_thread::run() noexcept
+{
+    std::unique_lock<std::mutex> lock{ mutex_ };
+    while (!stop_)
+    {
+        lock.unlock();
+        queue_.drain();
+        lock.lock();
+        cond_.wait_for(lock, period_, [this] { return stop_; });
+    }
+    lock.unlock();
+    queue_.drain();
+}
+
+} // namespace vdk
+
+#endif // VDK_RETIRE_H
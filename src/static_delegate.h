@@ -0,0 +1,155 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_STATIC_DELEGATE_H
+#define VDK_STATIC_DELEGATE_H
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::delegate
+{
+// Literal call operator for static delegate types
+template<typename> struct static_traits;
+
+template<typename R, typename ... A>
+struct static_traits<R(*)(A...)>
+{
+    using fn_t = R(*)(A...);
+
+    constexpr R operator()(A ... args) const
+    {
+        assert(func_ != nullptr);
+        return func_(std::forward<A>(args)...);
+    }
+
+    fn_t func_{};
+};
+
+template<typename R, typename ... A>
+struct static_traits<R(*)(A...)noexcept>
+{
+    using fn_t = R(*)(A...)noexcept;
+
+    constexpr R operator()(A ... args) const noexcept
+    {
+        assert(func_ != nullptr);
+        return func_(std::forward<A>(args)...);
+    }
+
+    fn_t func_{};
+};
+
+} // namespace internal::delegate
+
+// Delegate that can be constructed in constant expressions
+template<typename Fn>
+class static_delegate final
+    : internal::delegate::static_traits<
+        typename internal::delegate::traits<Fn>::fn_t>
+{
+    using base = internal::delegate::static_traits<
+        typename internal::delegate::traits<Fn>::fn_t>;
+
+    using base::func_;
+
+    template<typename F> static constexpr
+        bool is_stateless_v = std::is_convertible_v<F, typename base::fn_t> &&
+                              !std::is_same_v<F, typename base::fn_t> &&
+                              !std::is_same_v<F, static_delegate>;
+
+public:
+
+    using fn_t = typename base::fn_t;
+
+    constexpr static_delegate() noexcept = default;
+    constexpr static_delegate(std::nullptr_t) noexcept {}
+    constexpr static_delegate(fn_t func) noexcept;
+
+    template<typename F, typename =
+        std::enable_if_t<is_stateless_v<F>>>
+    constexpr static_delegate(F func) noexcept;
+
+    using base::operator();
+    constexpr explicit operator bool() const noexcept;
+    constexpr fn_t target() const noexcept;
+
+    constexpr bool operator==(const static_delegate & other) const noexcept;
+    constexpr bool operator!=(const static_delegate & other) const noexcept;
+};
+
+template<typename Fn>
+constexpr static_delegate<Fn>::static_delegate(fn_t func) noexcept
+    : base{ func }
+{}
+
+template<typename Fn>
+template<typename F, typename>
+constexpr static_delegate<Fn>::static_delegate(F func) noexcept
+    : base{ static_cast<fn_t>(func) }
+{}
+
+template<typename Fn>
+constexpr static_delegate<Fn>::operator bool() const noexcept
+{
+    return func_ != nullptr;
+}
+
+template<typename Fn>
+constexpr typename static_delegate<Fn>::fn_t
+static_delegate<Fn>::target() const noexcept
+{
+    return func_;
+}
+
+template<typename Fn>
+constexpr bool static_delegate<Fn>::
+operator==(const static_delegate & other) const noexcept
+{
+    return func_ == other.func_;
+}
+
+template<typename Fn>
+constexpr bool static_delegate<Fn>::
+operator!=(const static_delegate & other) const noexcept
+{
+    return !(*this == other);
+}
+
+template<typename Fn>
+constexpr bool operator==(const static_delegate<Fn> & lhs, std::nullptr_t) noexcept
+{
+    return !lhs;
+}
+
+template<typename Fn>
+constexpr bool operator==(std::nullptr_t, const static_delegate<Fn> & rhs) noexcept
+{
+    return !rhs;
+}
+
+template<typename Fn>
+constexpr bool operator!=(const static_delegate<Fn> & lhs, std::nullptr_t) noexcept
+{
+    return static_cast<bool>(lhs);
+}
+
+template<typename Fn>
+constexpr bool operator!=(std::nullptr_t, const static_delegate<Fn> & rhs) noexcept
+{
+    return static_cast<bool>(rhs);
+}
+
+} // namespace vdk
+
+#endif // VDK_STATIC_DELEGATE_H
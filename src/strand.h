@@ -0,0 +1,167 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_STRAND_H
+#define VDK_STRAND_H
+
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+#include "delegate.h"
+#include "mpsc_queue.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::strand
+{
+// Strand whose tasks are being run by the current thread
+inline thread_local const void * current = nullptr;
+
+} // namespace internal::strand
+
+// Serializes tasks posted from any thread; tasks run one at a time
+// in FIFO order on threads of the underlying executor
+template<typename Executor>
+class strand final
+{
+public:
+
+    explicit strand(Executor & executor, std::size_t batch = 64) noexcept;
+    ~strand() noexcept;
+
+    void post(delegate<void()> task);
+
+    bool running_in_this_thread() const noexcept;
+    Executor & executor() const noexcept;
+
+    strand(const strand &) = delete;
+    strand & operator=(const strand &) = delete;
+
+private:
+
+    using task_node = internal::mpsc::delegate_node<void()>;
+
+    void schedule() noexcept;
+    void run();
+    delegate<void()> take() noexcept;
+
+    Executor & executor_;
+    const std::size_t batch_;
+    internal::mpsc::queue tasks_;
+
+    // Number of posted tasks that have not completed yet
+    alignas(internal::mpsc::cache_line) std::atomic<std::size_t> pending_{ 0 };
+};
+
+template<typename Executor>
+strand<Executor>::strand(Executor & executor, std::size_t batch) noexcept
+    : executor_{ executor },
+      batch_{ batch ? batch : 1 }
+{}
+
+template<typename Executor>
+strand<Executor>::~strand() noexcept
+{
+    assert(pending_.load(std::memory_order_acquire) == 0 &&
+           "strand is destroyed while its tasks are pending");
+    while (auto item = tasks_.pop())
+        task_node::destroy(item);
+}
+
+template<typename Executor>
+void strand<Executor>::post(delegate<void()> task)
+{
+    assert(task);
+    tasks_.push(task_node::create(std::move(task)));
+
+    // Task posted to idle strand schedules it on the executor
+    if (pending_.fetch_add(1, std::memory_order_acq_rel) == 0)
+        schedule();
+}
+
+template<typename Executor>
+bool strand<Executor>::running_in_this_thread() const noexcept
+{
+    return internal::strand::current == this;
+}
+
+template<typename Executor>
+Executor & strand<Executor>::executor() const noexcept
+{
+    return executor_;
+}
+
+// Failure to schedule would leave pending tasks that never run
+template<typename Executor>
+void strand<Executor>::schedule() noexcept
+{
+    executor_.post(delegate<void()>{ [this] { run(); } });
+}
+
+// Run up to batch_ tasks, then yield the executor's thread to other work
+template<typename Executor>
+void strand<Executor>::run()
+{
+    struct guard
+    {
+        ~guard() noexcept
+        {
+            internal::strand::current = previous_;
+
+            // Remaining tasks run in the next batch, also after a task has thrown
+            if (taken_ && self_.pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                return;
+            if (!idle_)
+                self_.schedule();
+        }
+        strand & self_;
+        const void * previous_;
+        bool taken_;
+        bool idle_;
+    } running{ *this, internal::strand::current, false, false };
+
+    internal::strand::current = this;
+
+    for (std::size_t i = 0; i < batch_; ++i)
+    {
+        {
+            auto task = take();
+            running.taken_ = true;
+            task();
+        }
+        running.taken_ = false;
+
+        // Strand must not be accessed after it becomes idle
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            running.idle_ = true;
+            return;
+        }
+    }
+}
+
+template<typename Executor>
+delegate<void()> strand<Executor>::take() noexcept
+{
+    // Task is counted, but its producer may be in the middle of push
+    auto item = tasks_.pop();
+    while (!item)
+    {
+        std::this_thread::yield();
+        item = tasks_.pop();
+    }
+    auto task = std::move(static_cast<task_node*>(item)->func_);
+    task_node::destroy(item);
+    return task;
+}
+
+} // namespace vdk
+
+#endif // VDK_STRAND_H
@@ -0,0 +1,593 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_STRING_DISPATCHER_H
+#define VDK_STRING_DISPATCHER_H
+
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Internal implementation details
+namespace internal::string_dispatcher
+{
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+// Marker of free slot | end of bucket list
+inline constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+
+// Buckets with more keys force a larger table
+inline constexpr size_t max_bucket = 32;
+inline constexpr uint32_t max_seed = 1u << 16;
+
+inline constexpr uint64_t golden = 0x9E3779B97F4A7C15ull;
+
+// Final mixing step of splitmix64
+constexpr uint64_t mix(uint64_t x) noexcept
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Little-endian value of up to 8 characters starting at pos
+constexpr uint64_t load(std::string_view s, size_t pos, size_t count) noexcept
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < count; ++i)
+        value |= uint64_t{ static_cast<unsigned char>(s[pos + i]) } << (8 * i);
+    return value;
+}
+
+// Hash of key, computed once per lookup; 8 characters per step
+constexpr uint64_t hash(std::string_view key) noexcept
+{
+    uint64_t h = golden ^ key.size();
+    size_t i = 0;
+    for (; i + 8 <= key.size(); i += 8)
+    {
+        h = (h ^ load(key, i, 8)) * golden;
+        h ^= h >> 29;
+    }
+    if (i < key.size())
+        h = (h ^ load(key, i, key.size() - i)) * golden;
+    return mix(h);
+}
+
+constexpr size_t bucket(uint64_t h, size_t mask) noexcept
+{
+    return static_cast<size_t>(h >> 32) & mask;
+}
+
+// Slot of key within table; seed of its bucket selects the mapping
+constexpr size_t slot(uint64_t h, uint32_t seed, size_t mask) noexcept
+{
+    return static_cast<size_t>(mix(h + seed * golden)) & mask;
+}
+
+// Smallest power of two not less than n
+constexpr size_t ceil2(size_t n) noexcept
+{
+    size_t value = 1;
+    while (value < n)
+        value *= 2;
+    return value;
+}
+
+// Table sizes for n keys: load factor of slots at most 1/2, two keys per bucket
+constexpr size_t slots_for(size_t n) noexcept
+{
+    return ceil2(n * 2);
+}
+constexpr size_t buckets_for(size_t n) noexcept
+{
+    return ceil2((n + 1) / 2);
+}
+
+// Geometric growth of capacity, so that later insertion cannot throw
+template<typename Vector>
+void grow(Vector & v, size_t size)
+{
+    if (size > v.capacity())
+        v.reserve(std::max(size, v.capacity() * 2));
+}
+
+// Find seed that maps keys of one bucket to distinct free slots, then occupy them
+template<typename Hashes, typename Slots>
+constexpr bool place(const uint32_t * members, size_t count, const Hashes & hashes,
+                     Slots & slots, uint32_t & seed) noexcept
+{
+    const size_t mask = slots.size() - 1;
+
+    // Keys with equal hashes cannot be separated by any seed
+    for (size_t i = 0; i < count; ++i)
+        for (size_t j = 0; j < i; ++j)
+            if (hashes[members[i]] == hashes[members[j]])
+                return false;
+
+    for (uint32_t s = 0; s < max_seed; ++s)
+    {
+        size_t taken[max_bucket]{};
+        size_t i = 0;
+        for (; i < count; ++i)
+        {
+            const auto pos = slot(hashes[members[i]], s, mask);
+            if (slots[pos] != empty)
+                break;
+            size_t j = 0;
+            while (j < i && taken[j] != pos)
+                ++j;
+            if (j < i)
+                break;
+            taken[i] = pos;
+        }
+        if (i == count)
+        {
+            for (i = 0; i < count; ++i)
+                slots[taken[i]] = members[i];
+            seed = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Keys of bucket b; returns their number, or more than max_bucket if they do not fit
+template<typename Heads, typename Links>
+constexpr size_t gather(const Heads & head, const Links & next, size_t b,
+                        uint32_t (&members)[max_bucket]) noexcept
+{
+    size_t count = 0;
+    for (auto i = head[b]; i != empty; i = next[i], ++count)
+        if (count < max_bucket)
+            members[count] = i;
+    return count;
+}
+
+// Build the whole table; largest buckets are placed first
+template<typename Hashes, typename Heads, typename Links, typename Seeds, typename Slots>
+constexpr bool build(const Hashes & hashes, size_t n, Heads & head, Links & next,
+                     Seeds & seeds, Slots & slots) noexcept
+{
+    const size_t buckets = seeds.size();
+    for (size_t b = 0; b < buckets; ++b)
+    {
+        head[b] = empty;
+        seeds[b] = 0;
+    }
+    for (size_t s = 0; s < slots.size(); ++s)
+        slots[s] = empty;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto b = bucket(hashes[i], buckets - 1);
+        next[i] = head[b];
+        head[b] = static_cast<uint32_t>(i);
+    }
+
+    uint32_t members[max_bucket]{};
+    for (size_t size = max_bucket + 1; size > 0; --size)
+    {
+        for (size_t b = 0; b < buckets; ++b)
+        {
+            const auto count = gather(head, next, b, members);
+            if (count > max_bucket)
+                return false;
+            if (count == size && !place(members, count, hashes, slots, seeds[b]))
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace internal::string_dispatcher
+
+// Number of keys of dispatcher whose keys are registered at run time
+inline constexpr std::size_t dynamic_keys = std::numeric_limits<std::size_t>::max();
+
+// Perfect hash over fixed set of N keys, built in constant expressions
+template<std::size_t N>
+class perfect_hash final
+{
+    static_assert(N > 0, "perfect_hash requires at least one key");
+
+    static constexpr std::size_t bucket_count =
+        internal::string_dispatcher::buckets_for(N);
+    static constexpr std::size_t slot_count =
+        internal::string_dispatcher::slots_for(N);
+
+public:
+
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    constexpr explicit perfect_hash(const std::array<std::string_view, N> & keys);
+
+    constexpr std::size_t find(std::string_view key) const noexcept;
+    constexpr std::string_view key(std::size_t index) const noexcept;
+    static constexpr std::size_t size() noexcept;
+
+private:
+
+    std::array<std::string_view, N> keys_{};
+    std::array<std::uint64_t, N> hashes_{};
+    std::array<std::uint32_t, bucket_count> seeds_{};
+    std::array<std::uint32_t, slot_count> slots_{};
+};
+
+template<std::size_t N>
+constexpr perfect_hash<N>::perfect_hash(const std::array<std::string_view, N> & keys)
+    : keys_{ keys }
+{
+    using namespace internal::string_dispatcher;
+
+    for (std::size_t i = 0; i < N; ++i)
+        hashes_[i] = hash(keys_[i]);
+
+    std::array<std::uint32_t, bucket_count> head{};
+    std::array<std::uint32_t, N> next{};
+
+    // In constant evaluation the exception is a compile-time error
+    if (!build(hashes_, N, head, next, seeds_, slots_))
+        throw std::invalid_argument{ "perfect_hash keys must be distinct" };
+}
+
+// Index of key in the list given to constructor, or npos
+template<std::size_t N>
+constexpr std::size_t perfect_hash<N>::find(std::string_view key) const noexcept
+{
+    using namespace internal::string_dispatcher;
+
+    const auto h = hash(key);
+    const auto seed = seeds_[bucket(h, bucket_count - 1)];
+    const auto index = slots_[slot(h, seed, slot_count - 1)];
+
+    if (index == empty || hashes_[index] != h || keys_[index] != key)
+        return npos;
+    return index;
+}
+
+template<std::size_t N>
+constexpr std::string_view perfect_hash<N>::key(std::size_t index) const noexcept
+{
+    assert(index < N);
+    return keys_[index];
+}
+
+template<std::size_t N>
+constexpr std::size_t perfect_hash<N>::size() noexcept
+{
+    return N;
+}
+
+// Create perfect hash over string literals | string views
+template<typename ... Keys>
+constexpr perfect_hash<sizeof...(Keys)> make_perfect_hash(const Keys & ... keys)
+{
+    return perfect_hash<sizeof...(Keys)>{ { std::string_view{ keys }... } };
+}
+
+// Table of delegates resolved by string key with a single probe of perfect hash
+template<typename Fn, std::size_t N = dynamic_keys>
+class string_dispatcher final
+{
+public:
+
+    explicit string_dispatcher(const perfect_hash<N> & keys) noexcept;
+
+    bool assign(std::string_view key, delegate<Fn> handler) noexcept;
+
+    delegate<Fn> * find(std::string_view key) noexcept;
+    const delegate<Fn> * find(std::string_view key) const noexcept;
+    bool contains(std::string_view key) const noexcept;
+
+    static constexpr std::size_t size() noexcept;
+
+    string_dispatcher(const string_dispatcher &) = delete;
+    string_dispatcher & operator=(const string_dispatcher &) = delete;
+
+private:
+
+    perfect_hash<N> keys_;
+    delegate<Fn> handlers_[N];
+};
+
+template<typename Fn, std::size_t N>
+string_dispatcher<Fn, N>::
+string_dispatcher(const perfect_hash<N> & keys) noexcept
+    : keys_{ keys }
+{}
+
+// Returns false if key is not in the key set
+template<typename Fn, std::size_t N>
+bool string_dispatcher<Fn, N>::assign(std::string_view key, delegate<Fn> handler) noexcept
+{
+    const auto index = keys_.find(key);
+    if (index == perfect_hash<N>::npos)
+        return false;
+    handlers_[index] = std::move(handler);
+    return true;
+}
+
+// Handler of key, possibly empty; nullptr if key is not in the key set
+template<typename Fn, std::size_t N>
+delegate<Fn> * string_dispatcher<Fn, N>::find(std::string_view key) noexcept
+{
+    const auto index = keys_.find(key);
+    return index == perfect_hash<N>::npos ? nullptr : &handlers_[index];
+}
+
+template<typename Fn, std::size_t N>
+const delegate<Fn> * string_dispatcher<Fn, N>::find(std::string_view key) const noexcept
+{
+    const auto index = keys_.find(key);
+    return index == perfect_hash<N>::npos ? nullptr : &handlers_[index];
+}
+
+template<typename Fn, std::size_t N>
+bool string_dispatcher<Fn, N>::contains(std::string_view key) const noexcept
+{
+    return keys_.find(key) != perfect_hash<N>::npos;
+}
+
+template<typename Fn, std::size_t N>
+constexpr std::size_t string_dispatcher<Fn, N>::size() noexcept
+{
+    return N;
+}
+
+// Dispatcher whose keys are registered at run time; perfect hash is
+// maintained on registration, so lookups never probe more than one slot
+template<typename Fn>
+class string_dispatcher<Fn, dynamic_keys> final
+{
+public:
+
+    string_dispatcher() noexcept = default;
+
+    bool add(std::string_view key, delegate<Fn> handler);
+    void reserve(std::size_t count);
+    void clear() noexcept;
+
+    delegate<Fn> * find(std::string_view key) noexcept;
+    const delegate<Fn> * find(std::string_view key) const noexcept;
+    bool contains(std::string_view key) const noexcept;
+
+    std::size_t size() const noexcept;
+
+    string_dispatcher(const string_dispatcher &) = delete;
+    string_dispatcher & operator=(const string_dispatcher &) = delete;
+
+private:
+
+    // Location of key in the character pool
+    struct entry
+    {
+        std::uint32_t offset_;
+        std::uint32_t size_;
+    };
+
+    std::size_t lookup(std::string_view key) const noexcept;
+    void insert(std::uint32_t index);
+    void rebuild(std::size_t slot_count);
+
+    std::vector<delegate<Fn>> handlers_;
+    std::vector<std::uint64_t> hashes_;
+    std::vector<entry> entries_;
+    std::vector<char> chars_;
+
+    std::vector<std::uint32_t> seeds_;
+    std::vector<std::uint32_t> slots_;
+
+    // Lists of keys of each bucket, needed to re-seed a bucket
+    std::vector<std::uint32_t> head_;
+    std::vector<std::uint32_t> next_;
+};
+
+// Returns false if key is already registered
+template<typename Fn>
+bool string_dispatcher<Fn, dynamic_keys>::add(std::string_view key, delegate<Fn> handler)
+{
+    if (lookup(key) != std::size_t(-1))
+        return false;
+
+    const auto index = handlers_.size();
+    if (index >= internal::string_dispatcher::empty ||
+        chars_.size() + key.size() > std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error{ "string_dispatcher is too large" };
+
+    using internal::string_dispatcher::grow;
+    grow(handlers_, index + 1);
+    grow(hashes_, index + 1);
+    grow(entries_, index + 1);
+    grow(next_, index + 1);
+    grow(chars_, chars_.size() + key.size());
+
+    struct guard
+    {
+        // Registration that failed leaves the dispatcher unchanged
+        ~guard() noexcept { if (!done_) hashes_.pop_back(); }
+        std::vector<std::uint64_t> & hashes_;
+        bool done_;
+    } adding{ hashes_, false };
+
+    hashes_.push_back(internal::string_dispatcher::hash(key));
+    insert(static_cast<std::uint32_t>(index));
+    adding.done_ = true;
+
+    entries_.push_back({ static_cast<std::uint32_t>(chars_.size()),
+                         static_cast<std::uint32_t>(key.size()) });
+    chars_.insert(chars_.end(), key.begin(), key.end());
+    handlers_.push_back(std::move(handler));
+    return true;
+}
+
+template<typename Fn>
+void string_dispatcher<Fn, dynamic_keys>::reserve(std::size_t count)
+{
+    handlers_.reserve(count);
+    hashes_.reserve(count);
+    entries_.reserve(count);
+    next_.reserve(count);
+    if (internal::string_dispatcher::slots_for(count) > slots_.size())
+        rebuild(internal::string_dispatcher::slots_for(count));
+}
+
+template<typename Fn>
+void string_dispatcher<Fn, dynamic_keys>::clear() noexcept
+{
+    handlers_.clear();
+    hashes_.clear();
+    entries_.clear();
+    chars_.clear();
+    seeds_.clear();
+    slots_.clear();
+    head_.clear();
+    next_.clear();
+}
+
+// Handler registered for key; nullptr if there is none
+template<typename Fn>
+delegate<Fn> * string_dispatcher<Fn, dynamic_keys>::find(std::string_view key) noexcept
+{
+    const auto index = lookup(key);
+    return index == std::size_t(-1) ? nullptr : &handlers_[index];
+}
+
+template<typename Fn>
+const delegate<Fn> * string_dispatcher<Fn, dynamic_keys>::
+find(std::string_view key) const noexcept
+{
+    const auto index = lookup(key);
+    return index == std::size_t(-1) ? nullptr : &handlers_[index];
+}
+
+template<typename Fn>
+bool string_dispatcher<Fn, dynamic_keys>::contains(std::string_view key) const noexcept
+{
+    return lookup(key) != std::size_t(-1);
+}
+
+template<typename Fn>
+std::size_t string_dispatcher<Fn, dynamic_keys>::size() const noexcept
+{
+    return handlers_.size();
+}
+
+template<typename Fn>
+std::size_t string_dispatcher<Fn, dynamic_keys>::
+lookup(std::string_view key) const noexcept
+{
+    using namespace internal::string_dispatcher;
+
+    if (slots_.empty())
+        return std::size_t(-1);
+
+    const auto h = hash(key);
+    const auto seed = seeds_[bucket(h, seeds_.size() - 1)];
+    const auto index = slots_[slot(h, seed, slots_.size() - 1)];
+
+    // Unknown keys are rejected by hash without touching characters
+    if (index == empty || hashes_[index] != h)
+        return std::size_t(-1);
+    const auto & e = entries_[index];
+    if (e.size_ != key.size() ||
+        std::memcmp(chars_.data() + e.offset_, key.data(), key.size()) != 0)
+        return std::size_t(-1);
+    return index;
+}
+
+// Place new key; only its bucket is re-seeded unless the table must grow
+template<typename Fn>
+void string_dispatcher<Fn, dynamic_keys>::insert(std::uint32_t index)
+{
+    using namespace internal::string_dispatcher;
+
+    const std::size_t count = index + 1;
+    if (slots_for(count) > slots_.size())
+    {
+        rebuild(slots_for(count) * 2);
+        return;
+    }
+
+    const auto h = hashes_[index];
+    const auto b = bucket(h, seeds_.size() - 1);
+    const auto pos = slot(h, seeds_[b], slots_.size() - 1);
+
+    if (slots_[pos] == empty)
+    {
+        slots_[pos] = index;
+        next_.push_back(head_[b]);
+        head_[b] = index;
+        return;
+    }
+
+    next_.push_back(head_[b]);
+    head_[b] = index;
+
+    uint32_t members[max_bucket]{};
+    const auto size = gather(head_, next_, b, members);
+    if (size <= max_bucket)
+    {
+        // Release slots of the other keys of the bucket
+        for (std::size_t i = 1; i < size; ++i)
+            slots_[slot(hashes_[members[i]], seeds_[b], slots_.size() - 1)] = empty;
+        if (place(members, size, hashes_, slots_, seeds_[b]))
+            return;
+        for (std::size_t i = 1; i < size; ++i)
+            slots_[slot(hashes_[members[i]], seeds_[b], slots_.size() - 1)] = members[i];
+    }
+
+    // Table must stay intact if rebuild fails
+    head_[b] = next_.back();
+    next_.pop_back();
+    rebuild(slots_.size() * 2);
+}
+
+// Build table with given number of slots, growing it until all keys fit
+template<typename Fn>
+void string_dispatcher<Fn, dynamic_keys>::rebuild(std::size_t slot_count)
+{
+    using namespace internal::string_dispatcher;
+
+    const auto count = hashes_.size();
+    for (int attempt = 0; attempt < 8; ++attempt, slot_count *= 2)
+    {
+        std::vector<std::uint32_t> seeds(std::max<std::size_t>(slot_count / 4, 1));
+        std::vector<std::uint32_t> slots(slot_count);
+        std::vector<std::uint32_t> head(seeds.size());
+        std::vector<std::uint32_t> next(count);
+        next.reserve(next_.capacity());
+
+        if (build(hashes_, count, head, next, seeds, slots))
+        {
+            seeds_.swap(seeds);
+            slots_.swap(slots);
+            head_.swap(head);
+            next_.swap(next);
+            return;
+        }
+    }
+    throw std::length_error{ "string_dispatcher cannot separate keys with equal hashes" };
+}
+
+} // namespace vdk
+
+#endif // VDK_STRING_DISPATCHER_H
@@ -0,0 +1,373 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_TIMER_WHEEL_H
+#define VDK_TIMER_WHEEL_H
+
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "delegate.h"
+
+namespace vdk
+{
+// Hierarchical timer wheel that schedules delegates
+class timer_wheel final
+{
+public:
+
+    using tick_t = std::uint64_t;
+
+    class handle;
+
+    explicit timer_wheel(std::size_t capacity = 0);
+
+    handle schedule(tick_t delay, delegate<void()> callback);
+    bool cancel(handle timer) noexcept;
+
+    std::size_t advance(tick_t ticks = 1);
+    void clear() noexcept;
+
+    tick_t now() const noexcept;
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    timer_wheel(const timer_wheel &) = delete;
+    timer_wheel & operator=(const timer_wheel &) = delete;
+
+private:
+
+    using index_t = std::uint32_t;
+
+    static constexpr index_t npos = std::numeric_limits<index_t>::max();
+    static constexpr unsigned slot_bits = 6;
+    static constexpr unsigned slots = 1u << slot_bits;
+    static constexpr unsigned levels = (64 + slot_bits - 1) / slot_bits;
+    static constexpr tick_t slot_mask = slots - 1;
+
+    // Slot of timers whose callbacks are being invoked by advance
+    static constexpr index_t expiring = levels * slots;
+
+    // Scheduled timer; free nodes are linked through next_
+    struct node
+    {
+        delegate<void()> callback_;
+        tick_t deadline_;
+        index_t prev_;
+        index_t next_;
+        index_t generation_;
+        index_t slot_;
+    };
+
+    index_t allocate();
+    void deallocate(index_t index) noexcept;
+    void insert(index_t index) noexcept;
+    void unlink(index_t index) noexcept;
+    index_t detach(index_t slot) noexcept;
+    void cascade() noexcept;
+    std::size_t expire(index_t slot);
+    std::size_t drain();
+
+    std::vector<node> nodes_;
+    index_t heads_[levels * slots];
+    index_t expiring_{ npos };
+    std::uint64_t occupied_[levels]{};
+    index_t free_{ npos };
+    std::size_t size_{};
+    tick_t now_{};
+    bool advancing_{};
+};
+
+// Reference to a scheduled timer
+class timer_wheel::handle
+{
+public:
+
+    handle() noexcept = default;
+
+    explicit operator bool() const noexcept;
+
+    bool operator==(const handle & other) const noexcept;
+    bool operator!=(const handle & other) const noexcept;
+
+private:
+
+    friend class timer_wheel;
+
+    handle(index_t index, index_t generation) noexcept;
+
+    index_t index_{ npos };
+    index_t generation_{};
+};
+
+inline timer_wheel::handle::handle(index_t index, index_t generation) noexcept
+    : index_{ index },
+      generation_{ generation }
+{}
+
+inline timer_wheel::handle::operator bool() const noexcept
+{
+    return index_ != npos;
+}
+
+inline bool timer_wheel::handle::operator==(const handle & other) const noexcept
+{
+    return index_ == other.index_ && generation_ == other.generation_;
+}
+
+inline bool timer_wheel::handle::operator!=(const handle & other) const noexcept
+{
+    return !(*this == other);
+}
+
+inline timer_wheel::timer_wheel(std::size_t capacity)
+{
+    nodes_.reserve(capacity);
+    for (auto & head : heads_)
+        head = npos;
+}
+
+inline timer_wheel::handle
+timer_wheel::schedule(tick_t delay, delegate<void()> callback)
+{
+    assert(callback);
+
+    auto index = allocate();
+    auto & timer = nodes_[index];
+    timer.callback_ = std::move(callback);
+
+    // Zero delay expires on the next tick
+    if (delay == 0) delay = 1;
+    timer.deadline_ = now_ + delay < now_ ?
+        std::numeric_limits<tick_t>::max() : now_ + delay;
+
+    insert(index);
+    ++size_;
+    return handle{ index, timer.generation_ };
+}
+
+inline bool timer_wheel::cancel(handle timer) noexcept
+{
+    if (timer.index_ >= nodes_.size())
+        return false;
+
+    auto & target = nodes_[timer.index_];
+    if (target.generation_ != timer.generation_ || target.slot_ == npos)
+        return false;
+
+    unlink(timer.index_);
+    deallocate(timer.index_);
+    --size_;
+    return true;
+}
+
+inline std::size_t timer_wheel::advance(tick_t ticks)
+{
+    assert(!advancing_ && "timer_wheel::advance must not be called from a callback");
+
+    // Flag is reset when a callback throws
+    struct guard
+    {
+        ~guard() noexcept { advancing_ = false; }
+        bool & advancing_;
+    } advancing{ advancing_ = true };
+
+    // Timers left pending by a throwing callback expire first
+    std::size_t fired = drain();
+    const tick_t target = now_ + ticks;
+
+    while (now_ != target)
+    {
+        if (size_ == 0)
+        {
+            now_ = target;
+            break;
+        }
+
+        // Nothing can expire before the next cascade if level 0 is empty
+        if (occupied_[0] == 0)
+        {
+            const tick_t last = now_ | slot_mask;
+            if (target - now_ <= last - now_)
+            {
+                now_ = target;
+                break;
+            }
+            now_ = last;
+        }
+
+        ++now_;
+        if ((now_ & slot_mask) == 0)
+            cascade();
+        fired += expire(static_cast<index_t>(now_ & slot_mask));
+    }
+    return fired;
+}
+
+inline void timer_wheel::clear() noexcept
+{
+    for (index_t slot = 0; slot < levels * slots; ++slot)
+    {
+        for (auto index = detach(slot); index != npos;)
+        {
+            auto next = nodes_[index].next_;
+            deallocate(index);
+            index = next;
+        }
+    }
+    for (auto index = std::exchange(expiring_, npos); index != npos;)
+    {
+        auto next = nodes_[index].next_;
+        deallocate(index);
+        index = next;
+    }
+    size_ = 0;
+}
+
+inline timer_wheel::tick_t timer_wheel::now() const noexcept
+{
+    return now_;
+}
+
+inline std::size_t timer_wheel::size() const noexcept
+{
+    return size_;
+}
+
+inline bool timer_wheel::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+inline timer_wheel::index_t timer_wheel::allocate()
+{
+    if (free_ != npos)
+    {
+        auto index = free_;
+        free_ = nodes_[index].next_;
+        return index;
+    }
+
+    assert(nodes_.size() < npos);
+    nodes_.push_back(node{ nullptr, 0, npos, npos, 0, npos });
+    return static_cast<index_t>(nodes_.size() - 1);
+}
+
+inline void timer_wheel::deallocate(index_t index) noexcept
+{
+    auto & timer = nodes_[index];
+    timer.callback_ = nullptr;
+    timer.slot_ = npos;
+    timer.prev_ = npos;
+    timer.next_ = free_;
+    ++timer.generation_;
+    free_ = index;
+}
+
+inline void timer_wheel::insert(index_t index) noexcept
+{
+    auto & timer = nodes_[index];
+
+    // Level is determined by the highest digit where deadline differs from now
+    unsigned level = 0;
+    for (auto diff = (timer.deadline_ ^ now_) >> slot_bits; diff; diff >>= slot_bits)
+        ++level;
+
+    const auto digit = static_cast<index_t>(
+        (timer.deadline_ >> (level * slot_bits)) & slot_mask);
+    const auto slot = level * slots + digit;
+
+    timer.slot_ = slot;
+    timer.prev_ = npos;
+    timer.next_ = heads_[slot];
+    if (heads_[slot] != npos)
+        nodes_[heads_[slot]].prev_ = index;
+    heads_[slot] = index;
+    occupied_[level] |= std::uint64_t{ 1 } << digit;
+}
+
+inline void timer_wheel::unlink(index_t index) noexcept
+{
+    auto & timer = nodes_[index];
+
+    auto & head = timer.slot_ == expiring ? expiring_ : heads_[timer.slot_];
+
+    if (timer.prev_ != npos)
+        nodes_[timer.prev_].next_ = timer.next_;
+    else
+        head = timer.next_;
+
+    if (timer.next_ != npos)
+        nodes_[timer.next_].prev_ = timer.prev_;
+
+    if (timer.slot_ != expiring && head == npos)
+        occupied_[timer.slot_ / slots] &=
+            ~(std::uint64_t{ 1 } << (timer.slot_ % slots));
+}
+
+inline timer_wheel::index_t timer_wheel::detach(index_t slot) noexcept
+{
+    auto head = heads_[slot];
+    heads_[slot] = npos;
+    occupied_[slot / slots] &= ~(std::uint64_t{ 1 } << (slot % slots));
+    return head;
+}
+
+inline void timer_wheel::cascade() noexcept
+{
+    // Highest level whose lower digits of now are all zero
+    unsigned top = 1;
+    while (top + 1 < levels && ((now_ >> (top * slot_bits)) & slot_mask) == 0)
+        ++top;
+
+    // Redistribute from higher levels first so lower levels get their timers
+    for (auto level = top; level > 0; --level)
+    {
+        const auto digit = static_cast<index_t>(
+            (now_ >> (level * slot_bits)) & slot_mask);
+
+        for (auto index = detach(level * slots + digit); index != npos;)
+        {
+            auto next = nodes_[index].next_;
+            insert(index);
+            index = next;
+        }
+    }
+}
+
+inline std::size_t timer_wheel::expire(index_t slot)
+{
+    // Batch stays linked until each callback runs, so callbacks can cancel it
+    expiring_ = detach(slot);
+    for (auto index = expiring_; index != npos; index = nodes_[index].next_)
+        nodes_[index].slot_ = expiring;
+    return drain();
+}
+
+inline std::size_t timer_wheel::drain()
+{
+    // Rest of the batch stays pending if a callback throws
+    std::size_t fired = 0;
+    while (expiring_ != npos)
+    {
+        const auto index = expiring_;
+        auto callback = std::move(nodes_[index].callback_);
+        unlink(index);
+        deallocate(index);
+        --size_;
+        ++fired;
+        callback();
+    }
+    return fired;
+}
+
+} // namespace vdk
+
+#endif // VDK_TIMER_WHEEL_H
@@ -0,0 +1,289 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#ifndef VDK_WEAK_BIND_H
+#define VDK_WEAK_BIND_H
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <functional>
+#include <type_traits>
+
+namespace vdk
+{
+class trackable;
+
+// Internal implementation details
+namespace internal::weak
+{
+using std::size_t;
+
+// Generation counter of one trackable object; atomic, since a binding
+// may observe the destruction of its object from another thread
+struct slot
+{
+    std::atomic<std::uint64_t> generation_;
+    slot * next_;
+};
+
+// Source of slots; slots are reused but never freed,
+// so a stale reference can always read the counter
+class slot_pool
+{
+public:
+
+    slot * acquire();
+    void release(slot * s) noexcept;
+
+private:
+
+    static constexpr size_t chunk = 256;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<slot[]>> chunks_;
+    slot * free_{};
+};
+
+inline slot * slot_pool::acquire()
+{
+    std::lock_guard<std::mutex> lock{ mutex_ };
+    if (!free_)
+    {
+        chunks_.reserve(chunks_.size() + 1);
+        auto & block = chunks_.emplace_back(new slot[chunk]{});
+        for (size_t i = 0; i < chunk; ++i)
+            block[i].next_ = i + 1 < chunk ? &block[i + 1] : nullptr;
+        free_ = block.get();
+    }
+    auto s = free_;
+    free_ = s->next_;
+    return s;
+}
+
+inline void slot_pool::release(slot * s) noexcept
+{
+    std::lock_guard<std::mutex> lock{ mutex_ };
+    s->next_ = free_;
+    free_ = s;
+}
+
+// Global pool; intentionally leaked, since trackable objects
+// with static storage duration may be destroyed after it
+inline slot_pool & pool()
+{
+    static auto * const instance = new slot_pool{};
+    return *instance;
+}
+
+template<auto Method, typename T>
+class bound;
+
+} // namespace internal::weak
+
+// Weak reference to the lifetime of a trackable object
+class weak_ref final
+{
+public:
+
+    weak_ref() noexcept = default;
+
+    bool expired() const noexcept;
+    explicit operator bool() const noexcept;
+
+    bool operator==(const weak_ref & other) const noexcept;
+    bool operator!=(const weak_ref & other) const noexcept;
+
+private:
+
+    friend class trackable;
+    template<auto, typename>
+    friend class internal::weak::bound;
+
+    weak_ref(const internal::weak::slot * s, std::uint64_t generation) noexcept;
+
+    const internal::weak::slot * slot_{};
+    std::uint64_t generation_{};
+};
+
+inline weak_ref::weak_ref(const internal::weak::slot * s,
+                          std::uint64_t generation) noexcept
+    : slot_{ s },
+      generation_{ generation }
+{}
+
+inline bool weak_ref::expired() const noexcept
+{
+    return !slot_ ||
+        slot_->generation_.load(std::memory_order_acquire) != generation_;
+}
+
+inline weak_ref::operator bool() const noexcept
+{
+    return slot_ != nullptr;
+}
+
+inline bool weak_ref::operator==(const weak_ref & other) const noexcept
+{
+    return slot_ == other.slot_ && generation_ == other.generation_;
+}
+
+inline bool weak_ref::operator!=(const weak_ref & other) const noexcept
+{
+    return !(*this == other);
+}
+
+// Base class for objects that can be bound weakly
+class trackable
+{
+public:
+
+    trackable();
+    trackable(const trackable & other);
+    trackable & operator=(const trackable & other) noexcept;
+    ~trackable() noexcept;
+
+    weak_ref lifetime() const noexcept;
+
+private:
+
+    internal::weak::slot * slot_;
+};
+
+inline trackable::trackable()
+    : slot_{ internal::weak::pool().acquire() }
+{}
+
+// Copy is a different object with its own lifetime
+inline trackable::trackable(const trackable &)
+    : trackable{}
+{}
+
+inline trackable & trackable::operator=(const trackable &) noexcept
+{
+    return *this;
+}
+
+inline trackable::~trackable() noexcept
+{
+    // Expire all references before the slot can be reused
+    slot_->generation_.fetch_add(1, std::memory_order_release);
+    internal::weak::pool().release(slot_);
+}
+
+inline weak_ref trackable::lifetime() const noexcept
+{
+    return { slot_, slot_->generation_.load(std::memory_order_relaxed) };
+}
+
+// Internal implementation details
+namespace internal::weak
+{
+// Result of weak call: nothing for void, otherwise optional result
+template<typename R>
+struct result
+{
+    static_assert(!std::is_reference_v<R>,
+                  "weakly bound member function must not return a reference");
+    using type = std::optional<R>;
+};
+
+template<>
+struct result<void>
+{
+    using type = void;
+};
+
+// Member function bound to trackable object that is skipped after its destruction
+template<auto Method, typename T>
+class bound
+{
+    template<typename ... A>
+    using result_t = typename result<
+        std::invoke_result_t<decltype(Method), T&, A...>>::type;
+
+public:
+
+    bound(T * object, weak_ref owner) noexcept;
+
+    template<typename ... A>
+    auto operator()(A && ... args) const -> result_t<A...>;
+
+    bool expired() const noexcept;
+    weak_ref owner() const noexcept;
+
+    bool operator==(const bound & other) const noexcept;
+
+private:
+
+    T * object_;
+    weak_ref owner_;
+};
+
+template<auto Method, typename T>
+bound<Method, T>::bound(T * object, weak_ref owner) noexcept
+    : object_{ object },
+      owner_{ owner }
+{}
+
+template<auto Method, typename T>
+template<typename ... A>
+auto bound<Method, T>::operator()(A && ... args) const -> result_t<A...>
+{
+    // Single load of the counter; no reference counting
+    const auto generation = owner_.slot_->generation_.load(std::memory_order_acquire);
+    if (generation != owner_.generation_)
+        return result_t<A...>();
+    return std::invoke(Method, *object_, std::forward<A>(args)...);
+}
+
+template<auto Method, typename T>
+bool bound<Method, T>::expired() const noexcept
+{
+    return owner_.expired();
+}
+
+template<auto Method, typename T>
+weak_ref bound<Method, T>::owner() const noexcept
+{
+    return owner_;
+}
+
+template<auto Method, typename T>
+bool bound<Method, T>::operator==(const bound & other) const noexcept
+{
+    return object_ == other.object_ && owner_ == other.owner_;
+}
+
+// Check whether F is a weak binding
+template<typename F>
+struct is_bound : std::false_type {};
+template<auto Method, typename T>
+struct is_bound<bound<Method, T>> : std::true_type {};
+template<typename F> inline constexpr
+bool is_bound_v = is_bound<std::decay_t<F>>::value;
+
+} // namespace internal::weak
+
+// Bind member function to trackable object; calls after its destruction do nothing
+template<auto Method, typename T>
+internal::weak::bound<Method, T> weak_bind(T & object) noexcept
+{
+    static_assert(std::is_member_function_pointer_v<decltype(Method)>,
+                  "weak_bind requires pointer to member function");
+    static_assert(std::is_base_of_v<trackable, T>,
+                  "weak_bind requires object derived from vdk::trackable");
+    return { &object, object.lifetime() };
+}
+
+} // namespace vdk
+
+#endif // VDK_WEAK_BIND_H
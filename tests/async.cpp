@@ -0,0 +1,254 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <future>
+#include <stdexcept>
+#include <condition_variable>
+
+#include <gtest/gtest.h>
+#include <async.h>
+
+namespace
+{
+using vdk::delegate;
+
+// Executor that runs posted delegates on its own thread
+class thread_executor
+{
+public:
+
+    thread_executor()
+        : thread_{ [this] { work(); } }
+    {}
+    ~thread_executor()
+    {
+        post(nullptr);
+        thread_.join();
+    }
+    void post(delegate<void()> task)
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        queue_.push_back(std::move(task));
+        cond_.notify_one();
+    }
+    std::thread::id id() const noexcept
+    {
+        return thread_.get_id();
+    }
+
+private:
+
+    void work()
+    {
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            cond_.wait(lock, [this] { return !queue_.empty(); });
+            auto task = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            if (!task) return;
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<delegate<void()>> queue_;
+    std::thread thread_;
+};
+
+// Executor that only collects posted delegates
+struct manual_executor
+{
+    void post(delegate<void()> task)
+    {
+        queue_.push_back(std::move(task));
+    }
+    void run()
+    {
+        while (!queue_.empty())
+        {
+            auto task = std::move(queue_.front());
+            queue_.pop_front();
+            task();
+        }
+    }
+    std::deque<delegate<void()>> queue_;
+};
+
+struct test_exception : std::runtime_error
+{
+    test_exception()
+        : std::runtime_error{ "test_exception" }
+    {}
+};
+
+// Executor that rejects posted delegates
+struct failing_executor
+{
+    void post(delegate<void()>)
+    {
+        throw test_exception{};
+    }
+};
+
+int function_answer()
+{
+    return 42;
+}
+
+using vdk::future;
+using vdk::invoke_async;
+
+} // namespace
+
+TEST(AsyncTest, Value)
+{
+    thread_executor executor;
+
+    auto result = invoke_async(executor, delegate<int()>{ function_answer });
+    EXPECT_TRUE(result.valid());
+    EXPECT_EQ(result.get(), 42);
+    EXPECT_FALSE(result.valid());
+
+    auto thread_id = invoke_async(executor, [] { return std::this_thread::get_id(); });
+    EXPECT_EQ(thread_id.get(), executor.id());
+}
+
+TEST(AsyncTest, Void)
+{
+    manual_executor executor;
+    int value = 0;
+
+    auto result = invoke_async(executor, [&value] { value = 10; });
+    EXPECT_FALSE(result.ready());
+    executor.run();
+    EXPECT_TRUE(result.ready());
+    result.get();
+    EXPECT_EQ(value, 10);
+}
+
+TEST(AsyncTest, MoveOnly)
+{
+    thread_executor executor;
+
+    auto data = std::make_unique<int>(5);
+    auto result = invoke_async(executor, [d = std::move(data)]() mutable
+    {
+        *d += 1;
+        return std::move(d);
+    });
+    auto value = result.get();
+    ASSERT_TRUE(value);
+    EXPECT_EQ(*value, 6);
+}
+
+TEST(AsyncTest, Exception)
+{
+    thread_executor executor;
+
+    auto result = invoke_async(executor, []() -> int { throw test_exception{}; });
+    EXPECT_THROW(result.get(), test_exception);
+}
+
+TEST(AsyncTest, Abandoned)
+{
+    future<int> result;
+    {
+        manual_executor executor;
+        result = invoke_async(executor, function_answer);
+        EXPECT_FALSE(result.ready());
+    }
+    EXPECT_TRUE(result.ready());
+
+    try
+    {
+        result.get();
+        FAIL();
+    }
+    catch (const std::future_error & error)
+    {
+        EXPECT_EQ(error.code(), std::future_errc::broken_promise);
+    }
+}
+
+TEST(AsyncTest, Then)
+{
+    thread_executor executor;
+
+    auto result = invoke_async(executor, function_answer)
+        .then([](int value) { return value + 1; })
+        .then(delegate<std::string(int)>{ [](int value) { return std::to_string(value); } })
+        .then([](std::string value) { return value + "!"; });
+    EXPECT_EQ(result.get(), std::string{ "43!" });
+
+    // Continuation of void operation
+    int value = 0;
+    auto result_void = invoke_async(executor, [&value] { value = 1; })
+        .then([&value] { return value * 10; });
+    EXPECT_EQ(result_void.get(), 10);
+}
+
+TEST(AsyncTest, ThenReady)
+{
+    manual_executor executor;
+
+    auto result = invoke_async(executor, function_answer);
+    executor.run();
+    ASSERT_TRUE(result.ready());
+
+    // Continuation runs immediately
+    auto next = std::move(result).then([](int value) { return value * 2; });
+    EXPECT_FALSE(result.valid());
+    EXPECT_TRUE(next.ready());
+    EXPECT_EQ(next.get(), 84);
+}
+
+TEST(AsyncTest, ThenException)
+{
+    manual_executor executor;
+    bool called = false;
+
+    auto result = invoke_async(executor, []() -> int { throw test_exception{}; })
+        .then([&called](int value) { called = true; return value; });
+    executor.run();
+    EXPECT_THROW(result.get(), test_exception);
+    EXPECT_FALSE(called);
+}
+
+TEST(AsyncTest, ThenExecutor)
+{
+    manual_executor executor1;
+    thread_executor executor2;
+
+    auto result = invoke_async(executor1, function_answer)
+        .then(executor2, [](int) { return std::this_thread::get_id(); });
+
+    EXPECT_FALSE(result.ready());
+    executor1.run();
+    EXPECT_EQ(result.get(), executor2.id());
+}
+
+TEST(AsyncTest, ThenExecutorFails)
+{
+    manual_executor executor1;
+    failing_executor executor2;
+    bool called = false;
+
+    auto result = invoke_async(executor1, function_answer)
+        .then(executor2, [&called](int value) { called = true; return value; });
+
+    executor1.run();
+    ASSERT_TRUE(result.ready());
+    EXPECT_THROW(result.get(), test_exception);
+    EXPECT_FALSE(called);
+}
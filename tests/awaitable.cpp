@@ -0,0 +1,136 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <tuple>
+#include <string>
+#include <cstddef>
+#include <utility>
+#include <exception>
+#include <coroutine>
+
+#include <gtest/gtest.h>
+#include <awaitable.h>
+
+namespace
+{
+using vdk::delegate;
+using vdk::awaitable;
+
+// Coroutine that starts eagerly and destroys itself on completion
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Callback-based asynchronous operations
+struct fake_socket
+{
+    void async_read(std::size_t size, delegate<void(int, std::size_t)> handler)
+    {
+        size_ = size;
+        read_handler_ = std::move(handler);
+    }
+    void async_close(delegate<void()> handler)
+    {
+        close_handler_ = std::move(handler);
+    }
+    void complete_read(int error)
+    {
+        auto handler = std::move(read_handler_);
+        handler(error, size_);
+    }
+    void complete_close()
+    {
+        auto handler = std::move(close_handler_);
+        handler();
+    }
+
+    std::size_t size_ = 0;
+    delegate<void(int, std::size_t)> read_handler_;
+    delegate<void()> close_handler_;
+};
+
+task read_twice(fake_socket & socket, int & error, std::size_t & total, bool & done)
+{
+    for (std::size_t size : { 10, 20 })
+    {
+        auto [ec, bytes] = co_await awaitable<void(int, std::size_t)>(
+            [&socket, size](delegate<void(int, std::size_t)> handler)
+            {
+                socket.async_read(size, std::move(handler));
+            });
+        error += ec;
+        total += bytes;
+    }
+
+    co_await awaitable<void()>([&socket](delegate<void()> handler)
+    {
+        socket.async_close(std::move(handler));
+    });
+    done = true;
+}
+
+} // namespace
+
+TEST(AwaitableTest, Deferred)
+{
+    fake_socket socket;
+    int error = 0;
+    std::size_t total = 0;
+    bool done = false;
+
+    read_twice(socket, error, total, done);
+    EXPECT_TRUE(socket.read_handler_);
+    EXPECT_EQ(total, 0u);
+
+    socket.complete_read(1);
+    EXPECT_EQ(error, 1);
+    EXPECT_EQ(total, 10u);
+    EXPECT_TRUE(socket.read_handler_);
+
+    socket.complete_read(2);
+    EXPECT_EQ(error, 3);
+    EXPECT_EQ(total, 30u);
+    EXPECT_FALSE(socket.read_handler_);
+    EXPECT_TRUE(socket.close_handler_);
+    EXPECT_FALSE(done);
+
+    socket.complete_close();
+    EXPECT_TRUE(done);
+}
+
+TEST(AwaitableTest, Immediate)
+{
+    bool done = false;
+
+    // Completion handler is invoked during initiation
+    [](bool & done) -> task
+    {
+        std::string value = co_await awaitable<void(const std::string &)>(
+            [](delegate<void(const std::string &)> handler)
+            {
+                handler("immediate");
+            });
+        EXPECT_EQ(value, std::string{ "immediate" });
+
+        auto result = co_await awaitable<void(int, std::string) noexcept>(
+            [](delegate<void(int, std::string) noexcept> handler)
+            {
+                handler(1, "noexcept");
+            });
+        EXPECT_EQ(result, std::make_tuple(1, std::string{ "noexcept" }));
+        done = true;
+    }(done);
+
+    EXPECT_TRUE(done);
+}
@@ -0,0 +1,155 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <string>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <bind_front.h>
+
+namespace
+{
+struct test_class
+{
+    int method(int arg1, int arg2) const
+    {
+        return value_ + arg1 + arg2;
+    }
+    int value_;
+};
+
+struct empty_functor
+{
+    int operator()(char a, double b, char c, int arg) const noexcept
+    {
+        return a + static_cast<int>(b) + c + arg;
+    }
+};
+
+struct ref_functor
+{
+    int operator()(int arg) & { return arg + 1; }
+    int operator()(int arg) const & { return arg + 2; }
+    int operator()(int arg) && { return arg + 3; }
+    int operator()(int arg) const && { return arg + 4; }
+};
+
+int function_sum(int arg1, int arg2, int arg3)
+{
+    return arg1 + arg2 + arg3;
+}
+
+using vdk::delegate;
+using vdk::bind_front;
+using vdk::internal::bind_front::bound_t;
+
+template<typename T>
+constexpr bool is_internal_v = vdk::internal::delegate::is_internal_v<T>;
+
+// Empty callable objects take no space
+static_assert(sizeof(bound_t<empty_functor, int>) == sizeof(int));
+
+// Bound values are laid out without padding
+static_assert(sizeof(bound_t<empty_functor, char, double, char>) ==
+              2 * sizeof(double));
+static_assert(is_internal_v<bound_t<int(*)(int, int, int), char, double, char>>);
+static_assert(!is_internal_v<std::tuple<int(*)(int, int, int), char, double, char>>);
+
+// Member function with object pointer fits into delegate
+static_assert(is_internal_v<bound_t<decltype(&test_class::method), test_class*>>);
+
+} // namespace
+
+TEST(BindFrontTest, Function)
+{
+    auto fn1 = bind_front<int(int)>(function_sum, 1, 2);
+    EXPECT_TRUE(fn1);
+    EXPECT_EQ(fn1(3), 6);
+
+    auto fn2 = bind_front<int(int, int, int)>(function_sum);
+    EXPECT_EQ(fn2(1, 2, 3), 6);
+
+    auto fn3 = bind_front<int()>(function_sum, 1, 2, 3);
+    EXPECT_EQ(fn3(), 6);
+}
+
+TEST(BindFrontTest, MemberFunction)
+{
+    test_class object{ 10 };
+
+    auto fn1 = bind_front<int(int)>(&test_class::method, &object, 1);
+    EXPECT_EQ(fn1(2), 13);
+
+    auto fn2 = bind_front<int(int, int)>(&test_class::method, std::cref(object));
+    EXPECT_EQ(fn2(1, 2), 13);
+
+    object.value_ = 20;
+    EXPECT_EQ(fn1(2), 23);
+    EXPECT_EQ(fn2(1, 2), 23);
+
+    auto fn3 = bind_front<int(int, int)>(&test_class::method, object);
+    object.value_ = 30;
+    EXPECT_EQ(fn3(1, 2), 23);
+}
+
+TEST(BindFrontTest, FunctionObject)
+{
+    auto fn1 = bind_front<int(int)>(empty_functor{}, 'a', 2.5, 'b');
+    EXPECT_EQ(fn1(1), 'a' + 2 + 'b' + 1);
+
+    auto fn2 = bind_front<int(int)>([](int arg1, int arg2) { return arg1 * arg2; }, 5);
+    EXPECT_EQ(fn2(6), 30);
+
+    delegate<int(int)&> fn3{ bind_front<int(int)&>(ref_functor{}) };
+    EXPECT_EQ(fn3(0), 1);
+    delegate<int(int)const&> fn4{ bind_front<int(int)const&>(ref_functor{}) };
+    EXPECT_EQ(fn4(0), 2);
+    delegate<int(int)&&> fn5{ bind_front<int(int)&&>(ref_functor{}) };
+    EXPECT_EQ(std::move(fn5)(0), 3);
+    delegate<int(int)const&&> fn6{ bind_front<int(int)const&&>(ref_functor{}) };
+    EXPECT_EQ(std::move(fn6)(0), 4);
+}
+
+TEST(BindFrontTest, MoveOnly)
+{
+    auto fn1 = bind_front<int(int)>(
+        [](const std::unique_ptr<int> & data, int arg) { return *data + arg; },
+        std::make_unique<int>(10));
+    EXPECT_EQ(fn1(5), 15);
+
+    auto fn2 = std::move(fn1);
+    EXPECT_FALSE(fn1);
+    EXPECT_EQ(fn2(6), 16);
+
+    // Bound values are moved into the target when invoked through &&
+    auto fn3 = bind_front<std::string()&&>(
+        [](std::string && arg) { return std::move(arg); }, std::string{ "text" });
+    EXPECT_EQ(std::move(fn3)(), std::string{ "text" });
+}
+
+TEST(BindFrontTest, Comparison)
+{
+    test_class object1{ 1 };
+    test_class object2{ 2 };
+
+    auto fn1 = bind_front<int(int)>(&test_class::method, &object1, 1);
+    auto fn2 = bind_front<int(int)>(&test_class::method, &object1, 1);
+    auto fn3 = bind_front<int(int)>(&test_class::method, &object2, 1);
+    auto fn4 = bind_front<int(int)>(&test_class::method, &object1, 2);
+    EXPECT_EQ(fn1, fn2);
+    EXPECT_NE(fn1, fn3);
+    EXPECT_NE(fn1, fn4);
+
+    // Lambdas are not comparable, so the bound objects are not either
+    double ballast = 2.0; // Prevent lambda from turning into function
+    auto lambda = [ballast](int arg1, int arg2) { return arg1 + arg2; };
+    auto fn5 = bind_front<int(int)>(lambda, 1);
+    auto fn6 = bind_front<int(int)>(lambda, 1);
+    EXPECT_NE(fn5, fn6);
+}
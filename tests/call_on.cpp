@@ -0,0 +1,133 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+#include <call_on.h>
+
+namespace
+{
+using vdk::delegate;
+
+// Thread that owns an inbox and serves calls until stopped
+class worker
+{
+public:
+
+    worker()
+        : thread_{ [this] { work(); } }
+    {
+        while (!inbox_.load())
+            std::this_thread::yield();
+    }
+    ~worker()
+    {
+        vdk::call_on(*inbox_.load(), [this] { stop_ = true; });
+        thread_.join();
+    }
+    vdk::thread_inbox & inbox() noexcept
+    {
+        return *inbox_.load();
+    }
+    std::thread::id id() const noexcept
+    {
+        return thread_.get_id();
+    }
+
+private:
+
+    void work()
+    {
+        vdk::thread_inbox inbox;
+        inbox_.store(&inbox);
+        while (!stop_)
+        {
+            inbox.wait();
+            inbox.drain();
+        }
+    }
+
+    std::atomic<vdk::thread_inbox*> inbox_{ nullptr };
+    bool stop_{};
+    std::thread thread_;
+};
+
+} // namespace
+
+TEST(CallOnTest, Results)
+{
+    worker w;
+
+    EXPECT_EQ(vdk::call_on(w.inbox(), delegate<int()>{ [] { return 42; } }), 42);
+
+    // Delegate lvalue is invoked in place and keeps its target
+    int calls = 0;
+    delegate<int()> counter{ [&calls] { return ++calls; } };
+    EXPECT_EQ(vdk::call_on(w.inbox(), counter), 1);
+    EXPECT_EQ(vdk::call_on(w.inbox(), counter), 2);
+    EXPECT_TRUE(counter);
+    EXPECT_EQ(vdk::call_on(w.inbox(), [] { return std::this_thread::get_id(); }), w.id());
+
+    // Result of move-only type and reference result
+    auto ptr = vdk::call_on(w.inbox(), [] { return std::make_unique<std::string>("text"); });
+    EXPECT_EQ(*ptr, "text");
+    int value = 0;
+    int & ref = vdk::call_on(w.inbox(), [&value]() -> int & { return value; });
+    EXPECT_EQ(&ref, &value);
+
+    // Large closure is not copied
+    std::array<int, 64> data{};
+    data[63] = 7;
+    int called = 0;
+    vdk::call_on(w.inbox(), [data, &called] { called = data[63]; });
+    EXPECT_EQ(called, 7);
+}
+
+TEST(CallOnTest, Exceptions)
+{
+    worker w;
+    EXPECT_THROW(vdk::call_on(w.inbox(), [] { throw std::runtime_error{ "failure" }; }),
+                 std::runtime_error);
+    EXPECT_EQ(vdk::call_on(w.inbox(), [] { return 1; }), 1);
+}
+
+TEST(CallOnTest, OwnerThread)
+{
+    // Call from the owner thread runs immediately
+    vdk::thread_inbox inbox;
+    EXPECT_TRUE(inbox.owned_by_this_thread());
+    EXPECT_EQ(vdk::call_on(inbox, [] { return 5; }), 5);
+    EXPECT_EQ(inbox.drain(), 0u);
+}
+
+TEST(CallOnTest, ManyCallers)
+{
+    worker w;
+    constexpr int callers = 4;
+    constexpr int calls = 2000;
+
+    // Calls are executed on the worker thread one at a time
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int c = 0; c < callers; ++c)
+    {
+        threads.emplace_back([&]
+        {
+            for (int i = 0; i < calls; ++i)
+                vdk::call_on(w.inbox(), [&counter] { return ++counter; });
+        });
+    }
+    for (auto & t : threads)
+        t.join();
+    EXPECT_EQ(vdk::call_on(w.inbox(), [&counter] { return counter; }), callers * calls);
+}
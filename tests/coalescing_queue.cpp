@@ -0,0 +1,151 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <vector>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+#include <bind_front.h>
+#include <coalescing_queue.h>
+
+namespace
+{
+using vdk::delegate;
+
+std::vector<int> log;
+
+void redraw_1() { log.push_back(1); }
+void redraw_2() { log.push_back(2); }
+
+struct widget
+{
+    void update() { ++updates_; }
+    int updates_{};
+};
+
+} // namespace
+
+TEST(CoalescingQueueTest, Coalesce)
+{
+    log.clear();
+    vdk::coalescing_queue<void()> queue;
+
+    EXPECT_TRUE(queue.post(redraw_1));
+    EXPECT_TRUE(queue.post(redraw_2));
+    EXPECT_FALSE(queue.post(redraw_1));
+    EXPECT_FALSE(queue.post(redraw_2));
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.coalesced(), 2u);
+
+    // Unique delegates run once, in order of their first post
+    EXPECT_EQ(queue.flush(), 2u);
+    EXPECT_EQ(log, (std::vector<int>{ 1, 2 }));
+    EXPECT_TRUE(queue.empty());
+
+    // Flushed delegates may be posted again
+    EXPECT_TRUE(queue.post(redraw_2));
+    EXPECT_EQ(queue.flush(), 1u);
+    EXPECT_EQ(log.back(), 2);
+}
+
+TEST(CoalescingQueueTest, BoundMembers)
+{
+    std::vector<widget> widgets(100);
+    vdk::coalescing_queue<void()> queue;
+
+    for (int round = 0; round < 10; ++round)
+        for (auto & w : widgets)
+            queue.post(vdk::bind_front<void()>(&widget::update, &w));
+    EXPECT_EQ(queue.size(), 100u);
+    EXPECT_EQ(queue.coalesced(), 900u);
+
+    queue.flush();
+    for (const auto & w : widgets)
+        EXPECT_EQ(w.updates_, 1);
+
+    // Lambdas are not comparable and are never coalesced
+    int calls = 0;
+    queue.post([&calls] { ++calls; });
+    queue.post([&calls] { ++calls; });
+    EXPECT_EQ(queue.flush(), 2u);
+    EXPECT_EQ(calls, 2);
+
+    queue.post(redraw_1);
+    queue.clear();
+    EXPECT_EQ(queue.flush(), 0u);
+}
+
+TEST(CoalescingQueueTest, Reentrancy)
+{
+    log.clear();
+    vdk::coalescing_queue<void(int)> queue;
+
+    // Delegate posted during flush runs in the next flush
+    queue.post([&queue](int frame)
+    {
+        log.push_back(frame);
+        queue.post([](int frame) { log.push_back(-frame); });
+    });
+    EXPECT_EQ(queue.flush(1), 1u);
+    EXPECT_EQ(queue.size(), 1u);
+    EXPECT_EQ(queue.flush(2), 1u);
+    EXPECT_EQ(log, (std::vector<int>{ 1, -2 }));
+}
+
+TEST(CoalescingQueueTest, Exceptions)
+{
+    log.clear();
+    vdk::coalescing_queue<void()> queue;
+
+    queue.post(redraw_1);
+    queue.post([] { throw std::runtime_error{ "failure" }; });
+    queue.post(redraw_2);
+
+    // Delegates after the failed one stay pending and are still coalesced
+    EXPECT_THROW(queue.flush(), std::runtime_error);
+    EXPECT_EQ(log, (std::vector<int>{ 1 }));
+    EXPECT_EQ(queue.size(), 1u);
+    EXPECT_FALSE(queue.post(redraw_2));
+    EXPECT_EQ(queue.flush(), 1u);
+    EXPECT_EQ(log, (std::vector<int>{ 1, 2 }));
+
+    // Rest of the batch keeps its place before delegates posted meanwhile
+    log.clear();
+    queue.post([&queue]
+    {
+        queue.post(redraw_1);
+        queue.post(redraw_2);
+        throw std::runtime_error{ "failure" };
+    });
+    queue.post(redraw_2);
+    EXPECT_THROW(queue.flush(), std::runtime_error);
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.flush(), 2u);
+    EXPECT_EQ(log, (std::vector<int>{ 2, 1 }));
+}
+
+TEST(CoalescingQueueTest, ExceptionsLargeBatch)
+{
+    std::vector<widget> widgets(100);
+    vdk::coalescing_queue<void()> queue;
+
+    // Re-posting needs a larger index than the one left by the batch
+    queue.post([&]
+    {
+        for (auto & w : widgets)
+            queue.post(vdk::bind_front<void()>(&widget::update, &w));
+        throw std::runtime_error{ "failure" };
+    });
+    for (std::size_t i = 0; i < 50; ++i)
+        queue.post(vdk::bind_front<void()>(&widget::update, &widgets[i]));
+    EXPECT_THROW(queue.flush(), std::runtime_error);
+    EXPECT_EQ(queue.size(), 100u);
+
+    EXPECT_FALSE(queue.post(vdk::bind_front<void()>(&widget::update, &widgets[70])));
+    EXPECT_EQ(queue.flush(), 100u);
+    for (const auto & w : widgets)
+        EXPECT_EQ(w.updates_, 1);
+}
@@ -0,0 +1,156 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <string>
+#include <memory>
+#include <utility>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <compose.h>
+
+namespace
+{
+int twice(int value) noexcept
+{
+    return value * 2;
+}
+
+struct increment
+{
+    int operator()(int value) const noexcept { return value + 1; }
+
+    bool operator==(const increment &) const noexcept { return true; }
+};
+
+std::optional<int> parse(std::string_view text)
+{
+    if (text.empty() || text.size() > 9)
+        return std::nullopt;
+    int value = 0;
+    for (char c : text)
+    {
+        if (c < '0' || c > '9')
+            return std::nullopt;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+std::optional<int> validate(int value)
+{
+    if (value > 1000)
+        return std::nullopt;
+    return value;
+}
+
+std::string route(int value)
+{
+    return value % 2 ? "odd" : "even";
+}
+
+} // namespace
+
+TEST(ComposeTest, Stages)
+{
+    auto f = vdk::compose(twice, increment{}, [](int value) { return value * 10; });
+    static_assert(std::is_same_v<decltype(f(1)), int>);
+    EXPECT_EQ(f(1), 30);
+    EXPECT_EQ(f(5), 110);
+
+    const auto & cf = f;
+    EXPECT_EQ(cf(2), 50);
+
+    auto single = vdk::compose(increment{});
+    EXPECT_EQ(single(41), 42);
+}
+
+TEST(ComposeTest, EmptyStages)
+{
+    // Stateless stages take no space
+    auto f = vdk::compose([](int v) { return v + 1; }, increment{},
+                          [](int v) { return v + 1; });
+    EXPECT_EQ(sizeof(f), 1u);
+    EXPECT_EQ(f(0), 3);
+
+    // Stages are laid out without padding
+    long long a = 1;
+    char b = 2;
+    auto g = vdk::compose([b](int v) { return v + b; }, [a](int v) { return v + a; },
+                          [b](long long v) { return v * b; });
+    EXPECT_EQ(sizeof(g), sizeof(long long) + 2 * sizeof(char) + 6);
+    EXPECT_EQ(g(1), 8);
+}
+
+TEST(ComposeTest, ShortCircuit)
+{
+    auto f = vdk::compose(parse, validate, route);
+    static_assert(std::is_same_v<decltype(f("1")), std::optional<std::string>>);
+
+    EXPECT_EQ(f("42"), std::optional<std::string>{ "even" });
+    EXPECT_EQ(f("7"), std::optional<std::string>{ "odd" });
+    EXPECT_EQ(f("x"), std::nullopt);
+    EXPECT_EQ(f("5000"), std::nullopt);
+
+    // Stage that accepts optional receives it as is
+    auto g = vdk::compose(parse, [](std::optional<int> value) { return value.has_value(); });
+    static_assert(std::is_same_v<decltype(g("1")), bool>);
+    EXPECT_TRUE(g("1"));
+    EXPECT_FALSE(g("-"));
+
+    // Stage that returns optional at the end is not wrapped again
+    auto h = vdk::compose(parse, validate);
+    static_assert(std::is_same_v<decltype(h("1")), std::optional<int>>);
+    EXPECT_EQ(h("12"), 12);
+}
+
+TEST(ComposeTest, VoidStages)
+{
+    int seen = 0;
+    int calls = 0;
+    auto f = vdk::compose([&seen](int value) { seen = value; },
+                          [&calls] { ++calls; return calls * 100; },
+                          [&calls](int value) { calls += value; });
+    static_assert(std::is_void_v<decltype(f(1))>);
+    f(7);
+    EXPECT_EQ(seen, 7);
+    EXPECT_EQ(calls, 101);
+
+    auto g = vdk::compose(parse, [&seen](int value) { seen = value; });
+    static_assert(std::is_void_v<decltype(g("1"))>);
+    g("x");
+    EXPECT_EQ(seen, 7);
+    g("9");
+    EXPECT_EQ(seen, 9);
+}
+
+TEST(ComposeTest, MoveOnly)
+{
+    auto ptr = std::make_unique<int>(5);
+    auto f = vdk::compose([ptr = std::move(ptr)](int value) { return value + *ptr; },
+                          [](int value) { return std::make_unique<int>(value); },
+                          [](std::unique_ptr<int> p) { return *p * 2; });
+    EXPECT_EQ(f(1), 12);
+
+    auto g = std::move(f);
+    EXPECT_EQ(g(2), 14);
+}
+
+TEST(ComposeTest, Pipeline)
+{
+    auto p = vdk::pipeline<std::optional<std::string>(std::string_view)>(parse, validate, route);
+    EXPECT_EQ(p("10"), std::optional<std::string>{ "even" });
+    EXPECT_EQ(p("abc"), std::nullopt);
+
+    vdk::delegate<int(int) const> d = vdk::compose(twice, increment{});
+    EXPECT_EQ(d(3), 7);
+
+    vdk::delegate<int(int)> e1 = vdk::compose(increment{}, increment{});
+    vdk::delegate<int(int)> e2 = vdk::compose(increment{}, increment{});
+    EXPECT_TRUE(e1 == e2);
+}
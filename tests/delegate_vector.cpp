@@ -0,0 +1,184 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+#include <delegate_vector.h>
+
+namespace
+{
+int live_targets = 0;
+bool throw_on_move = false;
+
+// Target that is too big for delegate's buffer; records its address when invoked
+struct large
+{
+    large(int value) noexcept : value_{ value } { ++live_targets; }
+    large(const large & other) noexcept : value_{ other.value_ } { ++live_targets; }
+    ~large() noexcept { --live_targets; }
+
+    int operator()(std::vector<const void*> & log) const
+    {
+        log.push_back(this);
+        return value_;
+    }
+
+    int value_;
+    std::array<std::uint64_t, 6> state_{};
+};
+
+// Target with throwing move operation
+struct fragile
+{
+    fragile(int value) noexcept : value_{ value } { ++live_targets; }
+    fragile(fragile && other) : value_{ other.value_ }
+    {
+        if (throw_on_move)
+            throw std::runtime_error{ "move" };
+        ++live_targets;
+    }
+    ~fragile() noexcept { --live_targets; }
+
+    int operator()(std::vector<const void*> &) const { return value_; }
+
+    int value_;
+};
+
+int small(std::vector<const void*> &) { return -1; }
+
+using vector_t = vdk::delegate_vector<int(std::vector<const void*> &)>;
+
+} // namespace
+
+TEST(DelegateVectorTest, PushAndInvoke)
+{
+    std::vector<const void*> log;
+    {
+        vector_t v;
+        EXPECT_TRUE(v.empty());
+
+        v.push_back(&small);
+        v.push_back(static_cast<int(*)(std::vector<const void*> &)>(nullptr));
+        v.push_back([](std::vector<const void*> &) { return 7; });
+        for (int i = 0; i < 4; ++i)
+            v.push_back(large{ i });
+        EXPECT_EQ(v.size(), 6u);
+        EXPECT_EQ(live_targets, 4);
+        EXPECT_EQ(v.reclaimable(), 0u);
+
+        EXPECT_EQ(v.invoke(0, log), -1);
+        EXPECT_EQ(v.invoke(1, log), 7);
+        EXPECT_EQ(v.invoke(3, log), 1);
+
+        // Targets kept in arena are adjacent in insertion order
+        log.clear();
+        v.invoke_all(log);
+        ASSERT_EQ(log.size(), 4u);
+        for (std::size_t i = 1; i < log.size(); ++i)
+            EXPECT_EQ(static_cast<const char*>(log[i]) -
+                      static_cast<const char*>(log[i - 1]),
+                      static_cast<std::ptrdiff_t>(sizeof(large)));
+
+        auto other = std::move(v);
+        EXPECT_TRUE(v.empty());
+        EXPECT_EQ(other.size(), 6u);
+        EXPECT_EQ(other.invoke(5, log), 3);
+
+        v = std::move(other);
+        EXPECT_EQ(v.invoke(5, log), 3);
+        EXPECT_EQ(live_targets, 4);
+    }
+    EXPECT_EQ(live_targets, 0);
+}
+
+TEST(DelegateVectorTest, EraseAndCompact)
+{
+    std::vector<const void*> log;
+    {
+        vector_t v;
+        for (int i = 0; i < 1000; ++i)
+        {
+            if (i % 10 == 0)
+                v.push_back(&small);
+            else
+                v.push_back(large{ i });
+        }
+        EXPECT_EQ(live_targets, 900);
+
+        // Erase every other element; order of the rest is kept
+        for (std::size_t i = v.size() / 2; i-- > 0;)
+            v.erase(i * 2 + 1);
+        v.pop_back();
+        EXPECT_EQ(v.size(), 499u);
+        EXPECT_EQ(live_targets, 399);
+        EXPECT_EQ(v.reclaimable(), 501 * sizeof(large));
+
+        std::vector<int> before;
+        for (std::size_t i = 0; i < v.size(); ++i)
+            before.push_back(v.invoke(i, log));
+
+        v.compact();
+        EXPECT_EQ(v.reclaimable(), 0u);
+        EXPECT_EQ(live_targets, 399);
+
+        std::vector<int> after;
+        for (std::size_t i = 0; i < v.size(); ++i)
+            after.push_back(v.invoke(i, log));
+        EXPECT_EQ(before, after);
+
+        log.clear();
+        v.invoke_all(log);
+        ASSERT_EQ(log.size(), 399u);
+        for (std::size_t i = 1; i < log.size(); ++i)
+            EXPECT_EQ(static_cast<const char*>(log[i]) -
+                      static_cast<const char*>(log[i - 1]),
+                      static_cast<std::ptrdiff_t>(sizeof(large)));
+
+        v.clear();
+        EXPECT_TRUE(v.empty());
+        EXPECT_EQ(live_targets, 0);
+        v.push_back(large{ 5 });
+        EXPECT_EQ(v.invoke(0, log), 5);
+    }
+    EXPECT_EQ(live_targets, 0);
+}
+
+TEST(DelegateVectorTest, Exceptions)
+{
+    std::vector<const void*> log;
+    {
+        vector_t v;
+        for (int i = 0; i < 4; ++i)
+            v.push_back(fragile{ i });
+        EXPECT_EQ(live_targets, 4);
+
+        // Failed construction leaves the vector unchanged
+        throw_on_move = true;
+        EXPECT_THROW(v.push_back(fragile{ 4 }), std::runtime_error);
+        EXPECT_EQ(v.size(), 4u);
+        EXPECT_EQ(live_targets, 4);
+
+        // Failed compaction keeps all targets usable
+        v.erase(0);
+        EXPECT_THROW(v.compact(), std::runtime_error);
+        throw_on_move = false;
+        EXPECT_EQ(v.size(), 3u);
+        EXPECT_EQ(live_targets, 3);
+        for (std::size_t i = 0; i < v.size(); ++i)
+            EXPECT_EQ(v.invoke(i, log), static_cast<int>(i) + 1);
+
+        v.compact();
+        EXPECT_EQ(v.reclaimable(), 0u);
+        for (std::size_t i = 0; i < v.size(); ++i)
+            EXPECT_EQ(v.invoke(i, log), static_cast<int>(i) + 1);
+    }
+    EXPECT_EQ(live_targets, 0);
+}
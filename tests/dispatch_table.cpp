@@ -0,0 +1,221 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <dispatch_table.h>
+#include <static_delegate.h>
+
+namespace
+{
+struct context
+{
+    int acc = 0;
+};
+
+void op_increment(context & ctx)
+{
+    ctx.acc += 1;
+}
+
+void op_double(context & ctx)
+{
+    ctx.acc *= 2;
+}
+
+struct op_add
+{
+    void operator()(context & ctx) const
+    {
+        ctx.acc += value_;
+    }
+    bool operator==(const op_add & other) const noexcept
+    {
+        return value_ == other.value_;
+    }
+    int value_;
+};
+
+// Target that does not fit into internal buffer
+struct op_add_large : op_add
+{
+    char padding_[64];
+};
+
+int function_overload(int arg)
+{
+    return arg;
+}
+
+std::string function_overload(std::string arg)
+{
+    return arg;
+}
+
+using vdk::dispatch_table;
+
+} // namespace
+
+TEST(DispatchTableTest, Empty)
+{
+    dispatch_table<void(context&), 16> table;
+    static_assert(decltype(table)::size() == 16);
+
+    for (std::size_t index = 0; index < table.size(); ++index)
+    {
+        EXPECT_FALSE(table.contains(index));
+        EXPECT_FALSE(table[index]);
+    }
+}
+
+TEST(DispatchTableTest, Assign)
+{
+    context ctx;
+    dispatch_table<void(context&), 8> table;
+
+    table.assign(0, op_increment);
+    table.assign(1, op_add{ 10 });
+    table.assign(2, op_add_large{ { 100 }, {} });
+    table[3] = op_double;
+    table[4] = [](context & ctx) { ctx.acc = 0; };
+
+    for (std::size_t index = 0; index < 5; ++index)
+        EXPECT_TRUE(table.contains(index));
+    EXPECT_FALSE(table.contains(5));
+
+    table[0](ctx);
+    EXPECT_EQ(ctx.acc, 1);
+    table[1](ctx);
+    EXPECT_EQ(ctx.acc, 11);
+    table[2](ctx);
+    EXPECT_EQ(ctx.acc, 111);
+    table[3](ctx);
+    EXPECT_EQ(ctx.acc, 222);
+    table[4](ctx);
+    EXPECT_EQ(ctx.acc, 0);
+
+    // Null function pointer leaves the entry unchanged
+    void(*func_ptr_null)(context&) = nullptr;
+    table.assign(0, func_ptr_null);
+    EXPECT_TRUE(table.contains(0));
+
+    // Reassignment destroys the previous target
+    auto data = std::make_shared<int>(5);
+    table[5] = [data](context & ctx) { ctx.acc += *data; };
+    EXPECT_EQ(data.use_count(), 2);
+    table[5] = op_increment;
+    EXPECT_EQ(data.use_count(), 1);
+    table[5](ctx);
+    EXPECT_EQ(ctx.acc, 1);
+}
+
+TEST(DispatchTableTest, BulkAssign)
+{
+    context ctx;
+    dispatch_table<void(context&), 256> table;
+
+    // Default handler for every entry
+    table.fill(op_add{ 1 });
+    for (std::size_t index = 0; index < table.size(); ++index)
+        table[index](ctx);
+    EXPECT_EQ(ctx.acc, 256);
+
+    // Consecutive handlers from a compile-time table
+    static constexpr vdk::static_delegate<void(context&)> handlers[] =
+    {
+        op_increment, op_double, [](context & ctx) { ctx.acc = -1; }
+    };
+    table.assign(10, std::begin(handlers), std::end(handlers));
+
+    ctx.acc = 0;
+    table[10](ctx);
+    table[11](ctx);
+    EXPECT_EQ(ctx.acc, 2);
+    table[12](ctx);
+    EXPECT_EQ(ctx.acc, -1);
+    table[13](ctx);
+    EXPECT_EQ(ctx.acc, 0);
+}
+
+TEST(DispatchTableTest, Reset)
+{
+    auto data = std::make_shared<int>(1);
+    dispatch_table<int(int), 4> table;
+
+    table[0] = [data](int arg) { return arg + *data; };
+    table[1] = [data](int arg) { return arg - *data; };
+    EXPECT_EQ(data.use_count(), 3);
+    EXPECT_EQ(table[0](10), 11);
+    EXPECT_EQ(table[1](10), 9);
+
+    table.reset(0);
+    EXPECT_FALSE(table.contains(0));
+    EXPECT_EQ(data.use_count(), 2);
+
+    table.clear();
+    EXPECT_FALSE(table.contains(1));
+    EXPECT_EQ(data.use_count(), 1);
+
+    {
+        dispatch_table<int(int), 4> other;
+        other.fill([data](int arg) { return arg * *data; });
+        EXPECT_EQ(data.use_count(), 5);
+    }
+    EXPECT_EQ(data.use_count(), 1);
+}
+
+// Target whose move may throw, so it is stored on the heap
+struct throwing_move
+{
+    throwing_move() = default;
+    throwing_move(const throwing_move &) = default;
+    throwing_move(throwing_move &&) { throw std::runtime_error{ "move" }; }
+
+    int operator()(int arg) const { return arg; }
+};
+
+TEST(DispatchTableTest, AssignFailure)
+{
+    dispatch_table<int(int), 2> table;
+    table[0] = [](int arg) { return arg + 1; };
+
+    // Entry keeps its previous target if the new one cannot be stored
+    const throwing_move target;
+    EXPECT_THROW(table.assign(0, target), std::runtime_error);
+    EXPECT_TRUE(table.contains(0));
+    EXPECT_EQ(table[0](1), 2);
+}
+
+TEST(DispatchTableTest, Signatures)
+{
+    dispatch_table<int(int)noexcept, 2> table1;
+    table1[0] = [](int arg) noexcept { return arg * 3; };
+    static_assert(noexcept(table1[0](1)));
+    EXPECT_EQ(table1[0](3), 9);
+
+    dispatch_table<std::string(std::string), 2> table2;
+    table2.assign(0, function_overload);
+    EXPECT_EQ(table2[0]("text"), std::string{ "text" });
+    dispatch_table<int(int), 2> table5;
+    table5.assign(1, function_overload);
+    EXPECT_EQ(table5[1](5), 5);
+
+    dispatch_table<int(std::unique_ptr<int>), 2> table3;
+    table3[1] = [](std::unique_ptr<int> arg) { return *arg; };
+    EXPECT_EQ(table3[1](std::make_unique<int>(42)), 42);
+
+    int arg = 7;
+    dispatch_table<void(int&), 1> table4;
+    table4[0] = [](int & arg) { ++arg; };
+    table4.prefetch(0);
+    table4[0](arg);
+    EXPECT_EQ(arg, 8);
+}
@@ -0,0 +1,218 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+#include <event_bus.h>
+
+namespace
+{
+struct ping { int id_; };
+struct text { std::string value_; };
+struct tick {};
+
+struct listener : vdk::trackable
+{
+    void on_ping(const ping & e) noexcept { sum_ += e.id_; }
+
+    int sum_{};
+};
+
+using bus_t = vdk::event_bus<ping, text, tick>;
+
+} // namespace
+
+TEST(EventBusTest, Publish)
+{
+    bus_t bus;
+    std::vector<std::string> log;
+
+    auto s1 = bus.subscribe<ping>([&log](const ping & e) { log.push_back("a" + std::to_string(e.id_)); });
+    auto s2 = bus.subscribe<ping>([&log](const ping & e) { log.push_back("b" + std::to_string(e.id_)); });
+    auto s3 = bus.subscribe<text>([&log](const text & e) { log.push_back(e.value_); });
+    EXPECT_TRUE(s1);
+    EXPECT_NE(s1, s2);
+    EXPECT_EQ(bus.subscribers<ping>(), 2u);
+    EXPECT_EQ(bus.subscribers<tick>(), 0u);
+
+    bus.publish(ping{ 1 });
+    bus.publish(text{ "x" });
+    bus.publish(tick{});
+    EXPECT_EQ(log, (std::vector<std::string>{ "a1", "b1", "x" }));
+
+    EXPECT_TRUE(bus.unsubscribe(s1));
+    EXPECT_FALSE(bus.unsubscribe(s1));
+    EXPECT_FALSE(bus.unsubscribe(bus_t::subscription{}));
+    EXPECT_FALSE(bus.subscribe<tick>(nullptr));
+
+    log.clear();
+    bus.publish(ping{ 2 });
+    EXPECT_EQ(log, (std::vector<std::string>{ "b2" }));
+    EXPECT_TRUE(bus.unsubscribe(s3));
+    EXPECT_TRUE(bus.unsubscribe(s2));
+}
+
+TEST(EventBusTest, ChangesDuringPublish)
+{
+    bus_t bus;
+    std::vector<int> log;
+    bus_t::subscription self;
+    bus_t::subscription other;
+
+    self = bus.subscribe<ping>([&](const ping & e)
+    {
+        log.push_back(e.id_);
+        // Removes itself and the next subscriber, adds a new one
+        bus.unsubscribe(self);
+        bus.unsubscribe(other);
+        bus.subscribe<ping>([&log](const ping & e) { log.push_back(e.id_ * 100); });
+    });
+    other = bus.subscribe<ping>([&log](const ping & e) { log.push_back(-e.id_); });
+
+    bus.publish(ping{ 1 });
+    EXPECT_EQ(log, (std::vector<int>{ 1 }));
+    EXPECT_EQ(bus.subscribers<ping>(), 1u);
+
+    bus.publish(ping{ 2 });
+    EXPECT_EQ(log, (std::vector<int>{ 1, 200 }));
+
+    // Subscription made during publishing can be cancelled before it takes effect
+    auto late = bus.subscribe<text>([&](const text &)
+    {
+        auto s = bus.subscribe<text>([&log](const text &) { log.push_back(-1); });
+        EXPECT_TRUE(bus.unsubscribe(s));
+    });
+    bus.publish(text{});
+    bus.publish(text{});
+    EXPECT_EQ(log, (std::vector<int>{ 1, 200 }));
+    EXPECT_EQ(bus.subscribers<text>(), 1u);
+    EXPECT_TRUE(bus.unsubscribe(late));
+}
+
+TEST(EventBusTest, Queued)
+{
+    bus_t bus;
+    std::vector<std::string> log;
+    bus.subscribe<ping>([&log](const ping & e) { log.push_back("p" + std::to_string(e.id_)); });
+    bus.subscribe<text>([&](const text & e)
+    {
+        log.push_back(e.value_);
+        if (e.value_ == "again")
+            bus.enqueue(ping{ 9 });
+    });
+
+    bus.enqueue(ping{ 1 });
+    bus.enqueue(text{ "a" });
+    bus.enqueue(ping{ 2 });
+    text t{ "again" };
+    bus.enqueue(t);
+    bus.enqueue(tick{});
+    EXPECT_EQ(bus.queued(), 5u);
+    EXPECT_TRUE(log.empty());
+
+    // Events are delivered grouped by type in order of first enqueue
+    EXPECT_EQ(bus.dispatch(), 5u);
+    EXPECT_EQ(log, (std::vector<std::string>{ "p1", "p2", "a", "again" }));
+    EXPECT_EQ(bus.queued(), 1u);
+
+    EXPECT_EQ(bus.dispatch(), 1u);
+    EXPECT_EQ(log.back(), "p9");
+    EXPECT_EQ(bus.dispatch(), 0u);
+}
+
+TEST(EventBusTest, Exceptions)
+{
+    bus_t bus;
+    int delivered = 0;
+    bus.subscribe<ping>([&delivered](const ping & e)
+    {
+        if (e.id_ == 2)
+            throw std::runtime_error{ "failure" };
+        ++delivered;
+    });
+    bus.subscribe<tick>([&delivered](const tick &) { ++delivered; });
+
+    EXPECT_THROW(bus.publish(ping{ 2 }), std::runtime_error);
+    bus.publish(ping{ 1 });
+    EXPECT_EQ(delivered, 1);
+
+    // Rest of the failed batch stays queued ahead of later events
+    bus.enqueue(ping{ 2 });
+    bus.enqueue(ping{ 3 });
+    bus.enqueue(tick{});
+    EXPECT_THROW(bus.dispatch(), std::runtime_error);
+    EXPECT_EQ(bus.queued(), 2u);
+    EXPECT_EQ(delivered, 1);
+
+    std::vector<int> order;
+    bus.subscribe<ping>([&order](const ping & e) { order.push_back(e.id_); });
+    bus.enqueue(ping{ 4 });
+    EXPECT_EQ(bus.dispatch(), 3u);
+    EXPECT_EQ(delivered, 4);
+    EXPECT_EQ(order, (std::vector<int>{ 3, 4 }));
+    EXPECT_EQ(bus.queued(), 0u);
+    EXPECT_EQ(bus.dispatch(), 0u);
+}
+
+TEST(EventBusTest, SubscribeInThrowingPublish)
+{
+    bus_t bus;
+    std::vector<int> calls;
+    bus_t::subscription added;
+    bus.subscribe<ping>([&](const ping & e)
+    {
+        if (e.id_ != 1)
+            return;
+        added = bus.subscribe<ping>([&calls](const ping &) { calls.push_back(1); });
+        throw std::runtime_error{ "failure" };
+    });
+
+    // Subscription made by the throwing subscriber is kept in order
+    EXPECT_THROW(bus.publish(ping{ 1 }), std::runtime_error);
+    auto later = bus.subscribe<ping>([&calls](const ping &) { calls.push_back(2); });
+    EXPECT_EQ(bus.subscribers<ping>(), 3u);
+
+    bus.publish(ping{ 2 });
+    EXPECT_EQ(calls, (std::vector<int>{ 1, 2 }));
+
+    EXPECT_TRUE(bus.unsubscribe(added));
+    EXPECT_FALSE(bus.unsubscribe(added));
+    EXPECT_TRUE(bus.unsubscribe(later));
+    EXPECT_EQ(bus.subscribers<ping>(), 1u);
+
+    calls.clear();
+    bus.publish(ping{ 2 });
+    EXPECT_TRUE(calls.empty());
+}
+
+TEST(EventBusTest, WeakSubscribers)
+{
+    bus_t bus;
+    int sum = 0;
+    bus.subscribe<ping>([&sum](const ping & e) { sum += e.id_; });
+
+    auto a = std::make_unique<listener>();
+    listener b;
+    bus.subscribe<ping>(vdk::weak_bind<&listener::on_ping>(*a));
+    bus.subscribe<ping>(vdk::weak_bind<&listener::on_ping>(b));
+    EXPECT_EQ(bus.subscribers<ping>(), 3u);
+
+    bus.publish(ping{ 1 });
+    EXPECT_EQ(a->sum_, 1);
+    EXPECT_EQ(b.sum_, 1);
+
+    // Subscriber of destroyed object is removed by the next publishing
+    a.reset();
+    EXPECT_EQ(bus.subscribers<ping>(), 2u);
+    bus.publish(ping{ 2 });
+    EXPECT_EQ(b.sum_, 3);
+    EXPECT_EQ(sum, 3);
+}
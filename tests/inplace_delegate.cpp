@@ -0,0 +1,159 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <inplace_delegate.h>
+
+namespace
+{
+int add_one(int value) noexcept
+{
+    return value + 1;
+}
+
+// Functor that counts its live instances
+struct counted
+{
+    explicit counted(int * live) noexcept : live_{ live } { ++*live_; }
+    counted(const counted & other) noexcept : live_{ other.live_ } { ++*live_; }
+    counted(counted && other) noexcept : live_{ other.live_ } { ++*live_; }
+    ~counted() noexcept { --*live_; }
+
+    int operator()(int value) const noexcept { return value * 2; }
+
+    int * live_;
+};
+
+// Functor larger than delegate's internal buffer
+struct large
+{
+    int operator()(int value) const noexcept { return value + data_[7]; }
+
+    bool operator==(const large & other) const noexcept
+    {
+        return data_ == other.data_;
+    }
+
+    std::array<long long, 8> data_{};
+};
+
+} // namespace
+
+static_assert(std::is_nothrow_move_constructible_v<vdk::inplace_delegate<int(int)>>);
+static_assert(std::is_nothrow_move_assignable_v<vdk::inplace_delegate<int(int)>>);
+static_assert(std::is_nothrow_constructible_v<vdk::inplace_delegate<int(int), 64>, large>);
+static_assert(!std::is_copy_constructible_v<vdk::inplace_delegate<int(int)>>);
+static_assert(sizeof(vdk::inplace_delegate<int(int)>) == sizeof(vdk::delegate<int(int)>));
+static_assert(vdk::inplace_delegate<int(int), 64>::capacity() == 64);
+
+TEST(InplaceDelegateTest, Empty)
+{
+    vdk::inplace_delegate<int(int)> d1;
+    vdk::inplace_delegate<int(int)> d2{ nullptr };
+    vdk::inplace_delegate<int(int)> d3{ static_cast<int(*)(int)>(nullptr) };
+    EXPECT_FALSE(d1);
+    EXPECT_FALSE(d2);
+    EXPECT_FALSE(d3);
+    EXPECT_TRUE(d1 == nullptr);
+    EXPECT_TRUE(nullptr == d2);
+    EXPECT_TRUE(d1 == d2);
+}
+
+TEST(InplaceDelegateTest, Function)
+{
+    vdk::inplace_delegate<int(int)> d1{ add_one };
+    EXPECT_TRUE(d1);
+    EXPECT_EQ(d1(1), 2);
+
+    vdk::inplace_delegate<int(int)> d2{ add_one };
+    EXPECT_TRUE(d1 == d2);
+
+    d2 = nullptr;
+    EXPECT_FALSE(d2);
+    d2 = &add_one;
+    EXPECT_EQ(d2(2), 3);
+}
+
+TEST(InplaceDelegateTest, Functor)
+{
+    int live = 0;
+    {
+        vdk::inplace_delegate<int(int) const noexcept> d1{ counted{ &live } };
+        EXPECT_EQ(live, 1);
+        EXPECT_EQ(d1(21), 42);
+
+        auto d2 = std::move(d1);
+        EXPECT_FALSE(d1);
+        EXPECT_TRUE(d2);
+        EXPECT_EQ(d2(4), 8);
+
+        EXPECT_EQ(live, 1);
+        d2 = add_one;
+        EXPECT_EQ(live, 0);
+        EXPECT_EQ(d2(4), 5);
+
+        d1 = counted{ &live };
+        EXPECT_EQ(d1(5), 10);
+        d1 = nullptr;
+    }
+    EXPECT_EQ(live, 0);
+}
+
+TEST(InplaceDelegateTest, LargeCapacity)
+{
+    large target;
+    target.data_[7] = 100;
+
+    vdk::inplace_delegate<int(int), sizeof(large), alignof(large)> d1{ target };
+    EXPECT_EQ(d1(1), 101);
+
+    vdk::inplace_delegate<int(int), sizeof(large), alignof(large)> d2{ target };
+    EXPECT_TRUE(d1 == d2);
+
+    auto d3 = std::move(d1);
+    EXPECT_EQ(d3(2), 102);
+    EXPECT_TRUE(d3 == d2);
+
+    auto ptr = std::make_unique<int>(7);
+    vdk::inplace_delegate<int(int) &&, 80> d4{ [ptr = std::move(ptr), target](int value)
+    {
+        return value + *ptr + target.data_[7];
+    }};
+    EXPECT_EQ(std::move(d4)(1), 108);
+}
+
+TEST(InplaceDelegateTest, SmallCapacity)
+{
+    // Buffer that holds exactly one function pointer
+    using fn_t = int(*)(int);
+    vdk::inplace_delegate<int(int), sizeof(fn_t), alignof(fn_t)> d1{ &add_one };
+    EXPECT_EQ(d1(1), 2);
+
+    d1 = &add_one;
+    auto d2 = std::move(d1);
+    EXPECT_EQ(d2(2), 3);
+}
+
+TEST(InplaceDelegateTest, Compare)
+{
+    int a = 1, b = 2;
+    auto lambda = [&a](int value) { return value + a; };
+
+    vdk::inplace_delegate<int(int)> d1{ lambda };
+    vdk::inplace_delegate<int(int)> d2{ lambda };
+    vdk::inplace_delegate<int(int)> d3{ [&b](int value) { return value + b; } };
+
+    // Lambdas are not equality comparable
+    EXPECT_FALSE(d1 == d2);
+    EXPECT_TRUE(d1 != d3);
+    EXPECT_EQ(d1(1), 2);
+    EXPECT_EQ(d3(1), 3);
+}
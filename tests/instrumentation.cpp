@@ -0,0 +1,261 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+
+#include <gtest/gtest.h>
+#include <delegate.h>
+#include <dispatch_table.h>
+
+#if !defined(VDK_DELEGATE_INSTRUMENTATION)
+#error "instrumentation tests must be compiled with VDK_DELEGATE_INSTRUMENTATION"
+#endif
+
+namespace
+{
+struct cheap_handler
+{
+    int operator()(int value) const noexcept { return value + 1; }
+};
+
+struct expensive_handler
+{
+    int operator()(int value) const
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds{ 200 });
+        return value - 1;
+    }
+};
+
+int free_function(int value)
+{
+    return value * 2;
+}
+
+const vdk::instrumentation::record * find(
+    const std::vector<vdk::instrumentation::record> & records, std::string_view name)
+{
+    for (const auto & r : records)
+        if (r.name_.find(name) != std::string_view::npos)
+            return &r;
+    return nullptr;
+}
+
+} // namespace
+
+TEST(InstrumentationTest, TypeName)
+{
+    using vdk::internal::instrumentation::type_name;
+    EXPECT_EQ(type_name<int>(), "int");
+    EXPECT_NE(type_name<cheap_handler>().find("cheap_handler"), std::string_view::npos);
+}
+
+TEST(InstrumentationTest, Counters)
+{
+    vdk::instrumentation::reset();
+
+    vdk::delegate<int(int)> cheap{ cheap_handler{} };
+    vdk::delegate<int(int)> expensive{ expensive_handler{} };
+    vdk::delegate<int(int)> function{ free_function };
+
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(cheap(i), i + 1);
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ(expensive(i), i - 1);
+    EXPECT_EQ(function(3), 6);
+
+    const auto records = vdk::instrumentation::snapshot();
+
+    auto c = find(records, "cheap_handler");
+    auto e = find(records, "expensive_handler");
+    ASSERT_NE(c, nullptr);
+    ASSERT_NE(e, nullptr);
+    EXPECT_EQ(c->calls_, 100u);
+    EXPECT_EQ(e->calls_, 5u);
+
+    std::uint64_t histogram = 0;
+    for (auto bucket : e->histogram_)
+        histogram += bucket;
+    EXPECT_EQ(histogram, 5u);
+
+    // Records are sorted by total time
+    EXPECT_EQ(&records.front(), e);
+    EXPECT_GE(e->total_, 5u * 200'000u);
+    EXPECT_GE(e->percentile(0.5), 200'000u / 2);
+
+    vdk::instrumentation::reset();
+    for (const auto & r : vdk::instrumentation::snapshot())
+        EXPECT_EQ(r.calls_, 0u);
+}
+
+TEST(InstrumentationTest, DispatchTable)
+{
+    vdk::instrumentation::reset();
+
+    vdk::dispatch_table<int(int), 2> table;
+    table.assign(0, cheap_handler{});
+    table.assign(1, free_function);
+    EXPECT_EQ(table[0](1), 2);
+    EXPECT_EQ(table[1](1), 2);
+    EXPECT_EQ(table[1](2), 4);
+
+    const auto records = vdk::instrumentation::snapshot();
+    auto c = find(records, "cheap_handler");
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(c->calls_, 1u);
+}
+
+TEST(InstrumentationTest, Threads)
+{
+    vdk::instrumentation::reset();
+
+    vdk::delegate<int(int) const> cheap{ cheap_handler{} };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&cheap] { for (int j = 0; j < 1000; ++j) cheap(j); });
+    for (auto & thread : threads)
+        thread.join();
+
+    const auto records = vdk::instrumentation::snapshot();
+    auto c = find(records, "cheap_handler");
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(c->calls_, 4000u);
+}
+
+TEST(InstrumentationTest, Report)
+{
+    vdk::delegate<int(int)> cheap{ cheap_handler{} };
+    cheap(1);
+
+    std::FILE * out = std::tmpfile();
+    ASSERT_NE(out, nullptr);
+    vdk::instrumentation::report(out);
+    std::rewind(out);
+
+    char buffer[4096] = {};
+    const auto size = std::fread(buffer, 1, sizeof(buffer) - 1, out);
+    std::fclose(out);
+
+    const std::string_view text{ buffer, size };
+    EXPECT_NE(text.find("cheap_handler"), std::string_view::npos);
+    EXPECT_NE(text.find("calls"), std::string_view::npos);
+}
+
+TEST(InstrumentationTest, ChromeTrace)
+{
+    vdk::delegate<int(int)> cheap{ cheap_handler{} };
+    cheap(0);
+
+    vdk::instrumentation::start_trace(2);
+    cheap(1);
+    cheap(2);
+    cheap(3);
+    vdk::instrumentation::stop_trace();
+    cheap(4);
+
+    std::FILE * out = std::tmpfile();
+    ASSERT_NE(out, nullptr);
+    EXPECT_TRUE(vdk::instrumentation::write_trace(out));
+    std::rewind(out);
+
+    std::string text;
+    char buffer[4096];
+    while (auto size = std::fread(buffer, 1, sizeof(buffer), out))
+        text.append(buffer, size);
+    std::fclose(out);
+
+    // Events beyond capacity are dropped
+    std::size_t events = 0;
+    for (auto pos = text.find("\"ph\":\"X\""); pos != std::string::npos;
+         pos = text.find("\"ph\":\"X\"", pos + 1))
+        ++events;
+    EXPECT_EQ(events, 2u);
+    EXPECT_EQ(text.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(text.find("cheap_handler"), std::string::npos);
+    EXPECT_NE(text.find("\"call_site\":\"0x"), std::string::npos);
+    EXPECT_NE(text.find("]}"), std::string::npos);
+}
+
+TEST(InstrumentationTest, RestartTrace)
+{
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&done]
+        {
+            vdk::delegate<int(int)> cheap{ cheap_handler{} };
+            while (!done.load(std::memory_order_relaxed))
+                cheap(1);
+        });
+    }
+
+    // Buffers are replaced while other threads keep recording into them
+    for (int i = 0; i < 200; ++i)
+    {
+        vdk::instrumentation::start_trace(64);
+        std::this_thread::yield();
+        vdk::instrumentation::stop_trace();
+
+        std::FILE * out = std::tmpfile();
+        ASSERT_NE(out, nullptr);
+        EXPECT_TRUE(vdk::instrumentation::write_trace(out));
+        std::fclose(out);
+    }
+
+    done.store(true, std::memory_order_relaxed);
+    for (auto & thread : threads)
+        thread.join();
+}
+
+#if !defined(_WIN32)
+
+TEST(InstrumentationTest, PerfMap)
+{
+    vdk::delegate<int(int)> cheap{ cheap_handler{} };
+    vdk::delegate<int(int)> expensive{ expensive_handler{} };
+    cheap(0);
+    expensive(0);
+
+    char path[] = "/tmp/vdk-perf-XXXXXX";
+    const int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    ASSERT_TRUE(vdk::instrumentation::write_perf_map(path));
+
+    std::FILE * in = std::fopen(path, "r");
+    ASSERT_NE(in, nullptr);
+
+    // Every line is "START SIZE name" with hexadecimal numbers
+    bool found = false;
+    unsigned long long start = 0, size = 0;
+    char name[1024];
+    while (std::fscanf(in, "%llx %llx %1023[^\n]\n", &start, &size, name) == 3)
+    {
+        EXPECT_NE(start, 0u);
+        EXPECT_GT(size, 0u);
+        if (std::string_view{ name }.find("cheap_handler") != std::string_view::npos)
+            found = true;
+    }
+    EXPECT_TRUE(std::feof(in));
+    std::fclose(in);
+    std::remove(path);
+    EXPECT_TRUE(found);
+}
+
+#endif
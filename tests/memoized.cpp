@@ -0,0 +1,141 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+#include <memoized.h>
+
+TEST(MemoizedTest, Hits)
+{
+    int calls = 0;
+    vdk::memoized<std::string(const std::string &, int)> repeat{
+        [&calls](const std::string & s, int n)
+        {
+            ++calls;
+            std::string r;
+            for (int i = 0; i < n; ++i) r += s;
+            return r;
+        }, 16 };
+
+    EXPECT_EQ(repeat("ab", 3), "ababab");
+    EXPECT_EQ(repeat("ab", 3), "ababab");
+    EXPECT_EQ(repeat("ab", 2), "abab");
+    EXPECT_EQ(repeat("ba", 3), "bababa");
+    EXPECT_EQ(calls, 3);
+    EXPECT_EQ(repeat.size(), 3u);
+    EXPECT_EQ(repeat.capacity(), 16u);
+
+    auto stats = repeat.stats();
+    EXPECT_EQ(stats.hits_, 1u);
+    EXPECT_EQ(stats.misses_, 3u);
+    EXPECT_EQ(stats.evictions_, 0u);
+    EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.25);
+
+    repeat.reset_stats();
+    EXPECT_EQ(repeat.stats().misses_, 0u);
+
+    repeat.clear();
+    EXPECT_EQ(repeat.size(), 0u);
+    EXPECT_EQ(repeat("ab", 3), "ababab");
+    EXPECT_EQ(calls, 4);
+}
+
+TEST(MemoizedTest, Eviction)
+{
+    int calls = 0;
+    vdk::memoized<int(int)> square{ [&calls](int x) { ++calls; return x * x; }, 4 };
+
+    for (int x = 0; x < 4; ++x)
+        square(x);
+    EXPECT_EQ(square.size(), 4u);
+
+    // Recently used entries survive one sweep of the clock hand
+    square(0);
+    square(1);
+    square(10);
+    EXPECT_EQ(square.size(), 4u);
+    EXPECT_EQ(square.stats().evictions_, 1u);
+
+    calls = 0;
+    EXPECT_EQ(square(10), 100);
+    EXPECT_EQ(calls, 0);
+
+    // Many distinct keys never exceed capacity and stay consistent
+    for (int x = 0; x < 1000; ++x)
+        EXPECT_EQ(square(x % 37), (x % 37) * (x % 37));
+    EXPECT_EQ(square.size(), 4u);
+}
+
+TEST(MemoizedTest, Exceptions)
+{
+    vdk::memoized<int(int)> checked{ [](int x)
+    {
+        if (x < 0) throw std::invalid_argument{ "negative" };
+        return x;
+    }, 8 };
+
+    EXPECT_THROW(checked(-1), std::invalid_argument);
+    EXPECT_EQ(checked.size(), 0u);
+    EXPECT_EQ(checked(1), 1);
+    EXPECT_EQ(checked.size(), 1u);
+}
+
+TEST(MemoizedTest, Recursion)
+{
+    // Callable may invoke its own memoized wrapper
+    vdk::memoized<std::uint64_t(int)> * self = nullptr;
+    vdk::memoized<std::uint64_t(int)> fib{ [&self](int n) -> std::uint64_t
+    {
+        return n < 2 ? n : (*self)(n - 1) + (*self)(n - 2);
+    }, 128 };
+    self = &fib;
+
+    EXPECT_EQ(fib(90), 2880067194370816120ull);
+    EXPECT_EQ(fib.stats().misses_, 91u);
+}
+
+TEST(MemoizedTest, Sharded)
+{
+    constexpr int threads = 4;
+    constexpr int calls = 20000;
+
+    std::atomic<int> computed{ 0 };
+    vdk::memoized<long(int), 8> cube{ [&computed](int x)
+    {
+        computed.fetch_add(1, std::memory_order_relaxed);
+        return long{ x } * x * x;
+    }, 256 };
+    EXPECT_EQ(cube.capacity(), 256u);
+
+    std::vector<std::thread> workers;
+    std::atomic<bool> wrong{ false };
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]
+        {
+            for (int i = 0; i < calls; ++i)
+            {
+                const int x = (i * 7 + t) % 100;
+                if (cube(x) != long{ x } * x * x)
+                    wrong = true;
+            }
+        });
+    }
+    for (auto & w : workers)
+        w.join();
+
+    EXPECT_FALSE(wrong);
+    const auto stats = cube.stats();
+    EXPECT_EQ(stats.hits_ + stats.misses_, std::uint64_t{ threads * calls });
+    EXPECT_EQ(stats.misses_, std::uint64_t(computed.load()));
+    EXPECT_LE(cube.size(), 100u);
+}
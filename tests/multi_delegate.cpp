@@ -0,0 +1,160 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <string>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <multi_delegate.h>
+
+namespace
+{
+struct ping { int id_; };
+struct data { std::string payload_; };
+struct stop {};
+
+// Visitor that records handled messages
+struct visitor
+{
+    int operator()(const ping & msg) { return log_ += 1, msg.id_; }
+    int operator()(const data & msg) { return log_ += 10, static_cast<int>(msg.payload_.size()); }
+    int operator()(stop) const noexcept { return -1; }
+
+    std::shared_ptr<int> token_;
+    int log_{};
+};
+
+// Functor that counts its live instances
+struct counted
+{
+    explicit counted(int * live) noexcept : live_{ live } { ++*live_; }
+    counted(const counted & other) noexcept : live_{ other.live_ } { ++*live_; }
+    counted(counted && other) noexcept : live_{ other.live_ } { ++*live_; }
+    ~counted() noexcept { --*live_; }
+
+    int operator()(int value) const noexcept { return value * 2; }
+    int operator()(double value) const noexcept { return static_cast<int>(value * 4); }
+
+    bool operator==(const counted &) const noexcept { return true; }
+
+    int * live_;
+    std::array<long long, 4> padding_{};
+};
+
+// Functor that gives away its state when invoked as rvalue
+struct releaser
+{
+    std::shared_ptr<int> operator()() && { return std::move(token_); }
+    long operator()() const & { return token_.use_count(); }
+
+    std::shared_ptr<int> token_;
+};
+
+int add_one(int value) noexcept
+{
+    return value + 1;
+}
+
+using handler = vdk::multi_delegate<int(const ping &), int(const data &), int(stop) const>;
+
+} // namespace
+
+static_assert(std::is_nothrow_move_constructible_v<handler>);
+static_assert(std::is_nothrow_move_assignable_v<handler>);
+static_assert(!std::is_copy_constructible_v<handler>);
+static_assert(sizeof(handler) < sizeof(vdk::delegate<int(const ping &)>));
+static_assert(std::is_constructible_v<handler, visitor>);
+static_assert(!std::is_constructible_v<handler, int(*)(int)>);
+
+TEST(MultiDelegateTest, Empty)
+{
+    handler d1;
+    handler d2{ nullptr };
+    EXPECT_FALSE(d1);
+    EXPECT_FALSE(d2);
+    EXPECT_TRUE(d1 == nullptr);
+    EXPECT_TRUE(nullptr == d2);
+    EXPECT_TRUE(d1 == d2);
+}
+
+TEST(MultiDelegateTest, Overloads)
+{
+    handler d{ visitor{} };
+    EXPECT_TRUE(d);
+    EXPECT_EQ(d(ping{ 7 }), 7);
+    EXPECT_EQ(d(data{ "abc" }), 3);
+
+    const auto & cd = d;
+    EXPECT_EQ(cd(stop{}), -1);
+}
+
+TEST(MultiDelegateTest, SingleTarget)
+{
+    // Heap-allocated target is shared by all signatures
+    int live = 0;
+    {
+        vdk::multi_delegate<int(int), int(double) noexcept> d{ counted{ &live } };
+        EXPECT_EQ(live, 1);
+        EXPECT_EQ(d(3), 6);
+        EXPECT_EQ(d(0.5), 2);
+
+        auto moved = std::move(d);
+        EXPECT_FALSE(d);
+        EXPECT_EQ(live, 1);
+        EXPECT_EQ(moved(5), 10);
+        EXPECT_EQ(moved(1.0), 4);
+
+        vdk::multi_delegate<int(int), int(double) noexcept> other{ counted{ &live } };
+        EXPECT_EQ(live, 2);
+        EXPECT_TRUE(moved == other);
+
+        other = nullptr;
+        EXPECT_EQ(live, 1);
+    }
+    EXPECT_EQ(live, 0);
+}
+
+TEST(MultiDelegateTest, Assignment)
+{
+    vdk::multi_delegate<int(int), int(double)> d{ add_one };
+    EXPECT_EQ(d(1), 2);
+    EXPECT_EQ(d(2.5), 3);
+
+    vdk::multi_delegate<int(int), int(double)> d2{ add_one };
+    EXPECT_TRUE(d == d2);
+
+    int live = 0;
+    d = counted{ &live };
+    EXPECT_EQ(live, 1);
+    EXPECT_EQ(d(4), 8);
+    EXPECT_FALSE(d == d2);
+
+    d = [](auto value) { return static_cast<int>(value) - 1; };
+    EXPECT_EQ(live, 0);
+    EXPECT_EQ(d(1), 0);
+
+    d = static_cast<int(*)(int)>(nullptr);
+    EXPECT_TRUE(d);
+
+    d2 = std::move(d);
+    EXPECT_FALSE(d);
+    EXPECT_EQ(d2(10.0), 9);
+}
+
+TEST(MultiDelegateTest, RvalueSignature)
+{
+    auto token = std::make_shared<int>(5);
+    vdk::multi_delegate<std::shared_ptr<int>() &&, long() const &> d{ releaser{ token } };
+    static_assert(!std::is_invocable_v<decltype(d) &&, int>);
+
+    EXPECT_EQ(d(), 2);
+    auto result = std::move(d)();
+    EXPECT_EQ(*result, 5);
+    EXPECT_EQ(token.use_count(), 2);
+}
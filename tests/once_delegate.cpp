@@ -0,0 +1,138 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <array>
+#include <memory>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <once_delegate.h>
+
+namespace
+{
+int add_one(int value) noexcept
+{
+    return value + 1;
+}
+
+// Functor that counts its live instances
+template<std::size_t Padding>
+struct counted
+{
+    explicit counted(int * live) noexcept : live_{ live } { ++*live_; }
+    counted(counted && other) noexcept : live_{ other.live_ } { ++*live_; }
+    ~counted() noexcept { --*live_; }
+
+    int operator()(int value) && { return value * 2; }
+
+    int * live_;
+    std::array<char, Padding> padding_{};
+};
+
+using small_t = counted<1>;
+using large_t = counted<64>;
+
+} // namespace
+
+static_assert(vdk::internal::delegate::is_internal_v<small_t>);
+static_assert(!vdk::internal::delegate::is_internal_v<large_t>);
+static_assert(std::is_nothrow_move_constructible_v<vdk::once_delegate<void()>>);
+static_assert(!std::is_copy_constructible_v<vdk::once_delegate<void()>>);
+static_assert(!std::is_invocable_v<vdk::once_delegate<void()> &>);
+static_assert(std::is_nothrow_invocable_v<vdk::once_delegate<int(int) noexcept>, int>);
+
+TEST(OnceDelegateTest, Empty)
+{
+    vdk::once_delegate<int(int)> d1;
+    vdk::once_delegate<int(int)> d2{ nullptr };
+    vdk::once_delegate<int(int)> d3{ static_cast<int(*)(int)>(nullptr) };
+    EXPECT_FALSE(d1);
+    EXPECT_FALSE(d2);
+    EXPECT_FALSE(d3);
+    EXPECT_TRUE(d1 == nullptr);
+    EXPECT_FALSE(nullptr != d2);
+}
+
+TEST(OnceDelegateTest, Consume)
+{
+    vdk::once_delegate<int(int) noexcept> f{ add_one };
+    EXPECT_TRUE(f);
+    EXPECT_EQ(std::move(f)(1), 2);
+    EXPECT_FALSE(f);
+
+    int live = 0;
+    vdk::once_delegate<int(int)> small{ small_t{ &live } };
+    vdk::once_delegate<int(int)> large{ large_t{ &live } };
+    EXPECT_EQ(live, 2);
+
+    // Target is destroyed by the call
+    EXPECT_EQ(std::move(small)(2), 4);
+    EXPECT_EQ(live, 1);
+    EXPECT_FALSE(small);
+    EXPECT_EQ(std::move(large)(3), 6);
+    EXPECT_EQ(live, 0);
+    EXPECT_FALSE(large);
+
+    // Move-only result and arguments
+    vdk::once_delegate<std::unique_ptr<int>(std::unique_ptr<int>)> twice{
+        [](std::unique_ptr<int> p) { *p *= 2; return p; } };
+    EXPECT_EQ(*std::move(twice)(std::make_unique<int>(21)), 42);
+}
+
+TEST(OnceDelegateTest, Destroy)
+{
+    int live = 0;
+    {
+        vdk::once_delegate<int(int)> small{ small_t{ &live } };
+        vdk::once_delegate<int(int)> large{ large_t{ &live } };
+        auto moved = std::move(large);
+        EXPECT_FALSE(large);
+        EXPECT_EQ(live, 2);
+
+        small = large_t{ &live };
+        EXPECT_EQ(live, 2);
+        moved = nullptr;
+        EXPECT_EQ(live, 1);
+    }
+    EXPECT_EQ(live, 0);
+}
+
+TEST(OnceDelegateTest, Rearm)
+{
+    // Target may assign a new target to the delegate being invoked
+    int calls = 0;
+    vdk::once_delegate<void()> d;
+    auto token = std::make_shared<int>(0);
+    d = [&d, &calls, token]
+    {
+        ++calls;
+        d = [&calls, token] { calls += 10; };
+    };
+    std::move(d)();
+    EXPECT_TRUE(d);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(token.use_count(), 2);
+
+    std::move(d)();
+    EXPECT_FALSE(d);
+    EXPECT_EQ(calls, 11);
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(OnceDelegateTest, Exception)
+{
+    int live = 0;
+    auto throwing = [counter = large_t{ &live }](int) -> int { throw std::runtime_error{ "failure" }; };
+    vdk::once_delegate<int(int)> d{ std::move(throwing) };
+    EXPECT_EQ(live, 2);
+
+    // Target is consumed even if it throws
+    EXPECT_THROW(std::move(d)(1), std::runtime_error);
+    EXPECT_FALSE(d);
+    EXPECT_EQ(live, 1);
+}
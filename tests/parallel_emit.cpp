@@ -0,0 +1,181 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <condition_variable>
+
+#include <gtest/gtest.h>
+#include <parallel_emit.h>
+#include <priority_scheduler.h>
+
+namespace
+{
+using vdk::delegate;
+
+// Executor over a pool of worker threads
+struct pool_executor
+{
+    explicit pool_executor(std::size_t threads)
+        : scheduler_{ threads }
+    {}
+    void post(delegate<void()> task)
+    {
+        scheduler_.post(0, std::move(task));
+    }
+    vdk::priority_scheduler<1> scheduler_;
+};
+
+// Executor that only collects posted delegates
+struct manual_executor
+{
+    void post(delegate<void()> task)
+    {
+        queue_.push_back(std::move(task));
+    }
+    void run()
+    {
+        while (!queue_.empty())
+        {
+            auto task = std::move(queue_.front());
+            queue_.pop_front();
+            task();
+        }
+    }
+    std::deque<delegate<void()>> queue_;
+};
+
+struct test_exception : std::runtime_error
+{
+    test_exception()
+        : std::runtime_error{ "test exception" }
+    {}
+};
+
+} // namespace
+
+TEST(ParallelEmitTest, Emit)
+{
+    pool_executor executor{ 3 };
+
+    std::vector<std::atomic<int>> calls(1000);
+    std::vector<delegate<void(int)>> subscribers;
+    for (auto & c : calls)
+        subscribers.emplace_back([&c](int value) { c.fetch_add(value); });
+
+    vdk::parallel_emit(executor, subscribers.data(), subscribers.size(), { 16, 4 }, 2);
+    for (auto & c : calls)
+        EXPECT_EQ(c.load(), 2);
+
+    // Every subscriber is invoked exactly once per emission
+    for (int i = 0; i < 20; ++i)
+        vdk::parallel_emit(executor, subscribers.data(), subscribers.size(), { 7, 4 }, 1);
+    for (auto & c : calls)
+        EXPECT_EQ(c.load(), 22);
+}
+
+TEST(ParallelEmitTest, Inline)
+{
+    manual_executor executor;
+
+    const auto caller = std::this_thread::get_id();
+    int calls = 0;
+    std::vector<delegate<void()>> subscribers;
+    for (int i = 0; i < 10; ++i)
+    {
+        subscribers.emplace_back([&calls, caller]
+        {
+            EXPECT_EQ(std::this_thread::get_id(), caller);
+            ++calls;
+        });
+    }
+
+    // List not larger than the grain runs inline, nothing is posted
+    vdk::parallel_emit(executor, subscribers.data(), subscribers.size(), { 10, 4 });
+    EXPECT_EQ(calls, 10);
+    EXPECT_TRUE(executor.queue_.empty());
+
+    // Helpers that run after the calling thread took every chunk find no work
+    vdk::parallel_emit(executor, subscribers.data(), subscribers.size(), { 3, 4 });
+    EXPECT_EQ(calls, 20);
+    EXPECT_EQ(executor.queue_.size(), 3u);
+    executor.run();
+    EXPECT_EQ(calls, 20);
+}
+
+TEST(ParallelEmitTest, Exceptions)
+{
+    pool_executor executor{ 2 };
+
+    std::atomic<int> calls{ 0 };
+    std::vector<delegate<void(int)>> subscribers;
+    for (int i = 0; i < 100; ++i)
+    {
+        subscribers.emplace_back([&calls, i](int bad)
+        {
+            calls.fetch_add(1);
+            if (i == bad)
+                throw test_exception{};
+        });
+    }
+
+    // Rest of the throwing chunk is skipped, other chunks are invoked
+    EXPECT_THROW(vdk::parallel_emit(executor, subscribers.data(), subscribers.size(),
+                                    { 10, 3 }, 55), test_exception);
+    EXPECT_EQ(calls.load(), 96);
+
+    calls = 0;
+    EXPECT_THROW(vdk::parallel_emit(executor, subscribers.data(), subscribers.size(),
+                                    { 100, 3 }, 0), test_exception);
+    EXPECT_EQ(calls.load(), 1);
+}
+
+TEST(ParallelEmitTest, Async)
+{
+    pool_executor executor{ 3 };
+
+    std::vector<std::atomic<int>> calls(500);
+    std::vector<delegate<void(const std::vector<int>&)>> subscribers;
+    for (auto & c : calls)
+        subscribers.emplace_back([&c](const std::vector<int> & values) { c.fetch_add(values[1]); });
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    int done = 0;
+    std::exception_ptr error;
+    auto complete = [&](std::exception_ptr e)
+    {
+        std::lock_guard<std::mutex> lock{ mutex };
+        error = e;
+        ++done;
+        cond.notify_all();
+    };
+
+    {
+        // Arguments are copied, so the caller's copy may go away at once
+        std::vector<int> values{ 1, 3 };
+        vdk::parallel_emit_async(executor, subscribers.data(), subscribers.size(),
+                                 { 32, 4 }, complete, values);
+    }
+    {
+        std::unique_lock<std::mutex> lock{ mutex };
+        cond.wait(lock, [&] { return done == 1; });
+    }
+    EXPECT_FALSE(error);
+    for (auto & c : calls)
+        EXPECT_EQ(c.load(), 3);
+
+    // Small list completes on the calling thread
+    vdk::parallel_emit_async(executor, subscribers.data(), 8, { 32, 4 },
+                             complete, std::vector<int>{ 0, 1 });
+    EXPECT_EQ(done, 2);
+    EXPECT_EQ(calls[7].load(), 4);
+    EXPECT_EQ(calls[8].load(), 3);
+}
@@ -0,0 +1,145 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include <gtest/gtest.h>
+#include <priority_scheduler.h>
+
+namespace
+{
+// Keeps the only worker busy until released
+class gate
+{
+public:
+
+    void hold()
+    {
+        std::unique_lock<std::mutex> lock{ mutex_ };
+        held_ = true;
+        cond_.notify_all();
+        cond_.wait(lock, [this] { return open_; });
+    }
+    void wait_held()
+    {
+        std::unique_lock<std::mutex> lock{ mutex_ };
+        cond_.wait(lock, [this] { return held_; });
+    }
+    void open()
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        open_ = true;
+        cond_.notify_all();
+    }
+
+private:
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool held_{};
+    bool open_{};
+};
+
+} // namespace
+
+TEST(PrioritySchedulerTest, Priorities)
+{
+    std::vector<int> log;
+    gate g;
+    {
+        vdk::priority_scheduler<3> scheduler{ 1, { 0 } };
+        EXPECT_EQ(scheduler.threads(), 1u);
+
+        scheduler.post(1, [&g] { g.hold(); });
+        g.wait_held();
+
+        // Queued while the worker is busy; higher lanes run first, FIFO within a lane
+        scheduler.post(2, [&log] { log.push_back(20); });
+        scheduler.post(1, [&log] { log.push_back(10); });
+        scheduler.post(2, [&log] { log.push_back(21); });
+        scheduler.post(0, [&log] { log.push_back(0); });
+        scheduler.post(1, [&log] { log.push_back(11); });
+        EXPECT_EQ(scheduler.stats(2).depth_, 2u);
+        EXPECT_EQ(scheduler.stats(0).depth_, 1u);
+
+        g.open();
+        // Destructor runs all posted tasks
+    }
+    EXPECT_EQ(log, (std::vector<int>{ 0, 10, 11, 20, 21 }));
+}
+
+TEST(PrioritySchedulerTest, Aging)
+{
+    std::vector<int> log;
+    gate g;
+    {
+        vdk::priority_scheduler<2> scheduler{ 1, { 2 } };
+        scheduler.post(0, [&g] { g.hold(); });
+        g.wait_held();
+
+        for (int i = 0; i < 6; ++i)
+            scheduler.post(0, [&log, i] { log.push_back(i); });
+        scheduler.post(1, [&log] { log.push_back(100); });
+        scheduler.post(1, [&log] { log.push_back(101); });
+
+        // Low lane is served after two tasks of the high lane have bypassed it
+        g.open();
+    }
+    EXPECT_EQ(log, (std::vector<int>{ 0, 1, 100, 2, 3, 101, 4, 5 }));
+}
+
+TEST(PrioritySchedulerTest, Stats)
+{
+    vdk::priority_scheduler<2> scheduler{ 2 };
+    std::atomic<int> done{ 0 };
+
+    for (int i = 0; i < 100; ++i)
+        scheduler.post(i % 2, [&done] { done.fetch_add(1); });
+    while (done.load() != 100)
+        std::this_thread::yield();
+
+    for (std::size_t lane = 0; lane < 2; ++lane)
+    {
+        const auto stats = scheduler.stats(lane);
+        EXPECT_EQ(stats.depth_, 0u);
+        EXPECT_EQ(stats.executed_, 50u);
+        EXPECT_GE(stats.total_wait_, stats.max_wait_);
+    }
+}
+
+TEST(PrioritySchedulerTest, ManyProducers)
+{
+    constexpr int producers = 4;
+    constexpr int tasks = 5000;
+
+    std::atomic<int> done{ 0 };
+    {
+        vdk::priority_scheduler<3> scheduler{ 3 };
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+            {
+                for (int t = 0; t < tasks; ++t)
+                {
+                    scheduler.post(static_cast<std::size_t>((t + p) % 3), [&done, &scheduler]
+                    {
+                        // Tasks may post further tasks
+                        if (done.fetch_add(1) % 100 == 0)
+                            scheduler.post(0, [&done] { done.fetch_add(1); });
+                    });
+                }
+            });
+        }
+        for (auto & t : threads)
+            t.join();
+    }
+    EXPECT_GE(done.load(), producers * tasks);
+}
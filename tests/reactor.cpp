@@ -0,0 +1,313 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include <gtest/gtest.h>
+#include <reactor.h>
+
+namespace
+{
+using vdk::reactor;
+
+// Pair of pipe descriptors closed on destruction
+class pipe_pair
+{
+public:
+
+    pipe_pair()
+    {
+        if (::pipe(fds_) != 0)
+            throw std::runtime_error{ "pipe" };
+    }
+    ~pipe_pair()
+    {
+        ::close(fds_[0]);
+        ::close(fds_[1]);
+    }
+    int in() const noexcept { return fds_[0]; }
+    int out() const noexcept { return fds_[1]; }
+
+    void write(char c = 'x') const
+    {
+        ASSERT_EQ(::write(fds_[1], &c, 1), 1);
+    }
+    char read() const
+    {
+        char c = 0;
+        EXPECT_EQ(::read(fds_[0], &c, 1), 1);
+        return c;
+    }
+
+    pipe_pair(const pipe_pair &) = delete;
+    pipe_pair & operator=(const pipe_pair &) = delete;
+
+private:
+
+    int fds_[2];
+};
+
+} // namespace
+
+TEST(ReactorTest, Readable)
+{
+    reactor loop;
+    pipe_pair pipe;
+
+    std::vector<char> received;
+    std::uint32_t seen = 0;
+    loop.add(pipe.in(), EPOLLIN, [&](std::uint32_t events)
+    {
+        seen = events;
+        received.push_back(pipe.read());
+    });
+
+    EXPECT_EQ(loop.run_once(0), 0u);
+
+    pipe.write('a');
+    EXPECT_EQ(loop.run_once(), 1u);
+    EXPECT_TRUE(seen & EPOLLIN);
+
+    pipe.write('b');
+    pipe.write('c');
+    loop.run_once();
+    loop.run_once();
+    EXPECT_EQ(received, (std::vector<char>{ 'a', 'b', 'c' }));
+    EXPECT_EQ(loop.run_once(0), 0u);
+}
+
+TEST(ReactorTest, Modify)
+{
+    reactor loop;
+    pipe_pair pipe;
+
+    int writable = 0;
+    loop.add(pipe.out(), 0, [&](std::uint32_t events)
+    {
+        if (events & EPOLLOUT) ++writable;
+    });
+
+    EXPECT_EQ(loop.run_once(0), 0u);
+
+    loop.modify(pipe.out(), EPOLLOUT);
+    EXPECT_EQ(loop.run_once(0), 1u);
+    EXPECT_EQ(writable, 1);
+
+    loop.modify(pipe.out(), 0);
+    EXPECT_EQ(loop.run_once(0), 0u);
+    EXPECT_EQ(writable, 1);
+}
+
+TEST(ReactorTest, Remove)
+{
+    reactor loop;
+    pipe_pair first;
+    pipe_pair second;
+
+    auto token = std::make_shared<int>(0);
+    int calls = 0;
+
+    // Both descriptors are ready; whichever runs first removes the other
+    loop.add(first.in(), EPOLLIN, [&, token](std::uint32_t)
+    {
+        ++calls;
+        loop.remove(second.in());
+    });
+    loop.add(second.in(), EPOLLIN, [&, token](std::uint32_t)
+    {
+        ++calls;
+        loop.remove(first.in());
+    });
+    EXPECT_EQ(token.use_count(), 3);
+
+    first.write();
+    second.write();
+    EXPECT_EQ(loop.run_once(), 1u);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(token.use_count(), 2);
+
+    loop.remove(first.in());
+    loop.remove(second.in());
+    EXPECT_EQ(token.use_count(), 1);
+    EXPECT_EQ(loop.run_once(0), 0u);
+}
+
+TEST(ReactorTest, RemoveSelf)
+{
+    reactor loop;
+    pipe_pair pipe;
+
+    auto token = std::make_shared<int>(42);
+    int value = 0;
+    loop.add(pipe.in(), EPOLLIN, [&, token](std::uint32_t)
+    {
+        loop.remove(pipe.in());
+        // Captured state stays valid until the handler returns
+        value = *token;
+    });
+
+    pipe.write();
+    EXPECT_EQ(loop.run_once(), 1u);
+    EXPECT_EQ(value, 42);
+    EXPECT_EQ(token.use_count(), 1);
+    EXPECT_EQ(loop.run_once(0), 0u);
+
+    // Descriptor can be registered again
+    loop.add(pipe.in(), EPOLLIN, [&](std::uint32_t) { value = 7; });
+    EXPECT_EQ(loop.run_once(0), 1u);
+    EXPECT_EQ(value, 7);
+    loop.remove(pipe.in());
+}
+
+TEST(ReactorTest, ReplaceSelf)
+{
+    reactor loop;
+    pipe_pair pipe;
+
+    int first = 0;
+    int second = 0;
+    loop.add(pipe.in(), EPOLLIN, [&](std::uint32_t)
+    {
+        ++first;
+        loop.remove(pipe.in());
+        loop.add(pipe.in(), EPOLLIN, [&](std::uint32_t) { ++second; });
+    });
+
+    pipe.write();
+    EXPECT_EQ(loop.run_once(), 1u);
+    EXPECT_EQ(loop.run_once(0), 1u);
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 1);
+    loop.remove(pipe.in());
+}
+
+TEST(ReactorTest, Post)
+{
+    reactor loop;
+
+    int local = 0;
+    loop.post([&local] { ++local; });
+    loop.post([&local] { ++local; });
+    EXPECT_EQ(loop.run_once(), 2u);
+    EXPECT_EQ(local, 2);
+    EXPECT_EQ(loop.run_once(0), 0u);
+
+    constexpr int producers = 4;
+    constexpr int tasks = 10000;
+
+    int executed = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i)
+    {
+        threads.emplace_back([&]
+        {
+            for (int j = 0; j < tasks; ++j)
+                loop.post([&executed] { ++executed; });
+        });
+    }
+
+    while (executed != producers * tasks)
+        loop.run_once(10);
+
+    for (auto & thread : threads)
+        thread.join();
+    EXPECT_EQ(executed, producers * tasks);
+}
+
+TEST(ReactorTest, PostThrows)
+{
+    reactor loop;
+
+    int local = 0;
+    loop.post([&local] { ++local; });
+    loop.post([] { throw std::runtime_error{ "failure" }; });
+    loop.post([&local] { ++local; });
+    EXPECT_THROW(loop.run_once(), std::runtime_error);
+    EXPECT_EQ(local, 1);
+
+    // Tasks after the failed one run without another post
+    EXPECT_EQ(loop.run_once(0), 1u);
+    EXPECT_EQ(local, 2);
+}
+
+TEST(ReactorTest, HandlerThrows)
+{
+    reactor loop;
+    pipe_pair first;
+    pipe_pair second;
+
+    // Whichever handler runs first throws; edges of the other one are kept
+    bool thrown = false;
+    int calls = 0;
+    const auto handler = [&](const pipe_pair & pipe)
+    {
+        return [&](std::uint32_t)
+        {
+            if (!std::exchange(thrown, true))
+                throw std::runtime_error{ "failure" };
+            ++calls;
+            pipe.read();
+        };
+    };
+    loop.add(first.in(), EPOLLIN | EPOLLET, handler(first));
+    loop.add(second.in(), EPOLLIN | EPOLLET, handler(second));
+
+    first.write();
+    second.write();
+    EXPECT_THROW(loop.run_once(), std::runtime_error);
+    EXPECT_EQ(calls, 0);
+
+    EXPECT_EQ(loop.run_once(0), 1u);
+    EXPECT_EQ(calls, 1);
+
+    // Edge of the failed handler has been consumed
+    EXPECT_EQ(loop.run_once(0), 0u);
+}
+
+TEST(ReactorTest, RunStop)
+{
+    reactor loop;
+    pipe_pair pipe;
+
+    int events = 0;
+    loop.add(pipe.in(), EPOLLIN, [&](std::uint32_t)
+    {
+        pipe.read();
+        if (++events == 3)
+            loop.stop();
+        else
+            pipe.write();
+    });
+
+    pipe.write();
+    loop.run();
+    EXPECT_EQ(events, 3);
+
+    std::thread stopper{ [&loop] { loop.stop(); } };
+    loop.run();
+    stopper.join();
+    loop.remove(pipe.in());
+}
+
+TEST(ReactorTest, PendingTasksDestroyed)
+{
+    auto token = std::make_shared<int>(0);
+    {
+        reactor loop;
+        loop.post([token] {});
+        loop.post([token] {});
+        EXPECT_EQ(token.use_count(), 3);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}
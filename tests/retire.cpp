@@ -0,0 +1,116 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <retire.h>
+
+namespace
+{
+// Records the thread that destroys it
+struct tracker
+{
+    explicit tracker(std::atomic<std::thread::id> * where) noexcept
+        : where_{ where }
+    {}
+    tracker(tracker && other) noexcept
+        : where_{ std::exchange(other.where_, nullptr) }
+    {}
+    ~tracker() noexcept
+    {
+        if (where_) where_->store(std::this_thread::get_id());
+    }
+    void operator()() const noexcept {}
+
+    std::atomic<std::thread::id> * where_;
+};
+
+} // namespace
+
+TEST(RetireTest, Drain)
+{
+    vdk::retire_queue queue;
+    EXPECT_EQ(queue.drain(), 0u);
+
+    auto token = std::make_shared<int>(0);
+    vdk::delegate<void()> d1{ [token] {} };
+    vdk::delegate<void()> d2{ [token, buffer = std::vector<char>(1024)] {} };
+    EXPECT_EQ(token.use_count(), 3);
+
+    queue.retire(std::move(d1));
+    queue.retire(std::move(d2));
+    EXPECT_FALSE(d1);
+    EXPECT_FALSE(d2);
+    EXPECT_EQ(token.use_count(), 3);
+
+    EXPECT_EQ(queue.drain(), 2u);
+    EXPECT_EQ(token.use_count(), 1);
+    EXPECT_EQ(queue.drain(), 0u);
+}
+
+TEST(RetireTest, AnyType)
+{
+    vdk::retire_queue queue;
+
+    auto token = std::make_shared<int>(0);
+    queue.retire(std::vector<std::shared_ptr<int>>(10, token));
+    queue.retire(std::shared_ptr<int>{ token });
+    EXPECT_EQ(token.use_count(), 12);
+
+    EXPECT_EQ(queue.drain(), 2u);
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(RetireTest, DestructorDrains)
+{
+    auto token = std::make_shared<int>(0);
+    {
+        vdk::retire_queue queue;
+        queue.retire(vdk::delegate<void()>{ [token] {} });
+        EXPECT_EQ(token.use_count(), 2);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(RetireTest, BackgroundThread)
+{
+    std::atomic<std::thread::id> where{};
+    auto token = std::make_shared<int>(0);
+
+    vdk::retire_queue queue;
+    {
+        vdk::retire_thread reclaimer{ queue, std::chrono::microseconds{ 100 } };
+
+        queue.retire(vdk::delegate<void()>{ tracker{ &where } });
+
+        constexpr int producers = 4;
+        constexpr int objects = 1000;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < producers; ++i)
+        {
+            threads.emplace_back([&queue, &token]
+            {
+                for (int j = 0; j < objects; ++j)
+                    queue.retire(vdk::delegate<void()>{ [token] {} });
+            });
+        }
+        for (auto & thread : threads)
+            thread.join();
+
+        // Retired objects are destroyed by the background thread
+        for (int i = 0; i < 1000 && where.load() == std::thread::id{}; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+        EXPECT_NE(where.load(), std::thread::id{});
+        EXPECT_NE(where.load(), std::this_thread::get_id());
+    }
+    // Background thread drains the queue before it stops
+    EXPECT_EQ(token.use_count(), 1);
+}
@@ -0,0 +1,114 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <static_delegate.h>
+
+namespace
+{
+constexpr int function_twice(int arg)
+{
+    return arg * 2;
+}
+
+constexpr int function_square(int arg) noexcept
+{
+    return arg * arg;
+}
+
+int function_runtime(int arg)
+{
+    return arg - 1;
+}
+
+using vdk::static_delegate;
+
+// Dispatch table that is initialized at compile time
+constexpr static_delegate<int(int)> table[] =
+{
+    function_twice,
+    [](int arg) { return arg + 1; },
+    function_runtime,
+    nullptr
+};
+
+static_assert(std::is_trivially_copyable_v<static_delegate<int(int)>>);
+static_assert(std::is_trivially_destructible_v<static_delegate<int(int)>>);
+static_assert(sizeof(static_delegate<int(int)>) == sizeof(int(*)(int)));
+
+static_assert(table[0](10) == 20);
+static_assert(table[1](10) == 11);
+static_assert(table[2]);
+static_assert(!table[3]);
+static_assert(table[3] == nullptr);
+static_assert(table[0] != table[1]);
+static_assert(table[0] == static_delegate<int(int)>{ function_twice });
+
+} // namespace
+
+TEST(StaticDelegateTest, Empty)
+{
+    constexpr static_delegate<int(int)> fn1;
+    EXPECT_FALSE(fn1);
+    EXPECT_EQ(fn1, nullptr);
+    EXPECT_EQ(nullptr, fn1);
+
+    constexpr static_delegate<int(int)> fn2{ nullptr };
+    EXPECT_FALSE(fn2);
+    EXPECT_EQ(fn1, fn2);
+
+    int(*func_ptr_null)(int) = nullptr;
+    static_delegate<int(int)> fn3{ func_ptr_null };
+    EXPECT_FALSE(fn3);
+    EXPECT_EQ(fn3.target(), nullptr);
+}
+
+TEST(StaticDelegateTest, Call)
+{
+    int arg = 10;
+
+    EXPECT_EQ(table[0](arg), 20);
+    EXPECT_EQ(table[1](arg), 11);
+    EXPECT_EQ(table[2](arg), 9);
+
+    constexpr static_delegate<int(int)noexcept> fn1{ function_square };
+    static_assert(noexcept(fn1(arg)));
+    EXPECT_EQ(fn1(arg), 100);
+
+    constexpr static_delegate<int(int)noexcept> fn2{
+        [](int arg) noexcept { return arg; } };
+    EXPECT_EQ(fn2(arg), arg);
+}
+
+TEST(StaticDelegateTest, Assignment)
+{
+    static_delegate<int(int)> fn1;
+    fn1 = function_runtime;
+    EXPECT_TRUE(fn1);
+    EXPECT_EQ(fn1(10), 9);
+
+    fn1 = table[0];
+    EXPECT_EQ(fn1, table[0]);
+    EXPECT_EQ(fn1(10), 20);
+
+    fn1 = nullptr;
+    EXPECT_FALSE(fn1);
+}
+
+TEST(StaticDelegateTest, Delegate)
+{
+    // Target of static delegate can be stored in a delegate
+    vdk::delegate<int(int)> fn1{ table[0].target() };
+    EXPECT_EQ(fn1(10), 20);
+    EXPECT_EQ(fn1, vdk::delegate<int(int)>{ function_twice });
+
+    // Static delegate itself is a small comparable function object
+    vdk::delegate<int(int)> fn2{ table[1] };
+    EXPECT_EQ(fn2(10), 11);
+    EXPECT_EQ(fn2, vdk::delegate<int(int)>{ table[1] });
+}
@@ -0,0 +1,221 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <condition_variable>
+
+#include <gtest/gtest.h>
+#include <strand.h>
+
+namespace
+{
+using vdk::delegate;
+
+// Executor that only collects posted delegates
+struct manual_executor
+{
+    void post(delegate<void()> task)
+    {
+        queue_.push_back(std::move(task));
+    }
+    // Run tasks that are queued at the moment of the call
+    std::size_t run()
+    {
+        std::size_t count = 0;
+        for (auto n = queue_.size(); n > 0; --n, ++count)
+        {
+            auto task = std::move(queue_.front());
+            queue_.pop_front();
+            task();
+        }
+        return count;
+    }
+
+    std::deque<delegate<void()>> queue_;
+};
+
+// Executor that runs posted delegates on several threads
+class pool_executor
+{
+public:
+
+    explicit pool_executor(std::size_t threads)
+    {
+        for (std::size_t i = 0; i < threads; ++i)
+            threads_.emplace_back([this] { work(); });
+    }
+    ~pool_executor()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (auto & t : threads_)
+            t.join();
+    }
+    void post(delegate<void()> task)
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        queue_.push_back(std::move(task));
+        cond_.notify_one();
+    }
+
+private:
+
+    void work()
+    {
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            auto task = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<delegate<void()>> queue_;
+    std::vector<std::thread> threads_;
+    bool stop_{};
+};
+
+} // namespace
+
+TEST(StrandTest, Post)
+{
+    manual_executor executor;
+    vdk::strand<manual_executor> s{ executor };
+    std::vector<int> log;
+
+    EXPECT_EQ(&s.executor(), &executor);
+    EXPECT_FALSE(s.running_in_this_thread());
+
+    // Only the first task of an idle strand is posted to the executor
+    s.post([&] { log.push_back(1); EXPECT_TRUE(s.running_in_this_thread()); });
+    s.post([&] { log.push_back(2); s.post([&] { log.push_back(4); }); });
+    s.post([&] { log.push_back(3); });
+    EXPECT_EQ(executor.queue_.size(), 1u);
+
+    EXPECT_EQ(executor.run(), 1u);
+    EXPECT_EQ(log, (std::vector<int>{ 1, 2, 3, 4 }));
+    EXPECT_TRUE(executor.queue_.empty());
+    EXPECT_FALSE(s.running_in_this_thread());
+
+    s.post([&] { log.push_back(5); });
+    EXPECT_EQ(executor.run(), 1u);
+    EXPECT_EQ(log.back(), 5);
+}
+
+TEST(StrandTest, Batches)
+{
+    manual_executor executor;
+    vdk::strand<manual_executor> s{ executor, 2 };
+    std::vector<int> log;
+
+    for (int i = 0; i < 5; ++i)
+        s.post([&log, i] { log.push_back(i); });
+
+    // Strand runs at most two tasks at a time, then posts itself again
+    EXPECT_EQ(executor.run(), 1u);
+    EXPECT_EQ(log, (std::vector<int>{ 0, 1 }));
+    EXPECT_EQ(executor.queue_.size(), 1u);
+    executor.run();
+    executor.run();
+    EXPECT_EQ(log, (std::vector<int>{ 0, 1, 2, 3, 4 }));
+    EXPECT_TRUE(executor.queue_.empty());
+}
+
+TEST(StrandTest, Exceptions)
+{
+    manual_executor executor;
+    vdk::strand<manual_executor> s{ executor };
+    std::vector<int> log;
+
+    s.post([&] { log.push_back(1); });
+    s.post([] { throw std::runtime_error{ "failure" }; });
+    s.post([&] { log.push_back(3); });
+
+    // Tasks after the failed one run in the next batch
+    EXPECT_THROW(executor.run(), std::runtime_error);
+    EXPECT_EQ(log, (std::vector<int>{ 1 }));
+    EXPECT_FALSE(s.running_in_this_thread());
+    EXPECT_EQ(executor.run(), 1u);
+    EXPECT_EQ(log, (std::vector<int>{ 1, 3 }));
+
+    s.post([] { throw std::runtime_error{ "failure" }; });
+    EXPECT_THROW(executor.run(), std::runtime_error);
+    EXPECT_TRUE(executor.queue_.empty());
+    s.post([&] { log.push_back(4); });
+    EXPECT_EQ(executor.run(), 1u);
+    EXPECT_EQ(log.back(), 4);
+}
+
+TEST(StrandTest, Serialization)
+{
+    constexpr int strands = 8;
+    constexpr int producers = 4;
+    constexpr int tasks = 2000;
+
+    struct state
+    {
+        std::atomic<int> running_{};
+        int last_[producers]{};
+        bool overlap_{};
+        bool reordered_{};
+    };
+
+    std::atomic<int> done{ 0 };
+    std::vector<state> states(strands);
+    {
+        // Executor's threads are joined before strands are destroyed
+        std::vector<std::unique_ptr<vdk::strand<pool_executor>>> list;
+        pool_executor executor{ 4 };
+        for (int i = 0; i < strands; ++i)
+            list.push_back(std::make_unique<vdk::strand<pool_executor>>(executor, 16));
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+            {
+                for (int t = 1; t <= tasks; ++t)
+                {
+                    const auto i = static_cast<std::size_t>(t % strands);
+                    list[i]->post([&st = states[i], &done, p, t]
+                    {
+                        if (st.running_.fetch_add(1) != 0)
+                            st.overlap_ = true;
+                        if (st.last_[p] >= t)
+                            st.reordered_ = true;
+                        st.last_[p] = t;
+                        st.running_.fetch_sub(1);
+                        done.fetch_add(1, std::memory_order_release);
+                    });
+                }
+            });
+        }
+        for (auto & t : threads)
+            t.join();
+        while (done.load(std::memory_order_acquire) != producers * tasks)
+            std::this_thread::yield();
+    }
+    for (const auto & st : states)
+    {
+        EXPECT_FALSE(st.overlap_);
+        EXPECT_FALSE(st.reordered_);
+    }
+}
@@ -0,0 +1,128 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <cctype>
+#include <string>
+#include <vector>
+#include <string_view>
+
+#include <gtest/gtest.h>
+#include <string_dispatcher.h>
+
+namespace
+{
+using vdk::delegate;
+
+constexpr auto methods = vdk::make_perfect_hash("get", "set", "remove", "list",
+                                                "subscribe", "unsubscribe", "ping");
+
+// Lookup is available in constant expressions
+static_assert(methods.size() == 7);
+static_assert(methods.find("remove") == 2);
+static_assert(methods.key(methods.find("ping")) == "ping");
+static_assert(methods.find("pong") == methods.npos);
+static_assert(methods.find("") == methods.npos);
+
+} // namespace
+
+TEST(StringDispatcherTest, PerfectHash)
+{
+    for (std::size_t i = 0; i < methods.size(); ++i)
+        EXPECT_EQ(methods.find(methods.key(i)), i);
+
+    // Key that differs only past the first 8 characters
+    constexpr auto keys = vdk::make_perfect_hash("subscriber_a", "subscriber_b", "a", "");
+    EXPECT_EQ(keys.find("subscriber_b"), 1u);
+    EXPECT_EQ(keys.find(""), 3u);
+    EXPECT_EQ(keys.find("subscriber_c"), keys.npos);
+
+    // Duplicate keys cannot be hashed
+    EXPECT_THROW(vdk::make_perfect_hash("get", "set", "get"), std::invalid_argument);
+}
+
+TEST(StringDispatcherTest, FixedKeys)
+{
+    vdk::string_dispatcher<int(int), methods.size()> dispatcher{ methods };
+    EXPECT_EQ(dispatcher.size(), 7u);
+
+    EXPECT_TRUE(dispatcher.assign("get", [](int x) { return x + 1; }));
+    EXPECT_TRUE(dispatcher.assign("set", [](int x) { return x * 2; }));
+    EXPECT_FALSE(dispatcher.assign("put", [](int x) { return x; }));
+
+    ASSERT_NE(dispatcher.find("get"), nullptr);
+    EXPECT_EQ((*dispatcher.find("get"))(1), 2);
+    EXPECT_EQ((*dispatcher.find("set"))(5), 10);
+
+    // Known key without handler resolves to empty delegate
+    ASSERT_NE(dispatcher.find("ping"), nullptr);
+    EXPECT_FALSE(*dispatcher.find("ping"));
+    EXPECT_TRUE(dispatcher.contains("ping"));
+    EXPECT_EQ(dispatcher.find("put"), nullptr);
+    EXPECT_FALSE(dispatcher.contains("put"));
+}
+
+TEST(StringDispatcherTest, DynamicKeys)
+{
+    vdk::string_dispatcher<std::string(std::string_view)> dispatcher;
+    EXPECT_EQ(dispatcher.find("echo"), nullptr);
+
+    EXPECT_TRUE(dispatcher.add("echo", [](std::string_view s) { return std::string{ s }; }));
+    EXPECT_TRUE(dispatcher.add("upper", [](std::string_view s)
+    {
+        std::string r{ s };
+        for (auto & c : r) c = static_cast<char>(std::toupper(c));
+        return r;
+    }));
+    EXPECT_FALSE(dispatcher.add("echo", [](std::string_view) { return std::string{}; }));
+    EXPECT_EQ(dispatcher.size(), 2u);
+
+    // Key is copied; the caller's buffer may go away
+    {
+        std::string key = "empty";
+        EXPECT_TRUE(dispatcher.add(key, [](std::string_view) { return std::string{}; }));
+    }
+    EXPECT_EQ((*dispatcher.find("echo"))("text"), "text");
+    EXPECT_EQ((*dispatcher.find("upper"))("text"), "TEXT");
+    EXPECT_EQ((*dispatcher.find("empty"))("text"), "");
+    EXPECT_FALSE(dispatcher.contains("ech"));
+    EXPECT_FALSE(dispatcher.contains("echo2"));
+
+    dispatcher.clear();
+    EXPECT_EQ(dispatcher.size(), 0u);
+    EXPECT_FALSE(dispatcher.contains("echo"));
+    EXPECT_TRUE(dispatcher.add("echo", [](std::string_view s) { return std::string{ s }; }));
+    EXPECT_EQ((*dispatcher.find("echo"))("again"), "again");
+}
+
+TEST(StringDispatcherTest, ManyKeys)
+{
+    constexpr int count = 5000;
+    std::vector<std::string> keys;
+    for (int i = 0; i < count; ++i)
+        keys.push_back("service.method_" + std::to_string(i));
+
+    // Table grows and buckets are re-seeded as keys are registered
+    vdk::string_dispatcher<int()> dispatcher;
+    for (int i = 0; i < count; ++i)
+    {
+        ASSERT_TRUE(dispatcher.add(keys[i], [i] { return i; }));
+        ASSERT_TRUE(dispatcher.contains(keys[i / 2]));
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        auto handler = dispatcher.find(keys[i]);
+        ASSERT_NE(handler, nullptr);
+        EXPECT_EQ((*handler)(), i);
+    }
+    EXPECT_FALSE(dispatcher.contains("service.method_5000"));
+    EXPECT_FALSE(dispatcher.contains("service.method_"));
+
+    vdk::string_dispatcher<int()> reserved;
+    reserved.reserve(count);
+    for (int i = 0; i < count; ++i)
+        reserved.add(keys[i], [i] { return i; });
+    EXPECT_EQ((*reserved.find(keys[1234]))(), 1234);
+}
@@ -5,6 +5,7 @@
 ===================================================================*/
 
 #include <string>
+#include <vector>
 #include <memory>
 #include <utility>
 #include <stdexcept>
@@ -1100,6 +1101,89 @@ TEST(DelegateTest, CallVoidNoArgs)
     EXPECT_EQ(result, 10);
 }
 
+// Element-wise functor with batch overload
+struct scale_batch
+{
+    using batch_overload = void;
+
+    float operator()(float value) const noexcept { return value * factor; }
+
+    void operator()(const float * in, float * out, std::size_t count) const noexcept
+    {
+        ++*batches;
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = in[i] * factor;
+    }
+
+    float factor;
+    int * batches;
+};
+
+TEST(DelegateTest, Apply)
+{
+    const std::vector<float> in{ 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+    std::vector<float> out(in.size());
+
+    // Target without batch overload is invoked for each element
+    delegate<float(float)> fn1{ [](float value) { return value + 1.0f; } };
+    fn1.apply(in.data(), out.data(), in.size());
+    EXPECT_EQ(out, (std::vector<float>{ 2.0f, 3.0f, 4.0f, 5.0f, 6.0f }));
+
+    // Target with batch overload is invoked once
+    int batches = 0;
+    delegate<float(float) const noexcept> fn2{ scale_batch{ 2.0f, &batches } };
+    static_assert(noexcept(fn2.apply(in.data(), out.data(), in.size())));
+    const auto & cfn2 = fn2;
+    cfn2.apply(in.data(), out.data(), in.size());
+    EXPECT_EQ(batches, 1);
+    EXPECT_EQ(out, (std::vector<float>{ 2.0f, 4.0f, 6.0f, 8.0f, 10.0f }));
+    EXPECT_EQ(fn2(1.5f), 3.0f);
+
+    // Batch thunk survives move and is used for const reference arguments
+    delegate<float(const float &)> fn3{ scale_batch{ 3.0f, &batches } };
+    auto fn4 = std::move(fn3);
+    fn4.apply(in.data(), out.data(), 2);
+    EXPECT_EQ(batches, 2);
+    EXPECT_EQ(out[1], 6.0f);
+
+    delegate<double(int)> fn5{ [](int value) { return value / 2.0; } };
+    const int ints[]{ 1, 2 };
+    double doubles[2]{};
+    fn5.apply(ints, doubles, 2);
+    EXPECT_EQ(doubles[1], 1.0);
+
+    // Catch-all target without batch_overload is invoked for each element
+    int calls = 0;
+    delegate<float(float)> fn6{ [&calls](auto && ... args) {
+        ++calls;
+        return static_cast<float>(sizeof...(args)); } };
+    fn6.apply(in.data(), out.data(), in.size());
+    EXPECT_EQ(calls, 5);
+    EXPECT_EQ(out, (std::vector<float>(in.size(), 1.0f)));
+}
+
+TEST(DelegateTest, Hash)
+{
+    using hash = std::hash<delegate<int(int)>>;
+
+    // Equal delegates have equal hashes
+    delegate<int(int)> fn1{ function_except };
+    delegate<int(int)> fn2{ function_except };
+    delegate<int(int)> fn3{ function_unique };
+    EXPECT_TRUE(fn1 == fn2);
+    EXPECT_EQ(hash{}(fn1), hash{}(fn2));
+    EXPECT_NE(hash{}(fn1), hash{}(fn3));
+
+    // Targets without std::hash are hashed by type
+    delegate<int(int)> fn4{ functor_base_except{ 1 } };
+    delegate<int(int)> fn5{ functor_base_except{ 1 } };
+    EXPECT_TRUE(fn4 == fn5);
+    EXPECT_EQ(hash{}(fn4), hash{}(fn5));
+
+    delegate<int(int)> fn6;
+    EXPECT_EQ(hash{}(fn6), hash{}(delegate<int(int)>{}));
+}
+
 int main(int argc, char ** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
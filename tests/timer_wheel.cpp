@@ -0,0 +1,216 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+#include <timer_wheel.h>
+
+namespace
+{
+using vdk::timer_wheel;
+using tick_t = timer_wheel::tick_t;
+
+} // namespace
+
+TEST(TimerWheelTest, Empty)
+{
+    timer_wheel wheel;
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_EQ(wheel.now(), 0u);
+
+    EXPECT_EQ(wheel.advance(1000), 0u);
+    EXPECT_EQ(wheel.now(), 1000u);
+
+    timer_wheel::handle timer;
+    EXPECT_FALSE(timer);
+    EXPECT_FALSE(wheel.cancel(timer));
+}
+
+TEST(TimerWheelTest, Deadlines)
+{
+    timer_wheel wheel;
+    wheel.advance(12345);
+
+    const tick_t delays[] =
+    {
+        0, 1, 2, 62, 63, 64, 65, 127, 128, 4095, 4096, 4097,
+        262143, 262144, 1000000, tick_t{ 1 } << 30
+    };
+
+    std::vector<tick_t> fired;
+    for (auto delay : delays)
+    {
+        wheel.schedule(delay, [&wheel, &fired] { fired.push_back(wheel.now()); });
+    }
+    EXPECT_EQ(wheel.size(), std::size(delays));
+
+    // Advance in uneven steps to exercise skipping and cascading
+    const tick_t start = wheel.now();
+    const tick_t steps[] = { 1, 1, 61, 1, 1, 1, 100, 5000, 300000 };
+    for (auto step : steps)
+        wheel.advance(step);
+    wheel.advance((tick_t{ 1 } << 30) - (wheel.now() - start));
+
+    std::vector<tick_t> expected;
+    for (auto delay : delays)
+        expected.push_back(start + std::max<tick_t>(delay, 1));
+
+    std::sort(fired.begin(), fired.end());
+    EXPECT_EQ(fired, expected);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, TickByTick)
+{
+    timer_wheel wheel;
+    wheel.advance(63);
+
+    int count = 0;
+    wheel.schedule(70, [&count] { ++count; });
+    wheel.schedule(4100, [&count] { count += 10; });
+
+    for (tick_t tick = 1; tick < 70; ++tick)
+        EXPECT_EQ(wheel.advance(), 0u);
+    EXPECT_EQ(wheel.advance(), 1u);
+    EXPECT_EQ(count, 1);
+
+    for (tick_t tick = 71; tick < 4100; ++tick)
+        wheel.advance();
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(wheel.advance(), 1u);
+    EXPECT_EQ(count, 11);
+}
+
+TEST(TimerWheelTest, Cancel)
+{
+    timer_wheel wheel;
+    auto data = std::make_shared<int>(0);
+
+    auto timer1 = wheel.schedule(10, [data] { ++*data; });
+    auto timer2 = wheel.schedule(100, [data] { ++*data; });
+    auto timer3 = wheel.schedule(10000, [data] { ++*data; });
+    EXPECT_EQ(data.use_count(), 4);
+    EXPECT_NE(timer1, timer2);
+
+    EXPECT_TRUE(wheel.cancel(timer2));
+    EXPECT_FALSE(wheel.cancel(timer2));
+    EXPECT_EQ(data.use_count(), 3);
+    EXPECT_EQ(wheel.size(), 2u);
+
+    wheel.advance(10);
+    EXPECT_EQ(*data, 1);
+    EXPECT_FALSE(wheel.cancel(timer1));
+
+    // Handle of expired timer does not cancel a new timer in the same node
+    auto timer4 = wheel.schedule(5, [data] { ++*data; });
+    EXPECT_FALSE(wheel.cancel(timer1));
+    EXPECT_TRUE(wheel.cancel(timer4));
+
+    wheel.advance(20000);
+    EXPECT_EQ(*data, 2);
+    EXPECT_FALSE(wheel.cancel(timer3));
+    EXPECT_EQ(data.use_count(), 1);
+}
+
+TEST(TimerWheelTest, CancelSameTick)
+{
+    timer_wheel wheel;
+    int calls = 0;
+
+    // Whichever callback runs first cancels the other one
+    timer_wheel::handle timer1, timer2;
+    timer1 = wheel.schedule(3, [&] { ++calls; wheel.cancel(timer2); });
+    timer2 = wheel.schedule(3, [&] { ++calls; wheel.cancel(timer1); });
+    EXPECT_EQ(wheel.advance(3), 1u);
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(wheel.empty());
+
+    // Clear from a callback cancels the rest of the tick
+    wheel.schedule(2, [&] { ++calls; wheel.clear(); });
+    wheel.schedule(2, [&] { ++calls; wheel.clear(); });
+    wheel.schedule(5, [&] { ++calls; });
+    EXPECT_EQ(wheel.advance(10), 1u);
+    EXPECT_EQ(calls, 2);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, ThrowingCallback)
+{
+    timer_wheel wheel;
+    int calls = 0;
+
+    // Timers of the same tick on both sides of the throwing one
+    timer_wheel::handle timers[4];
+    timers[0] = wheel.schedule(1, [&] { ++calls; });
+    timers[1] = wheel.schedule(1, [&] { ++calls; });
+    wheel.schedule(1, [] { throw std::runtime_error{ "failure" }; });
+    timers[2] = wheel.schedule(1, [&] { ++calls; });
+    timers[3] = wheel.schedule(1, [&] { ++calls; });
+    wheel.schedule(2, [&] { calls += 10; });
+    EXPECT_THROW(wheel.advance(), std::runtime_error);
+    EXPECT_EQ(wheel.now(), 1u);
+
+    // Timers not yet invoked stay pending and can still be cancelled
+    const auto pending = static_cast<std::size_t>(4 - calls);
+    EXPECT_EQ(wheel.size(), pending + 1);
+    EXPECT_LT(calls, 4);
+
+    // Remaining timers of the tick fire first on the next advance
+    EXPECT_EQ(wheel.advance(0), pending);
+    EXPECT_EQ(calls, 4);
+    EXPECT_EQ(wheel.size(), 1u);
+    for (auto & timer : timers)
+        EXPECT_FALSE(wheel.cancel(timer));
+
+    EXPECT_EQ(wheel.advance(), 1u);
+    EXPECT_EQ(calls, 14);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, Reschedule)
+{
+    timer_wheel wheel;
+    int count = 0;
+
+    // Periodic timer that reschedules itself from the callback
+    struct periodic
+    {
+        void operator()()
+        {
+            if (++*count < 5)
+                wheel->schedule(100, periodic{ *this });
+        }
+        timer_wheel * wheel;
+        int * count;
+    };
+
+    wheel.schedule(100, periodic{ &wheel, &count });
+    EXPECT_EQ(wheel.advance(1000), 5u);
+    EXPECT_EQ(count, 5);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, Clear)
+{
+    timer_wheel wheel{ 16 };
+    auto data = std::make_shared<int>(0);
+
+    for (tick_t delay = 1; delay < 100000; delay *= 3)
+        wheel.schedule(delay, [data] { ++*data; });
+    EXPECT_GT(data.use_count(), 1);
+
+    wheel.clear();
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(data.use_count(), 1);
+    EXPECT_EQ(wheel.advance(100000), 0u);
+    EXPECT_EQ(*data, 0);
+}
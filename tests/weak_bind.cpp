@@ -0,0 +1,89 @@
+/*===================================================================
+*   Copyright (c) Vadim Karkhin. All rights reserved.
+*   Use, modification, and distribution is subject to license terms.
+*   You are welcome to contact the author at: vdksoft@gmail.com
+===================================================================*/
+
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <delegate.h>
+#include <weak_bind.h>
+
+namespace
+{
+struct counter : vdk::trackable
+{
+    void add(int value) noexcept { total_ += value; }
+    int get() const noexcept { return total_; }
+
+    int total_{};
+};
+
+using bound_t = decltype(vdk::weak_bind<&counter::add>(std::declval<counter &>()));
+
+} // namespace
+
+static_assert(vdk::internal::delegate::is_internal_v<bound_t>);
+static_assert(std::is_nothrow_copy_constructible_v<bound_t>);
+
+TEST(WeakBindTest, Invoke)
+{
+    auto object = std::make_unique<counter>();
+    vdk::delegate<void(int)> add = vdk::weak_bind<&counter::add>(*object);
+    vdk::delegate<std::optional<int>()> get = vdk::weak_bind<&counter::get>(*object);
+
+    add(2);
+    add(3);
+    EXPECT_EQ(object->total_, 5);
+    EXPECT_EQ(get(), 5);
+
+    // Calls after destruction of the object do nothing
+    object.reset();
+    add(4);
+    EXPECT_EQ(get(), std::nullopt);
+}
+
+TEST(WeakBindTest, Lifetime)
+{
+    vdk::weak_ref ref;
+    EXPECT_FALSE(ref);
+    EXPECT_TRUE(ref.expired());
+
+    auto first = std::make_unique<counter>();
+    ref = first->lifetime();
+    auto bound = vdk::weak_bind<&counter::add>(*first);
+    EXPECT_TRUE(ref);
+    EXPECT_FALSE(ref.expired());
+    EXPECT_FALSE(bound.expired());
+    EXPECT_EQ(bound.owner(), ref);
+
+    // Copy is a separate object
+    counter copy{ *first };
+    EXPECT_NE(copy.lifetime(), ref);
+
+    first.reset();
+    EXPECT_TRUE(ref.expired());
+    EXPECT_TRUE(bound.expired());
+    EXPECT_FALSE(copy.lifetime().expired());
+
+    // Reuse of released slot does not revive old references
+    auto second = std::make_unique<counter>();
+    EXPECT_TRUE(ref.expired());
+    vdk::delegate<void(int)> add = bound;
+    add(1);
+    EXPECT_EQ(second->total_, 0);
+}
+
+TEST(WeakBindTest, Compare)
+{
+    counter a;
+    counter b;
+    vdk::delegate<void(int)> d1 = vdk::weak_bind<&counter::add>(a);
+    vdk::delegate<void(int)> d2 = vdk::weak_bind<&counter::add>(a);
+    vdk::delegate<void(int)> d3 = vdk::weak_bind<&counter::add>(b);
+    EXPECT_TRUE(d1 == d2);
+    EXPECT_FALSE(d1 == d3);
+}